@@ -0,0 +1,371 @@
+/// @file bench.cpp
+/// @brief Throughput and latency benchmark of the tracer.
+/// @details Each invocation runs a single scenario and prints a JSON object
+/// with the measures. With `--suite`, the executable runs a predefined grid of
+/// scenarios, each one in its own process so that the peak RSS is accurate,
+/// and prints a JSON array.
+
+#include "cpptracer/tracer.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+/// @brief The parameters of a scenario.
+struct Scenario {
+    std::size_t signals    = 1000;   ///< Number of traced signals.
+    double change_ratio    = 0.1;    ///< Fraction of signals changing at each sample.
+    std::string types      = "mix";  ///< Type of the signals: bool, int, real, vector, or mix.
+    std::size_t depth      = 1;      ///< Depth of the scope hierarchy.
+    bool compression       = false;  ///< Enables the compression.
+    std::size_t samples    = 0;      ///< Number of samples, if zero it depends on the signals.
+    std::size_t threads    = 1;      ///< Number of sampling threads, zero to use one per core.
+    std::string deferred   = "off";  ///< Deferred formatting: off, flush, or background.
+    std::string sink       = "file"; ///< Sink of the trace: file, or direct.
+    std::size_t flush_mb   = 0;      ///< Memory budget after which the trace is written, zero if unlimited.
+    std::string durability = "none"; ///< Durability of the trace: none, periodic (every 8 MB), or flush.
+    bool toggles           = false;  ///< Counts the toggles of the bits of the signals.
+    bool output            = true;   ///< Writes the trace, disabled for a run which only counts the toggles.
+};
+
+/// @brief Storage for the traced variables.
+struct Signals {
+    std::unique_ptr<bool[]> bools;          ///< Boolean signals.
+    std::size_t bools_size = 0;             ///< Number of boolean signals.
+    std::vector<std::int32_t> ints;         ///< Integer signals.
+    std::vector<double> reals;              ///< Real signals.
+    std::vector<std::vector<bool>> vectors; ///< Bit-vector signals.
+};
+
+/// @brief Returns the peak resident set size of the process.
+/// @return the peak RSS in kilobytes, or 0 if not available.
+inline long peak_rss_kb()
+{
+#if defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024;
+#elif defined(__unix__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#else
+    return 0;
+#endif
+}
+
+/// @brief Returns the CPU time used by the process.
+/// @param system if true, only the time spent inside the kernel.
+/// @return the time in milliseconds.
+inline double cpu_time_ms(bool system)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    const timeval &time = system ? usage.ru_stime : usage.ru_utime;
+    double result       = static_cast<double>(time.tv_sec) * 1e3 + static_cast<double>(time.tv_usec) * 1e-3;
+    return system ? result : result + cpu_time_ms(true);
+#else
+    (void)system;
+    return 0.0;
+#endif
+}
+
+/// @brief Returns the size of the given file.
+/// @param filename the name of the file.
+/// @return the size in bytes.
+inline std::size_t file_size(const std::string &filename)
+{
+    std::ifstream infile(filename, std::ios::binary | std::ios::ate);
+    return infile.is_open() ? static_cast<std::size_t>(infile.tellg()) : 0;
+}
+
+/// @brief Returns the type of the i-th signal.
+/// @param scenario the scenario.
+/// @param index the index of the signal.
+/// @return the type of the signal.
+inline std::string signal_type(const Scenario &scenario, std::size_t index)
+{
+    if (scenario.types != "mix") {
+        return scenario.types;
+    }
+    static const char *types[] = {"bool", "int", "real", "vector"};
+    return types[index % 4];
+}
+
+/// @brief Runs a single scenario, and prints the results.
+/// @param scenario the scenario.
+/// @return the exit code.
+inline int run_scenario(const Scenario &scenario)
+{
+    // Number of signals inside each leaf scope.
+    const std::size_t signals_per_scope = 64;
+    const std::string filename          = "bench_trace.vcd";
+
+    Signals signals;
+    // Reserve the storage, so that the traced addresses do not change.
+    signals.bools = std::make_unique<bool[]>(scenario.signals);
+    signals.ints.reserve(scenario.signals);
+    signals.reals.reserve(scenario.signals);
+    signals.vectors.reserve(scenario.signals);
+    // For each signal, the type and the position inside its storage.
+    std::vector<std::pair<char, std::size_t>> layout;
+    layout.reserve(scenario.signals);
+
+    auto setup_start = std::chrono::steady_clock::now();
+
+    cpptracer::Tracer tracer(filename, cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+    if (scenario.compression) {
+        tracer.enableCompression();
+    }
+#ifdef __linux__
+    if (scenario.sink == "direct") {
+        tracer.setSink(std::make_unique<cpptracer::DirectFileSink>(filename));
+    }
+#endif
+    if (scenario.flush_mb > 0) {
+        tracer.setMemoryBudget(scenario.flush_mb << 20U, cpptracer::OverflowPolicy::Flush);
+    }
+    if (scenario.durability == "periodic") {
+        tracer.setDurability(cpptracer::Durability::Periodic, std::size_t(8) << 20U);
+    } else if (scenario.durability == "flush") {
+        tracer.setDurability(cpptracer::Durability::EveryFlush);
+    }
+    if (scenario.toggles) {
+        tracer.enableToggleCounting();
+    }
+    if (!scenario.output) {
+        tracer.disableOutput();
+    }
+    tracer.enableParallelSampling(scenario.threads);
+    if (scenario.deferred == "flush") {
+        tracer.enableDeferredFormatting(cpptracer::DeferredFormatting::OnFlush);
+    } else if (scenario.deferred == "background") {
+        tracer.enableDeferredFormatting(cpptracer::DeferredFormatting::Background);
+    }
+    for (std::size_t index = 0; index < scenario.signals; ++index) {
+        // Open a new chain of scopes for each group of signals.
+        if ((index % signals_per_scope) == 0) {
+            if (index > 0) {
+                for (std::size_t level = 0; level < scenario.depth; ++level) {
+                    tracer.closeScope();
+                }
+            }
+            for (std::size_t level = 0; level < scenario.depth; ++level) {
+                tracer.addSubScope("s" + std::to_string(index / signals_per_scope) + "_" + std::to_string(level));
+            }
+        }
+        std::string name = "sig" + std::to_string(index);
+        std::string type = signal_type(scenario, index);
+        if (type == "bool") {
+            layout.emplace_back('b', signals.bools_size);
+            tracer.addTrace(signals.bools[signals.bools_size++], name);
+        } else if (type == "int") {
+            signals.ints.emplace_back(0);
+            layout.emplace_back('i', signals.ints.size() - 1);
+            tracer.addTrace(signals.ints.back(), name);
+        } else if (type == "real") {
+            signals.reals.emplace_back(0.0);
+            layout.emplace_back('r', signals.reals.size() - 1);
+            tracer.addTrace(signals.reals.back(), name);
+        } else {
+            signals.vectors.emplace_back(32, false);
+            layout.emplace_back('v', signals.vectors.size() - 1);
+            tracer.addTrace(signals.vectors.back(), name);
+        }
+    }
+    tracer.createTrace();
+
+    auto setup_stop = std::chrono::steady_clock::now();
+
+    // Number of signals changed at each sample, cycling over all the signals.
+    const auto changes_per_sample =
+        static_cast<std::size_t>(static_cast<double>(scenario.signals) * scenario.change_ratio + 0.5);
+    std::size_t cursor        = 0;
+    std::size_t total_changes = 0;
+    std::chrono::nanoseconds update_time{0};
+    const double cpu_start = cpu_time_ms(false);
+    const double sys_start = cpu_time_ms(true);
+
+    for (std::size_t sample = 0; sample < scenario.samples; ++sample) {
+        for (std::size_t change = 0; change < changes_per_sample; ++change) {
+            const auto &entry = layout[cursor];
+            if (entry.first == 'b') {
+                signals.bools[entry.second] = !signals.bools[entry.second];
+            } else if (entry.first == 'i') {
+                signals.ints[entry.second] += 1;
+            } else if (entry.first == 'r') {
+                signals.reals[entry.second] += 1.0;
+            } else {
+                auto &vector = signals.vectors[entry.second];
+                vector[sample % vector.size()] = !vector[sample % vector.size()];
+            }
+            cursor = (cursor + 1) % layout.size();
+        }
+        total_changes += changes_per_sample;
+        auto start = std::chrono::steady_clock::now();
+        tracer.updateTrace(static_cast<double>(sample) * 1e-09);
+        update_time += std::chrono::steady_clock::now() - start;
+    }
+
+    auto close_start = std::chrono::steady_clock::now();
+    tracer.closeTrace();
+    auto close_stop = std::chrono::steady_clock::now();
+    const double cpu_ms = cpu_time_ms(false) - cpu_start;
+    const double sys_ms = cpu_time_ms(true) - sys_start;
+
+    const std::string output = filename + ((scenario.compression && (scenario.sink == "file")) ? ".gz" : "");
+    const std::size_t bytes  = file_size(output);
+    std::remove(output.c_str());
+    std::remove((filename + ".activity.json").c_str());
+
+    // Build the result separately, the tracer might print messages on the standard output.
+    const auto update_ns = static_cast<double>(update_time.count());
+    const double mb      = static_cast<double>(bytes) / static_cast<double>(1U << 20U);
+    std::ostringstream result;
+    result << "{\"signals\": " << scenario.signals << ", \"change_ratio\": " << scenario.change_ratio
+           << ", \"types\": \"" << scenario.types << "\", \"depth\": " << scenario.depth
+           << ", \"compression\": " << (scenario.compression ? "true" : "false")
+           << ", \"threads\": " << tracer.samplingThreads() << ", \"deferred\": \"" << scenario.deferred << "\""
+           << ", \"sink\": \"" << scenario.sink << "\", \"flush_mb\": " << scenario.flush_mb
+           << ", \"durability\": \"" << scenario.durability << "\""
+           << ", \"toggles\": " << (scenario.toggles ? "true" : "false")
+           << ", \"output\": " << (scenario.output ? "true" : "false")
+           << ", \"samples\": " << scenario.samples << ", \"changes\": " << total_changes
+           << ", \"setup_ms\": " << std::chrono::duration<double, std::milli>(setup_stop - setup_start).count()
+           << ", \"close_ms\": " << std::chrono::duration<double, std::milli>(close_stop - close_start).count()
+           << ", \"ns_per_sample\": " << (update_ns / static_cast<double>(scenario.samples))
+           << ", \"ns_per_change\": " << (total_changes ? update_ns / static_cast<double>(total_changes) : 0.0)
+           << ", \"bytes\": " << bytes << ", \"bytes_per_change\": "
+           << (total_changes ? static_cast<double>(bytes) / static_cast<double>(total_changes) : 0.0)
+           << ", \"cpu_ms_per_mb\": " << ((mb > 0.0) ? cpu_ms / mb : 0.0)
+           << ", \"sys_ms_per_mb\": " << ((mb > 0.0) ? sys_ms / mb : 0.0) << ", \"peak_rss_kb\": " << peak_rss_kb()
+           << "}";
+    std::cout << result.str() << "\n";
+    return 0;
+}
+
+/// @brief Runs the predefined grid of scenarios, each one in a separate process.
+/// @param executable the path to this executable.
+/// @return the exit code.
+inline int run_suite(const std::string &executable)
+{
+    const std::string output = "bench_scenario.json";
+    std::vector<std::string> arguments;
+    for (const char *signals : {"10", "1000", "100000", "1000000"}) {
+        for (const char *ratio : {"0.01", "0.1", "1.0"}) {
+            arguments.emplace_back(std::string("--signals ") + signals + " --change-ratio " + ratio);
+        }
+    }
+    for (const char *types : {"bool", "int", "real", "vector"}) {
+        arguments.emplace_back(std::string("--signals 10000 --types ") + types);
+    }
+    for (const char *depth : {"4", "16"}) {
+        arguments.emplace_back(std::string("--signals 10000 --depth ") + depth);
+    }
+    arguments.emplace_back("--signals 10000 --compression");
+    for (const char *deferred : {"flush", "background"}) {
+        arguments.emplace_back(std::string("--signals 100000 --deferred ") + deferred);
+    }
+    // Writing the trace through the page cache, and with direct I/O.
+    for (const char *sink : {"file", "direct"}) {
+        arguments.emplace_back(std::string("--signals 100000 --change-ratio 1.0 --flush-mb 64 --sink ") + sink);
+    }
+    // Cost of syncing the trace, grouped every 8 MB or at each 2 MB flush.
+    for (const char *durability : {"none", "periodic", "flush"}) {
+        arguments.emplace_back(std::string("--signals 100000 --change-ratio 1.0 --flush-mb 2 --durability ") +
+                               durability);
+    }
+    // Cost of counting the toggles, with and without writing the trace.
+    arguments.emplace_back("--signals 10000 --types int --toggles");
+    arguments.emplace_back("--signals 10000 --types int --toggles --no-output");
+    // Scaling of the parallel sampling.
+    for (const char *threads : {"1", "2", "4", "8"}) {
+        arguments.emplace_back(std::string("--signals 1000000 --change-ratio 0.1 --threads ") + threads);
+    }
+    std::cout << "[\n";
+    for (std::size_t index = 0; index < arguments.size(); ++index) {
+        std::string command = "\"" + executable + "\" " + arguments[index] + " > " + output;
+        if (std::system(command.c_str()) != 0) {
+            std::cerr << "Failed to run: " << command << "\n";
+            return 1;
+        }
+        // Extract the result, skipping the messages printed by the tracer.
+        std::ifstream infile(output);
+        std::string line;
+        std::string result;
+        while (std::getline(infile, line)) {
+            if (!line.empty() && (line[0] == '{')) {
+                result = line;
+            }
+        }
+        std::cout << "  " << result << (((index + 1) < arguments.size()) ? ",\n" : "\n");
+    }
+    std::cout << "]\n";
+    std::remove(output.c_str());
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    Scenario scenario;
+    for (int index = 1; index < argc; ++index) {
+        std::string argument = argv[index];
+        std::string value    = ((index + 1) < argc) ? argv[index + 1] : "";
+        if (argument == "--suite") {
+            return run_suite(argv[0]);
+        } else if (argument == "--compression") {
+            scenario.compression = true;
+            continue;
+        } else if (argument == "--toggles") {
+            scenario.toggles = true;
+            continue;
+        } else if (argument == "--no-output") {
+            scenario.output = false;
+            continue;
+        } else if (argument == "--signals") {
+            scenario.signals = std::stoul(value);
+        } else if (argument == "--change-ratio") {
+            scenario.change_ratio = std::stod(value);
+        } else if (argument == "--types") {
+            scenario.types = value;
+        } else if (argument == "--depth") {
+            scenario.depth = std::stoul(value);
+        } else if (argument == "--samples") {
+            scenario.samples = std::stoul(value);
+        } else if (argument == "--threads") {
+            scenario.threads = std::stoul(value);
+        } else if (argument == "--deferred") {
+            scenario.deferred = value;
+        } else if (argument == "--sink") {
+            scenario.sink = value;
+        } else if (argument == "--flush-mb") {
+            scenario.flush_mb = std::stoul(value);
+        } else if (argument == "--durability") {
+            scenario.durability = value;
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--suite] [--signals N] [--change-ratio R] [--types bool|int|real|vector|mix]"
+                         " [--depth D] [--samples S] [--threads T] [--deferred off|flush|background]"
+                         " [--sink file|direct] [--flush-mb M] [--durability none|periodic|flush]"
+                         " [--compression] [--toggles] [--no-output]\n";
+            return 1;
+        }
+        ++index;
+    }
+    if ((scenario.signals == 0) || (scenario.depth == 0)) {
+        std::cerr << "The number of signals and the depth must be positive.\n";
+        return 1;
+    }
+    if (scenario.samples == 0) {
+        // Keep the amount of work roughly constant across the signal counts.
+        scenario.samples = std::min<std::size_t>(1000, std::max<std::size_t>(10, 10000000 / scenario.signals));
+    }
+    return run_scenario(scenario);
+}
@@ -0,0 +1,73 @@
+#include "cpptracer/static_tracer.hpp"
+
+#include <chrono>
+
+/// @brief Measures the average time required to sample the given tracer.
+/// @tparam TracerType the type of tracer.
+/// @tparam Step the function which changes the variables.
+/// @param tracer the tracer.
+/// @param samples the number of samples.
+/// @param step the function which changes the variables.
+/// @return the average time per sample, in nanoseconds.
+template <typename TracerType, typename Step>
+double measure(TracerType &tracer, int samples, Step step)
+{
+    tracer.createTrace();
+    auto start = std::chrono::steady_clock::now();
+    for (int sample = 0; sample < samples; ++sample) {
+        step(sample);
+        tracer.updateTrace(sample);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count()) / samples;
+}
+
+int main(int argc, char **argv)
+{
+    int samples = (argc > 1) ? std::stoi(argv[1]) : 1000000;
+
+    cpptracer::TimeScale timeStep(1, cpptracer::TimeUnit::SEC);
+
+    bool _bool            = false;
+    std::uint8_t _uint8_t = 0;
+    std::int32_t _int32_t = 0;
+    std::int64_t _int64_t = 0;
+    double _double        = 0.0;
+
+    // Changes the variables, only some of them change at every step.
+    auto step = [&](int sample) {
+        _bool    = !_bool;
+        _int32_t = _int32_t + 1;
+        if ((sample % 4) == 0) {
+            _uint8_t = static_cast<std::uint8_t>(_uint8_t + 1);
+            _double  = _double + 0.5;
+        }
+        if ((sample % 16) == 0) {
+            _int64_t = _int64_t - 1;
+        }
+    };
+
+    double dynamic_ns = 0;
+    double static_ns  = 0;
+    {
+        cpptracer::Tracer tracer("bench_dynamic.vcd", timeStep, "root");
+        tracer.addTrace(_bool, "bool");
+        tracer.addTrace(_uint8_t, "uint8_t");
+        tracer.addTrace(_int32_t, "int32_t");
+        tracer.addTrace(_int64_t, "int64_t");
+        tracer.addTrace(_double, "double");
+        dynamic_ns = measure(tracer, samples, step);
+    }
+    {
+        cpptracer::StaticTracer tracer(
+            "bench_static.vcd", timeStep, "root", cpptracer::StaticSignal{_bool, "bool"},
+            cpptracer::StaticSignal{_uint8_t, "uint8_t"}, cpptracer::StaticSignal{_int32_t, "int32_t"},
+            cpptracer::StaticSignal{_int64_t, "int64_t"}, cpptracer::StaticSignal{_double, "double"});
+        static_ns  = measure(tracer, samples, step);
+    }
+
+    std::cout << "{\"samples\": " << samples << ", \"tracer_ns_per_sample\": " << dynamic_ns
+              << ", \"static_tracer_ns_per_sample\": " << static_ns << ", \"speedup\": " << (dynamic_ns / static_ns)
+              << "}\n";
+    return 0;
+}
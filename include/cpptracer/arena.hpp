@@ -0,0 +1,204 @@
+/// @file arena.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the arena used to store the scopes and the traces.
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cpptracer
+{
+
+namespace detail
+{
+
+/// @brief Monotonic allocator, which stores objects and strings inside large
+/// blocks of memory, and releases them all together.
+/// @details Objects are destroyed in reverse order of creation when the arena
+/// is destroyed. Strings are interned, so that equal names share their storage.
+class Arena
+{
+public:
+    /// @brief Constructor.
+    /// @param _block_size the size of the blocks of memory.
+    explicit Arena(std::size_t _block_size = 64U * 1024U)
+        : block_size(_block_size)
+    {
+        // Nothing to do.
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The other entity to copy.
+    Arena(const Arena &other) = delete;
+
+    /// @brief Move constructor.
+    /// @param other The other entity to move.
+    Arena(Arena &&other) noexcept = default;
+
+    /// @brief Copy assignment operator.
+    /// @param other The other entity to copy.
+    /// @return A reference to this object.
+    auto operator=(const Arena &other) -> Arena & = delete;
+
+    /// @brief Move assignment operator.
+    /// @param other The other entity to move.
+    /// @return A reference to this object.
+    auto operator=(Arena &&other) noexcept -> Arena &
+    {
+        if (this == &other) {
+            return *this;
+        }
+        this->destroyObjects();
+        block_size  = other.block_size;
+        blocks      = std::move(other.blocks);
+        used        = std::exchange(other.used, 0U);
+        capacity    = std::exchange(other.capacity, 0U);
+        reserved    = std::exchange(other.reserved, 0U);
+        destructors = std::move(other.destructors);
+        strings     = std::move(other.strings);
+        other.destructors.clear();
+        other.strings.clear();
+        return *this;
+    }
+
+    /// @brief Destructor, destroys the objects in reverse order of creation.
+    ~Arena() { this->destroyObjects(); }
+
+    /// @brief Creates a new object inside the arena.
+    /// @tparam T the type of the object.
+    /// @tparam Args the types of the arguments of the constructor.
+    /// @param args the arguments of the constructor.
+    /// @return a pointer to the object, valid as long as the arena.
+    template <typename T, typename... Args>
+    auto create(Args &&...args) -> T *
+    {
+        T *object = this->createUnmanaged<T>(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible<T>::value) {
+            destructors.emplace_back(object, [](void *pointer) { static_cast<T *>(pointer)->~T(); });
+        }
+        return object;
+    }
+
+    /// @brief Creates a new object inside the arena, which is not destroyed by the arena.
+    /// @details The owner of the object must call its destructor, before the
+    /// arena is destroyed. This saves the bookkeeping for objects which are
+    /// already tracked by another one, like the traces by their scope.
+    /// @tparam T the type of the object.
+    /// @tparam Args the types of the arguments of the constructor.
+    /// @param args the arguments of the constructor.
+    /// @return a pointer to the object, valid as long as the arena.
+    template <typename T, typename... Args>
+    auto createUnmanaged(Args &&...args) -> T *
+    {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types are not supported.");
+        return new (this->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /// @brief Stores a string inside the arena, sharing the storage of equal strings.
+    /// @details The interned strings are indexed by a fixed-size table, where
+    /// a string replaces the one with the same slot. Frequent names, like the
+    /// ones repeated by each instance of a module, are stored once, while the
+    /// table stays small enough to be cached, whatever the number of names.
+    /// @param str the string.
+    /// @return a view of the stored string, valid as long as the arena.
+    auto intern(std::string_view str) -> std::string_view
+    {
+        if (strings.empty()) {
+            strings.resize(strings_size, StringEntry(0U, nullptr));
+        }
+        const std::size_t hash = std::hash<std::string_view>{}(str);
+        auto &entry            = strings[hash & (strings_size - 1U)];
+        if ((entry.second != nullptr) && (entry.first == hash) && (Arena::load(entry.second) == str)) {
+            return Arena::load(entry.second);
+        }
+        // Store the length, followed by the characters.
+        auto length  = static_cast<std::uint32_t>(str.size());
+        auto *memory = static_cast<char *>(this->allocate(sizeof(length) + str.size(), 1U));
+        std::memcpy(memory, &length, sizeof(length));
+        std::memcpy(memory + sizeof(length), str.data(), str.size());
+        entry = {hash, memory};
+        return Arena::load(memory);
+    }
+
+    /// @brief Returns the memory used by the arena.
+    /// @return the number of bytes.
+    auto getMemoryUsage() const -> std::size_t
+    {
+        return reserved + (destructors.capacity() * sizeof(Destructor)) + (strings.capacity() * sizeof(StringEntry));
+    }
+
+private:
+    /// @brief An object, together with the function which destroys it.
+    using Destructor = std::pair<void *, void (*)(void *)>;
+    /// @brief An interned string, together with its hash.
+    using StringEntry = std::pair<std::size_t, const char *>;
+
+    /// The size of the blocks of memory.
+    std::size_t block_size;
+    /// The blocks of memory.
+    std::vector<std::unique_ptr<unsigned char[]>> blocks;
+    /// The number of bytes used inside the last block.
+    std::size_t used{0};
+    /// The size of the last block.
+    std::size_t capacity{0};
+    /// The total number of bytes reserved by the blocks.
+    std::size_t reserved{0};
+    /// The objects which must be destroyed.
+    std::vector<Destructor> destructors;
+    /// The number of slots of the table of the interned strings.
+    static constexpr std::size_t strings_size = 16384U;
+    /// Table of the interned strings and of their hashes, the strings are
+    /// stored inside the blocks as their length followed by their characters.
+    std::vector<StringEntry> strings;
+
+    /// @brief Destroys the objects, in reverse order of creation.
+    void destroyObjects()
+    {
+        for (auto it = destructors.rbegin(); it != destructors.rend(); ++it) {
+            it->second(it->first);
+        }
+        destructors.clear();
+    }
+
+    /// @brief Provides the view of a stored string.
+    /// @param entry the stored string.
+    /// @return the view of its characters.
+    static auto load(const char *entry) -> std::string_view
+    {
+        std::uint32_t length = 0;
+        std::memcpy(&length, entry, sizeof(length));
+        return std::string_view(entry + sizeof(length), length);
+    }
+
+    /// @brief Allocates raw memory inside the last block, or inside a new one.
+    /// @param size the number of bytes.
+    /// @param alignment the required alignment.
+    /// @return a pointer to the memory.
+    auto allocate(std::size_t size, std::size_t alignment) -> void *
+    {
+        // Blocks are aligned to max_align_t, so aligning the offset is enough.
+        std::size_t offset = (used + alignment - 1U) & ~(alignment - 1U);
+        if (blocks.empty() || ((offset + size) > capacity)) {
+            capacity = std::max(block_size, size);
+            blocks.emplace_back(new unsigned char[capacity]);
+            reserved += capacity;
+            offset = 0;
+        }
+        used = offset + size;
+        return blocks.back().get() + offset;
+    }
+};
+
+} // namespace detail
+
+} // namespace cpptracer
@@ -0,0 +1,316 @@
+/// @file array_trace.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the trace of a contiguous array of values.
+
+#pragma once
+
+#include "format.hpp"
+#include "simd.hpp"
+#include "trace.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cpptracer
+{
+
+namespace detail
+{
+
+/// @brief The number of meaningful bytes of a value, those compared to detect the changes.
+/// @details The 80-bit long doubles are stored with 6 or 2 padding bytes,
+/// whose content is not meaningful.
+/// @tparam T the type of the value.
+template <typename T>
+constexpr std::size_t significant_bytes =
+    (std::is_same<T, long double>::value && (std::numeric_limits<T>::digits == 64)) ? 10U : sizeof(T);
+
+} // namespace detail
+
+/// @brief Trace of a contiguous array of values, where each element is a
+/// separate signal.
+/// @details The elements are compared bitwise against a contiguous shadow
+/// copy, and only the ones which have changed are written. The padding bytes
+/// of the elements, if any, are ignored. The floating point elements which
+/// differ are then checked with the filter of the scalar traces (the one of
+/// the scope, see Tracer::setScopeFilter, or else the tolerance of is_equal),
+/// so that they change at the same values. The symbols of the elements are
+/// consecutive, starting from the one of the trace.
+/// @tparam T the type of the elements.
+template <typename T>
+class ArrayTrace : public Trace
+{
+    static_assert(std::is_arithmetic<T>::value, "Array traces support only arithmetic types.");
+
+public:
+    /// @brief The type of the traced elements.
+    using value_type   = T;
+    /// @brief The pointer type of the traced elements.
+    using pointer_type = const T *;
+
+    /// @brief Constructor.
+    /// @param _name the name of the trace.
+    /// @param _first_symbol the index of the symbol of the first element.
+    /// @param _data pointer to the first element.
+    /// @param _size the number of elements.
+    /// @param _precision the desired output precision.
+    ArrayTrace(std::string_view _name,
+               std::size_t _first_symbol,
+               pointer_type _data,
+               std::size_t _size,
+               int _precision = 32)
+        : Trace(_name, std::to_string(_first_symbol))
+        , data(_data)
+        , size(_size)
+        , first_symbol(_first_symbol)
+        , previous(_size * sizeof(T))
+        , precision(_precision)
+    {
+        if constexpr (is_filtered) {
+            filter_threshold = detail::signal_info<T>::tolerance;
+        }
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The other entity to copy.
+    ArrayTrace(const ArrayTrace &other) = default;
+
+    /// @brief Move constructor.
+    /// @param other The other entity to move.
+    ArrayTrace(ArrayTrace &&other) noexcept = default;
+
+    /// @brief Copy assignment operator.
+    /// @param other The other entity to copy.
+    /// @return A reference to this object.
+    auto operator=(const ArrayTrace &other) -> ArrayTrace & = default;
+
+    /// @brief Move assignment operator.
+    /// @param other The other entity to move.
+    /// @return A reference to this object.
+    auto operator=(ArrayTrace &&other) noexcept -> ArrayTrace & = default;
+
+    ~ArrayTrace() override = default;
+
+    void setScopeFilter(const ChangeFilter &filter) override
+    {
+        if constexpr (is_filtered) {
+            filter_kind      = filter.kind;
+            filter_threshold = filter.threshold;
+        }
+    }
+
+    /// @brief Provides the $var of all the elements, one per line.
+    /// @return the $var of the elements.
+    auto getVar() const -> std::string override
+    {
+        std::string var;
+        for (std::size_t index = 0; index < size; ++index) {
+            // The indentation of the first line is provided by the scope.
+            var += (index > 0) ? "    " : "";
+            var += detail::signal_info<T>::var + std::to_string(first_symbol + index) + " ";
+            var += this->getName() + "[" + std::to_string(index) + "] $end\n";
+        }
+        return var;
+    }
+
+    /// @brief Provides the current value of all the elements.
+    /// @return the current value of the elements.
+    auto getValue() const -> std::string override
+    {
+        std::string value;
+        for (std::size_t index = 0; index < size; ++index) {
+            this->appendElement(value, index);
+        }
+        return value;
+    }
+
+    /// @brief Provides the current value of the elements which have changed.
+    /// @return the current value of the changed elements.
+    auto getChangedValue() const -> std::string override
+    {
+        std::string value;
+        this->forEachChanged([&](std::size_t index) { this->appendElement(value, index); });
+        return value;
+    }
+
+    auto hasChanged() const -> bool override
+    {
+        // The elements which are bitwise equal have not changed.
+        if ((size == 0) || (std::memcmp(previous.data(), data, size * sizeof(T)) == 0)) {
+            return false;
+        }
+        if constexpr (is_exact) {
+            return true;
+        } else {
+            for (std::size_t index = 0; index < size; ++index) {
+                if (this->elementChanged(index)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    void updatePrevious() override
+    {
+        if constexpr (is_filtered) {
+            // Like the scalar traces, keep the last written value of the elements whose change is filtered out.
+            this->forEachChanged([this](std::size_t index) {
+                std::memcpy(previous.data() + (index * sizeof(T)), data + index, sizeof(T));
+            });
+        } else if (size > 0) {
+            std::memcpy(previous.data(), data, size * sizeof(T));
+        }
+    }
+
+    auto getMemoryUsage() const -> std::size_t override { return previous.capacity(); }
+
+    auto getSignalCount() const -> std::size_t override { return size; }
+
+    void summarize(detail::SummaryAccumulator *summaries, std::uint64_t time) const override
+    {
+        for (std::size_t index = 0; index < size; ++index) {
+            summaries[index].add(static_cast<double>(data[index]), time);
+        }
+    }
+
+    void saveState(std::string &buffer) const override
+    {
+        detail::append_raw(buffer, static_cast<std::uint64_t>(previous.size()));
+        buffer.append(reinterpret_cast<const char *>(previous.data()), previous.size());
+    }
+
+    void loadState(detail::RawReader &reader) override
+    {
+        std::uint64_t length = 0;
+        reader.read(length);
+        if (length != previous.size()) {
+            throw std::runtime_error("The checkpoint of the array '" + this->getName() + "' has a different size.");
+        }
+        const char *bytes = reader.bytes(previous.size());
+        if (!previous.empty()) {
+            std::memcpy(previous.data(), bytes, previous.size());
+        }
+    }
+
+    void captureValue(std::string &buffer, bool whole) const override
+    {
+        // Store the number of elements, followed by the elements, with their index if not whole.
+        const std::size_t start = buffer.size();
+        std::uint32_t count     = 0;
+        detail::append_raw(buffer, count);
+        detail::append_raw(buffer, static_cast<unsigned char>(whole));
+        if (whole) {
+            buffer.append(reinterpret_cast<const char *>(data), size * sizeof(T));
+            count = static_cast<std::uint32_t>(size);
+        } else {
+            this->forEachChanged([&](std::size_t index) {
+                detail::append_raw(buffer, static_cast<std::uint32_t>(index));
+                detail::append_raw(buffer, data[index]);
+                ++count;
+            });
+        }
+        std::memcpy(&buffer[start], &count, sizeof(count));
+    }
+
+    auto renderValue(std::string &output, const char *raw) const -> const char * override
+    {
+        const auto count = detail::read_raw<std::uint32_t>(raw);
+        const bool whole = detail::read_raw<unsigned char>(raw) != 0;
+        for (std::uint32_t element = 0; element < count; ++element) {
+            const std::uint32_t index = whole ? element : detail::read_raw<std::uint32_t>(raw);
+            detail::append_value(output, detail::read_raw<T>(raw), precision);
+            detail::append_symbol(output, first_symbol + index);
+        }
+        return raw;
+    }
+
+    /// @brief Changes the output precision for floating point values.
+    /// @param _precision the desired output precision.
+    void setPrecision(int _precision) { precision = _precision; }
+
+    /// @brief Returns the number of traced elements.
+    /// @return the number of elements.
+    auto getSize() const -> std::size_t { return size; }
+
+private:
+    /// If true, the elements are floating point values, whose changes are checked by a filter.
+    static constexpr bool is_filtered = std::is_floating_point<T>::value;
+    /// If true, the elements have changed if and only if their bytes differ.
+    static constexpr bool is_exact = !is_filtered && (detail::significant_bytes<T> == sizeof(T));
+
+    /// A pointer to the first traced element.
+    pointer_type data;
+    /// The number of traced elements.
+    std::size_t size;
+    /// The index of the symbol of the first element.
+    std::size_t first_symbol;
+    /// Contiguous copy of the bytes of the previous values of the elements.
+    std::vector<unsigned char> previous;
+    /// The floating point precision.
+    int precision;
+    /// The kind of filter used to check if a floating point element has changed.
+    FilterKind filter_kind{FilterKind::Tolerance};
+    /// The threshold of the filter, by default the tolerance used to check equality.
+    double filter_threshold{};
+
+    /// @brief Checks if an element has changed: its significant bytes differ, and so does its value for the filter.
+    /// @param index the index of the element.
+    /// @return true if the element has changed.
+    auto elementChanged(std::size_t index) const -> bool
+    {
+        const unsigned char *last = previous.data() + (index * sizeof(T));
+        if (std::memcmp(last, data + index, detail::significant_bytes<T>) == 0) {
+            return false;
+        }
+        if constexpr (is_filtered) {
+            T value;
+            std::memcpy(&value, last, sizeof(T));
+            return detail::filter_changed(value, data[index], filter_kind, filter_threshold);
+        } else {
+            return true;
+        }
+    }
+
+    /// @brief Calls the function with the index of each element which has changed, in order.
+    /// @param function the function, receiving the index of the element.
+    template <typename Function>
+    void forEachChanged(Function &&function) const
+    {
+        if constexpr (is_exact) {
+            simd::for_each_mismatch<sizeof(T)>(previous.data(), data, size, std::forward<Function>(function));
+        } else if constexpr (detail::significant_bytes<T> == sizeof(T)) {
+            // The elements which differ bitwise are checked again by the filter.
+            simd::for_each_mismatch<sizeof(T)>(previous.data(), data, size, [&](std::size_t index) {
+                if (this->elementChanged(index)) {
+                    function(index);
+                }
+            });
+        } else {
+            // The vectorized comparison would include the padding bytes.
+            for (std::size_t index = 0; index < size; ++index) {
+                if (this->elementChanged(index)) {
+                    function(index);
+                }
+            }
+        }
+    }
+
+    /// @brief Appends the value of the given element.
+    /// @param value the output string.
+    /// @param index the index of the element.
+    void appendElement(std::string &value, std::size_t index) const
+    {
+        detail::append_value(value, data[index], precision);
+        detail::append_symbol(value, first_symbol + index);
+    }
+};
+
+} // namespace cpptracer
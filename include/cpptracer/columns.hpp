@@ -0,0 +1,333 @@
+/// @file columns.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the exporter writing the values of the signals as columns, for the analysis tools.
+
+#pragma once
+
+#include "trace.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace cpptracer
+{
+
+/// @brief The format of the columnar export, see Tracer::enableColumnarExport.
+enum class ColumnFormat {
+    Npy, ///< A NumPy file for each signal, with the time and the value of each change.
+    Csv  ///< A single CSV table, with a row for each sample and a column for each signal.
+};
+
+namespace detail
+{
+
+/// @brief The size of the header of the NumPy files, large enough for any number of records.
+constexpr std::size_t npy_header_size = 128;
+
+/// @brief Provides the character which describes the byte order of the machine inside the NumPy types.
+/// @return '<' on little-endian machines, '>' on big-endian ones.
+inline auto npy_byte_order() -> char
+{
+    const std::uint16_t probe = 1;
+    unsigned char first       = 0;
+    std::memcpy(&first, &probe, 1);
+    return (first == 1) ? '<' : '>';
+}
+
+/// @brief Builds the header of a NumPy file holding an array of (time, value) records.
+/// @details The header has always the same size, so that the number of
+/// records can be written again once the file is complete.
+/// @param type the NumPy type of the values, without the byte order (e.g., "i4").
+/// @param count the number of records.
+/// @return the header.
+inline auto npy_header(const char *type, std::uint64_t count) -> std::string
+{
+    // Single bytes have no byte order.
+    const char order = (type[1] == '1') ? '|' : npy_byte_order();
+    std::string dict = "{'descr': [('time', '";
+    dict.push_back(npy_byte_order());
+    dict.append("u8'), ('value', '");
+    dict.push_back(order);
+    dict.append(type).append("')], 'fortran_order': False, 'shape': (");
+    dict.append(std::to_string(count)).append(",), }");
+    // The magic string, the version, and the length of the dictionary take 10 bytes.
+    dict.resize(npy_header_size - 11U, ' ');
+    dict.push_back('\n');
+    std::string header("\x93NUMPY\x01\x00", 8);
+    header.push_back(static_cast<char>(dict.size() & 0xFFU));
+    header.push_back(static_cast<char>(dict.size() >> 8U));
+    return header + dict;
+}
+
+/// @brief Appends a number stored in its native representation as text.
+/// @tparam T the type of the number.
+/// @param output the output string.
+/// @param bytes the bytes of the number.
+template <typename T>
+inline void append_column_number(std::string &output, const char *bytes)
+{
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    char text[32];
+    const auto result = std::to_chars(text, text + sizeof(text), value);
+    output.append(text, result.ptr);
+}
+
+/// @brief Appends an integer stored in its native representation as text.
+/// @tparam Signed the signed type of the integer.
+/// @tparam Unsigned the unsigned type of the integer.
+/// @param output the output string.
+/// @param kind the kind of the NumPy type, 'i' for signed integers and 'u' for unsigned ones.
+/// @param bytes the bytes of the integer.
+template <typename Signed, typename Unsigned>
+inline void append_column_integer(std::string &output, char kind, const char *bytes)
+{
+    if (kind == 'i') {
+        append_column_number<Signed>(output, bytes);
+    } else {
+        append_column_number<Unsigned>(output, bytes);
+    }
+}
+
+/// @brief Appends a value stored in its native representation as text, using the shortest exact form.
+/// @param output the output string.
+/// @param type the NumPy type of the value, without the byte order.
+/// @param bytes the bytes of the value.
+inline void append_column_text(std::string &output, const char *type, const char *bytes)
+{
+    const char kind = type[0];
+    const char size = type[1];
+    if (kind == 'b') {
+        output.push_back((bytes[0] != 0) ? '1' : '0');
+    } else if (kind == 'f') {
+        if (size == '4') {
+            append_column_number<float>(output, bytes);
+        } else {
+            append_column_number<double>(output, bytes);
+        }
+    } else if (size == '1') {
+        append_column_integer<std::int8_t, std::uint8_t>(output, kind, bytes);
+    } else if (size == '2') {
+        append_column_integer<std::int16_t, std::uint16_t>(output, kind, bytes);
+    } else if (size == '4') {
+        append_column_integer<std::int32_t, std::uint32_t>(output, kind, bytes);
+    } else {
+        append_column_integer<std::int64_t, std::uint64_t>(output, kind, bytes);
+    }
+}
+
+/// @brief Writes the values of the signals as columns, while tracing.
+/// @details With NumPy files, each change of a signal appends a record with
+/// its time and its value, in the native binary representation, so that the
+/// files can be memory-mapped without parsing them. With the CSV table, each
+/// sample appends a row with the values of all the signals. The values are
+/// buffered, and written once the buffers exceed flush_bytes.
+class ColumnExporter
+{
+public:
+    /// The number of buffered bytes after which the buffers are written.
+    static constexpr std::size_t flush_bytes = std::size_t(4) << 20U;
+    /// The position of the traces which are not exported.
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /// @brief Constructor.
+    /// @param _prefix the prefix of the names of the files, i.e., the name of the trace.
+    /// @param _format the format of the columns.
+    ColumnExporter(std::string _prefix, ColumnFormat _format)
+        : prefix(std::move(_prefix))
+        , format(_format)
+    {
+        // Nothing to do.
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The other entity to copy.
+    ColumnExporter(const ColumnExporter &other) = delete;
+
+    /// @brief Copy assignment operator.
+    /// @param other The other entity to copy.
+    /// @return A reference to this object.
+    auto operator=(const ColumnExporter &other) -> ColumnExporter & = delete;
+
+    /// @brief Destructor.
+    ~ColumnExporter() = default;
+
+    /// @brief Adds the column of a trace, the traces whose values cannot be exported are ignored.
+    /// @param trace the trace.
+    /// @param path the dot-separated path of the trace, starting from the root.
+    /// @return the position of the column, npos if ignored.
+    auto addColumn(const Trace *trace, const std::string &path) -> std::size_t
+    {
+        const char *type = trace->getColumnType();
+        if (type == nullptr) {
+            return npos;
+        }
+        const bool npy = (format == ColumnFormat::Npy);
+        columns.emplace_back(Column{trace, type, npy ? prefix + "." + path + ".npy" : path, std::string(), 0U});
+        return columns.size() - 1U;
+    }
+
+    /// @brief Creates the files, replacing the existing ones.
+    /// @return true on success, false otherwise.
+    auto open() -> bool
+    {
+        if (format == ColumnFormat::Csv) {
+            // The header lists the paths of the signals, quoted.
+            table = "time";
+            for (const auto &column : columns) {
+                table.append(",\"").append(column.name).append("\"");
+            }
+            table.push_back('\n');
+            const bool success = this->writeFile(prefix + ".columns.csv", table, false);
+            table.clear();
+            return success;
+        }
+        bool success = true;
+        for (const auto &column : columns) {
+            success = this->writeFile(column.name, npy_header(column.type, 0), false) && success;
+        }
+        return success;
+    }
+
+    /// @brief Adds the change of a signal, with NumPy files.
+    /// @param column the position of the column, as returned by addColumn.
+    /// @param time the scaled time of the change.
+    /// @param raw the bytes stored by captureValue, or null to read the variable.
+    void addChange(std::size_t column, std::uint64_t time, const char *raw)
+    {
+        if ((format != ColumnFormat::Npy) || (column == npos)) {
+            return;
+        }
+        auto &current       = columns[column];
+        const auto previous = current.buffer.size();
+        append_raw(current.buffer, time);
+        current.trace->appendColumnValue(current.buffer, raw);
+        ++current.count;
+        buffered_bytes += current.buffer.size() - previous;
+        if (buffered_bytes >= flush_bytes) {
+            this->flush();
+        }
+    }
+
+    /// @brief Adds a row with the current values of all the signals, with the CSV table.
+    /// @param time the scaled time of the sample.
+    void addRow(std::uint64_t time)
+    {
+        if (format != ColumnFormat::Csv) {
+            return;
+        }
+        const auto previous = table.size();
+        table.append(std::to_string(time));
+        for (const auto &column : columns) {
+            scratch.clear();
+            column.trace->appendColumnValue(scratch, nullptr);
+            table.push_back(',');
+            append_column_text(table, column.type, scratch.data());
+        }
+        table.push_back('\n');
+        buffered_bytes += table.size() - previous;
+        if (buffered_bytes >= flush_bytes) {
+            this->flush();
+        }
+    }
+
+    /// @brief Writes the buffered values to the files.
+    /// @return true on success, false otherwise.
+    auto flush() -> bool
+    {
+        bool success = true;
+        if (format == ColumnFormat::Csv) {
+            success = this->writeFile(prefix + ".columns.csv", table, true);
+            table.clear();
+        } else {
+            // The files are opened only while writing, so that their number is not limited.
+            for (auto &column : columns) {
+                if (!column.buffer.empty()) {
+                    success = this->writeFile(column.name, column.buffer, true) && success;
+                    column.buffer.clear();
+                }
+            }
+        }
+        buffered_bytes = 0;
+        return success;
+    }
+
+    /// @brief Writes the buffered values, and the number of records inside the headers of the NumPy files.
+    /// @return true on success, false otherwise.
+    auto close() -> bool
+    {
+        bool success = this->flush();
+        if (format == ColumnFormat::Npy) {
+            for (const auto &column : columns) {
+                std::fstream file(column.name, std::ios::in | std::ios::out | std::ios::binary);
+                const std::string header = npy_header(column.type, column.count);
+                file.write(header.data(), static_cast<std::streamsize>(header.size()));
+                if (!file) {
+                    std::cerr << "Failed to complete the column file '" << column.name << "'\n";
+                    success = false;
+                }
+            }
+        }
+        return success;
+    }
+
+    /// @brief Returns the memory used by the exporter.
+    /// @return the number of bytes.
+    auto getMemoryUsage() const -> std::size_t
+    {
+        return buffered_bytes + table.capacity() + (columns.capacity() * sizeof(Column));
+    }
+
+private:
+    /// @brief The column of a signal.
+    struct Column {
+        /// The trace providing the values.
+        const Trace *trace;
+        /// The NumPy type of the values.
+        const char *type;
+        /// The name of the NumPy file, or the path of the signal for the CSV table.
+        std::string name;
+        /// The buffered records, with NumPy files.
+        std::string buffer;
+        /// The number of records, with NumPy files.
+        std::uint64_t count;
+    };
+
+    /// The prefix of the names of the files.
+    std::string prefix;
+    /// The format of the columns.
+    ColumnFormat format;
+    /// The columns of the exported signals.
+    std::vector<Column> columns;
+    /// The buffered rows, with the CSV table.
+    std::string table;
+    /// The bytes of a single value, reused for each one.
+    std::string scratch;
+    /// Number of buffered bytes.
+    std::size_t buffered_bytes{};
+
+    /// @brief Writes a buffer to a file.
+    /// @param name the name of the file.
+    /// @param data the buffer.
+    /// @param append if true, the buffer is appended to the file, otherwise it replaces it.
+    /// @return true on success, false otherwise.
+    static auto writeFile(const std::string &name, const std::string &data, bool append) -> bool
+    {
+        std::ofstream file(name, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            std::cerr << "Failed to write the column file '" << name << "'\n";
+            return false;
+        }
+        return true;
+    }
+};
+
+} // namespace detail
+
+} // namespace cpptracer
@@ -26,7 +26,7 @@ namespace compression
 /// @param str the input string to compress.
 /// @param level the compression level.
 /// @return the compressed string.
-std::string compress(std::string const &str, int level = Z_BEST_COMPRESSION)
+inline std::string compress(std::string const &str, int level = Z_BEST_COMPRESSION)
 {
     // Variable used to track return value from zlib.
     int ret;
@@ -76,7 +76,7 @@ std::string compress(std::string const &str, int level = Z_BEST_COMPRESSION)
 /// @brief Decompress an STL string using zlib and return the original data.
 /// @param str the input string.
 /// @return the decompressed string.
-std::string decompress(std::string const &str)
+inline std::string decompress(std::string const &str)
 {
     // z_stream is zlib's control structure
     z_stream zs;
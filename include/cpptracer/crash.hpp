@@ -0,0 +1,167 @@
+/// @file crash.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the handler which writes the buffered trace when the process receives a fatal signal.
+
+#pragma once
+
+#include "sink.hpp"
+
+#ifdef CPPTRACER_POSIX
+
+#include <array>
+#include <atomic>
+#include <csignal>
+#include <cstddef>
+#include <stdexcept>
+
+namespace cpptracer
+{
+
+namespace detail
+{
+
+/// @brief The part of the trace written by the handler of the fatal signals, see Tracer::enableCrashFlush.
+/// @details The tracer commits the part of its output buffer which ends with
+/// a complete sample, and the handler hands it to the sink, so the trace is
+/// truncated at that sample. The handlers are installed by the first
+/// instance, and run the previous ones once the traces are written.
+class CrashFlush
+{
+public:
+    /// @brief Constructor, registers the trace with the handler.
+    /// @param _sink the sink which writes the trace.
+    explicit CrashFlush(TraceSink *_sink)
+        : sink(_sink)
+    {
+        static const bool installed = CrashFlush::install();
+        (void)installed;
+        for (auto &slot : CrashFlush::slots()) {
+            CrashFlush *expected = nullptr;
+            if (slot.compare_exchange_strong(expected, this)) {
+                return;
+            }
+        }
+        throw std::runtime_error("Too many tracers flush their trace on the fatal signals.");
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The other entity to copy.
+    CrashFlush(const CrashFlush &other) = delete;
+
+    /// @brief Move constructor.
+    /// @param other The other entity to move.
+    CrashFlush(CrashFlush &&other) = delete;
+
+    /// @brief Copy assignment operator.
+    /// @param other The other entity to copy.
+    /// @return A reference to this object.
+    auto operator=(const CrashFlush &other) -> CrashFlush & = delete;
+
+    /// @brief Move assignment operator.
+    /// @param other The other entity to move.
+    /// @return A reference to this object.
+    auto operator=(CrashFlush &&other) -> CrashFlush & = delete;
+
+    /// @brief Destructor, unregisters the trace.
+    ~CrashFlush()
+    {
+        for (auto &slot : CrashFlush::slots()) {
+            CrashFlush *expected = this;
+            slot.compare_exchange_strong(expected, nullptr);
+        }
+    }
+
+    /// @brief Sets the sink which writes the trace.
+    /// @param _sink the sink.
+    void setSink(TraceSink *_sink) { sink.store(_sink); }
+
+    /// @brief Provides the part of the output buffer which ends with a complete sample.
+    /// @return the committed part, kept up to date by the output buffer.
+    auto getTail() -> CommittedTail * { return &tail; }
+
+private:
+    /// The maximum number of registered traces.
+    static constexpr std::size_t max_traces = 16;
+    /// The fatal signals, the last two are handled only if they have not been handled already.
+    static constexpr std::array<int, 7> signals{SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGTERM, SIGINT};
+
+    /// The sink which writes the trace.
+    std::atomic<TraceSink *> sink;
+    /// The committed part of the output buffer.
+    CommittedTail tail;
+
+    /// @brief Provides the registered traces.
+    /// @return the slots, null if free.
+    static auto slots() -> std::array<std::atomic<CrashFlush *>, max_traces> &
+    {
+        static std::array<std::atomic<CrashFlush *>, max_traces> instance{};
+        return instance;
+    }
+
+    /// @brief Provides the actions which were set before installing the handler.
+    /// @return the actions, in the same order of the signals.
+    static auto previous() -> std::array<struct sigaction, signals.size()> &
+    {
+        static std::array<struct sigaction, signals.size()> instance{};
+        return instance;
+    }
+
+    /// @brief Installs the handler for the fatal signals.
+    /// @details The termination requests are left alone if the program
+    /// handles them already, since it may close the trace and keep running.
+    /// @return true.
+    static auto install() -> bool
+    {
+        for (std::size_t index = 0; index < signals.size(); ++index) {
+            struct sigaction &old = CrashFlush::previous()[index];
+            ::sigaction(signals[index], nullptr, &old);
+            const bool request = (signals[index] == SIGTERM) || (signals[index] == SIGINT);
+            if (request && (((old.sa_flags & SA_SIGINFO) != 0) || (old.sa_handler != SIG_DFL))) {
+                continue;
+            }
+            struct sigaction action {};
+            action.sa_handler = &CrashFlush::handle;
+            action.sa_flags   = SA_ONSTACK;
+            sigemptyset(&action.sa_mask);
+            ::sigaction(signals[index], &action, nullptr);
+        }
+        return true;
+    }
+
+    /// @brief Writes the committed part of each trace, then runs the previous action.
+    /// @param signal the signal.
+    static void handle(int signal)
+    {
+        static std::atomic<bool> handling{false};
+        // A signal raised while writing skips straight to the previous action.
+        if (!handling.exchange(true)) {
+            for (auto &slot : CrashFlush::slots()) {
+                if (CrashFlush *flush = slot.load()) {
+                    flush->flush();
+                }
+            }
+        }
+        for (std::size_t index = 0; index < signals.size(); ++index) {
+            if (signals[index] == signal) {
+                ::sigaction(signal, &CrashFlush::previous()[index], nullptr);
+            }
+        }
+        // The signal is blocked until the handler returns, then the previous action runs.
+        std::raise(signal);
+    }
+
+    /// @brief Hands the committed part of the output buffer to the sink.
+    void flush() noexcept
+    {
+        TraceSink *target = sink.load();
+        if (target != nullptr) {
+            tail.flush([target](const char *bytes, std::size_t length) { target->emergencyWrite(bytes, length); });
+        }
+    }
+};
+
+} // namespace detail
+
+} // namespace cpptracer
+
+#endif
@@ -0,0 +1,251 @@
+/// @file deferred.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the buffer which postpones the formatting of the sampled values.
+
+#pragma once
+
+#include "format.hpp"
+#include "trace.hpp"
+
+#include <atomic>
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace cpptracer
+{
+
+/// @brief When the tracer turns the sampled values into text.
+enum class DeferredFormatting {
+    Off,       ///< The values are formatted while sampling.
+    OnFlush,   ///< The raw values are stored while sampling, and formatted when the trace is written.
+    Background ///< The raw values are stored while sampling, and formatted by a background thread.
+};
+
+namespace detail
+{
+
+/// @brief Buffer of raw records, which are rendered to VCD text later.
+/// @details Each sample is stored as a sequence of records, made of a tag
+/// followed by its data. Values are stored as the pointer to their trace,
+/// followed by the bytes written by Trace::captureValue. In background mode,
+/// full batches of records are rendered by a separate thread, in order.
+class DeferredBuffer
+{
+public:
+    /// @brief Constructor.
+    /// @param background if true, the batches are rendered by a background thread.
+    explicit DeferredBuffer(bool background)
+    {
+        if (background) {
+            worker = std::thread([this]() { this->workerLoop(); });
+        }
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The other entity to copy.
+    DeferredBuffer(const DeferredBuffer &other) = delete;
+
+    /// @brief Copy assignment operator.
+    /// @param other The other entity to copy.
+    /// @return A reference to this object.
+    auto operator=(const DeferredBuffer &other) -> DeferredBuffer & = delete;
+
+    /// @brief Destructor, stops the background thread.
+    ~DeferredBuffer()
+    {
+        if (worker.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            condition.notify_all();
+            worker.join();
+        }
+    }
+
+    /// @brief Stores the beginning of the initial dump.
+    void beginDump() { records.push_back(tag_dump); }
+
+    /// @brief Stores the end of the initial dump.
+    void endDump() { records.push_back(tag_end); }
+
+    /// @brief Stores the beginning of a sample.
+    /// @param time the scaled time of the sample.
+    void beginSample(std::uint64_t time)
+    {
+        records.push_back(tag_time);
+        append_raw(records, time);
+    }
+
+    /// @brief Stores the value of a trace.
+    /// @param trace the trace.
+    /// @param whole if true, the whole value is stored, otherwise only its changed part.
+    void capture(const Trace *trace, bool whole)
+    {
+        records.push_back(tag_value);
+        append_raw(records, trace);
+        trace->captureValue(records, whole);
+    }
+
+    /// @brief Stores a value of a trace, given as raw bytes.
+    /// @param trace the trace.
+    /// @param raw the raw bytes, as stored by Trace::captureValue.
+    /// @param size the number of bytes.
+    void capture(const Trace *trace, const char *raw, std::size_t size)
+    {
+        records.push_back(tag_value);
+        append_raw(records, trace);
+        records.append(raw, size);
+    }
+
+    /// @brief Ends a sample, handing the records to the background thread if there are enough of them.
+    void endSample()
+    {
+        if (worker.joinable() && (records.size() >= batch_size)) {
+            this->submit();
+        }
+    }
+
+    /// @brief Returns the number of bytes stored, and not yet collected.
+    /// @return the number of bytes.
+    auto size() const -> std::size_t { return records.capacity() + pending_bytes.load(); }
+
+    /// @brief Writes the text rendered by the background thread, without waiting for it.
+    /// @param stream the output stream.
+    void collect(std::ostream &stream)
+    {
+        if (!worker.joinable()) {
+            return;
+        }
+        std::string text;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            text.swap(rendered);
+        }
+        pending_bytes -= text.size();
+        stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    /// @brief Renders all the stored records, and writes them.
+    /// @param stream the output stream.
+    void flush(std::ostream &stream)
+    {
+        if (worker.joinable()) {
+            // Wait for the pending batches, so that the order is preserved.
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return queue.empty() && !busy; });
+            lock.unlock();
+            this->collect(stream);
+        }
+        std::string text;
+        DeferredBuffer::render(records, text);
+        records.clear();
+        stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+private:
+    /// Tag of the beginning of the initial dump.
+    static constexpr char tag_dump  = 'd';
+    /// Tag of the end of the initial dump.
+    static constexpr char tag_end   = 'e';
+    /// Tag of the beginning of a sample, followed by its time.
+    static constexpr char tag_time  = 't';
+    /// Tag of a value, followed by its trace and by its raw bytes.
+    static constexpr char tag_value = 'v';
+    /// Number of bytes of records handed to the background thread at once.
+    static constexpr std::size_t batch_size = 256U * 1024U;
+
+    /// The records which have not been handed to the background thread.
+    std::string records;
+    /// The background thread.
+    std::thread worker;
+    /// Protects the queue and the rendered text.
+    std::mutex mutex;
+    /// Signals a change of the queue.
+    std::condition_variable condition;
+    /// The batches waiting to be rendered.
+    std::deque<std::string> queue;
+    /// The text rendered by the background thread, not yet collected.
+    std::string rendered;
+    /// Number of bytes queued or rendered, and not yet collected.
+    std::atomic<std::size_t> pending_bytes{0};
+    /// If true, the background thread is rendering a batch.
+    bool busy{false};
+    /// If true, the background thread must terminate.
+    bool stopping{false};
+
+    /// @brief Hands the stored records to the background thread.
+    void submit()
+    {
+        pending_bytes += records.size();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.emplace_back(std::move(records));
+        }
+        condition.notify_all();
+        records = std::string();
+        records.reserve(batch_size + batch_size / 4U);
+    }
+
+    /// @brief The loop of the background thread.
+    void workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            std::string batch = std::move(queue.front());
+            queue.pop_front();
+            busy = true;
+            lock.unlock();
+            std::string text;
+            DeferredBuffer::render(batch, text);
+            lock.lock();
+            rendered += text;
+            busy = false;
+            // The text replaces the records it comes from.
+            pending_bytes += text.size();
+            pending_bytes -= batch.size();
+            condition.notify_all();
+        }
+    }
+
+    /// @brief Renders a sequence of records to text.
+    /// @param batch the records.
+    /// @param text the output text.
+    static void render(const std::string &batch, std::string &text)
+    {
+        const char *raw = batch.data();
+        const char *end = raw + batch.size();
+        while (raw < end) {
+            const char tag = *raw++;
+            if (tag == tag_value) {
+                const auto *trace = read_raw<const Trace *>(raw);
+                raw               = trace->renderValue(text, raw);
+            } else if (tag == tag_time) {
+                text += '#';
+                char chars[24];
+                auto result = std::to_chars(chars, chars + sizeof(chars), read_raw<std::uint64_t>(raw));
+                *result.ptr = '\n';
+                text.append(chars, static_cast<std::size_t>(result.ptr - chars) + 1U);
+            } else if (tag == tag_dump) {
+                text += "$dumpvars\n";
+            } else {
+                text += "$end\n";
+            }
+        }
+    }
+};
+
+} // namespace detail
+
+} // namespace cpptracer
@@ -0,0 +1,232 @@
+/// @file direct_sink.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the Linux sink which writes the trace file bypassing the page cache.
+
+#pragma once
+
+#include "sink.hpp"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+namespace cpptracer
+{
+
+/// @brief Writes the trace to a file with direct I/O, bypassing the page cache.
+/// @details The buffers are gathered inside an aligned block, which is
+/// written with `pwrite` once full, so at high rates the trace does not
+/// thrash the page cache, and each system call writes a whole block. The
+/// last, partial block is written when the sink is closed. If the file system
+/// does not support direct I/O (e.g., tmpfs), the file is opened normally
+/// and each buffer is written as it arrives with `write`.
+class DirectFileSink : public TraceSink
+{
+public:
+    /// @brief Constructor, opens and truncates the file.
+    /// @param _filename the name of the file.
+    /// @param _block_size the size of the blocks, a multiple of the alignment.
+    explicit DirectFileSink(std::string _filename, std::size_t _block_size = std::size_t(1) << 20U)
+        : filename(std::move(_filename))
+        , block_size(std::max(alignment, _block_size - (_block_size % alignment)))
+    {
+        fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_DIRECT, 0644);
+        if (fd >= 0) {
+            void *memory = nullptr;
+            if (::posix_memalign(&memory, alignment, block_size) != 0) {
+                ::close(fd);
+                throw std::runtime_error("Cannot allocate the block of the trace file '" + filename + "'.");
+            }
+            block = static_cast<char *>(memory);
+        } else {
+            // Fall back to the buffered writes.
+            fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        }
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open the trace file '" + filename + "': " + std::strerror(errno));
+        }
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The other entity to copy.
+    DirectFileSink(const DirectFileSink &other) = delete;
+
+    /// @brief Move constructor.
+    /// @param other The other entity to move.
+    DirectFileSink(DirectFileSink &&other) = delete;
+
+    /// @brief Copy assignment operator.
+    /// @param other The other entity to copy.
+    /// @return A reference to this object.
+    auto operator=(const DirectFileSink &other) -> DirectFileSink & = delete;
+
+    /// @brief Move assignment operator.
+    /// @param other The other entity to move.
+    /// @return A reference to this object.
+    auto operator=(DirectFileSink &&other) -> DirectFileSink & = delete;
+
+    /// @brief Destructor, writes the last block and closes the file.
+    ~DirectFileSink() override
+    {
+        this->close();
+        std::free(block);
+    }
+
+    auto write(std::string &buffer) -> bool override
+    {
+        if (fd < 0) {
+            return false;
+        }
+        if (block == nullptr) {
+            return this->writeAll(buffer.data(), buffer.size());
+        }
+        // Fill the block, and write it whenever it is full.
+        for (std::size_t done = 0; done < buffer.size();) {
+            const std::size_t count = std::min(block_size - used, buffer.size() - done);
+            std::memcpy(block + used, buffer.data() + done, count);
+            used += count;
+            done += count;
+            if ((used == block_size) && !this->writeBlock()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    auto close() -> bool override
+    {
+        if (fd < 0) {
+            return true;
+        }
+        const bool success = this->writeTail();
+        const bool closed  = (::close(fd) == 0);
+        fd                 = -1;
+        return closed && success;
+    }
+
+    auto sync() -> bool override
+    {
+        if (fd < 0) {
+            return false;
+        }
+        // The partial block is written as well, and written again once it is full.
+        return this->writeTail() && (::fsync(fd) == 0);
+    }
+
+    auto emergencyWrite(const char *data, std::size_t size) noexcept -> bool override
+    {
+        if (fd < 0) {
+            return false;
+        }
+        if (block == nullptr) {
+            return detail::write_fd(fd, data, size);
+        }
+        // The data is not aligned, write it after the partial block without direct I/O.
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) & ~O_DIRECT);
+        return this->pwriteAll(block, used, offset) && this->pwriteAll(data, size, offset + used) &&
+               (::ftruncate(fd, static_cast<off_t>(offset + used + size)) == 0);
+    }
+
+    /// @brief Checks if the file is written with direct I/O.
+    /// @return true if the direct I/O is used, false if it fell back to the buffered writes.
+    auto isDirect() const -> bool { return block != nullptr; }
+
+    /// @brief Provides the name of the file.
+    /// @return the name of the file.
+    auto getFilename() const -> const std::string & { return filename; }
+
+private:
+    /// The alignment required by the direct I/O, which covers the common logical block sizes.
+    static constexpr std::size_t alignment = 4096U;
+
+    /// The name of the file.
+    std::string filename;
+    /// The size of the blocks.
+    std::size_t block_size;
+    /// The file descriptor, negative once closed.
+    int fd{-1};
+    /// The aligned block, null if the direct I/O is not available.
+    char *block{nullptr};
+    /// The number of bytes inside the block.
+    std::size_t used{0};
+    /// The position of the next block inside the file.
+    std::size_t offset{0};
+
+    /// @brief Writes the full block at the current offset, and empties it.
+    /// @return true on success, false otherwise.
+    auto writeBlock() -> bool
+    {
+        if (!this->pwriteAll(block, block_size, offset)) {
+            std::cerr << "Failed to write the trace file '" << filename << "': " << std::strerror(errno) << "\n";
+            return false;
+        }
+        offset += block_size;
+        used = 0;
+        return true;
+    }
+
+    /// @brief Writes the partial block, padded to the alignment, and cuts the file to the size of the trace.
+    /// @details The block is kept, so the following writes keep filling it.
+    /// @return true on success, false otherwise.
+    auto writeTail() -> bool
+    {
+        if ((block == nullptr) || (used == 0)) {
+            return true;
+        }
+        std::memset(block + used, 0, block_size - used);
+        if (!this->pwriteAll(block, ((used + alignment - 1) / alignment) * alignment, offset)) {
+            std::cerr << "Failed to write the trace file '" << filename << "': " << std::strerror(errno) << "\n";
+            return false;
+        }
+        return ::ftruncate(fd, static_cast<off_t>(offset + used)) == 0;
+    }
+
+    /// @brief Writes the given bytes at the given position, using only async-signal-safe calls.
+    /// @param data the bytes, aligned if the direct I/O is used.
+    /// @param size the number of bytes, a multiple of the alignment if the direct I/O is used.
+    /// @param position the position inside the file.
+    /// @return true on success, false otherwise.
+    auto pwriteAll(const char *data, std::size_t size, std::size_t position) noexcept -> bool
+    {
+        for (std::size_t done = 0; done < size;) {
+            const ssize_t count = ::pwrite(fd, data + done, size - done, static_cast<off_t>(position + done));
+            if ((count < 0) && (errno == EINTR)) {
+                continue;
+            }
+            if ((count < 0) && (errno == EINVAL) && ((::fcntl(fd, F_GETFL) & O_DIRECT) != 0)) {
+                // The file system accepted the flag, but not the direct writes.
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) & ~O_DIRECT);
+                continue;
+            }
+            if (count <= 0) {
+                return false;
+            }
+            done += static_cast<std::size_t>(count);
+        }
+        return true;
+    }
+
+    /// @brief Writes the given bytes at the end of the file.
+    /// @param data the bytes.
+    /// @param size the number of bytes.
+    /// @return true on success, false otherwise.
+    auto writeAll(const char *data, std::size_t size) -> bool
+    {
+        if (!detail::write_fd(fd, data, size)) {
+            std::cerr << "Failed to write the trace file '" << filename << "': " << std::strerror(errno) << "\n";
+            return false;
+        }
+        return true;
+    }
+};
+
+} // namespace cpptracer
+
+#endif
@@ -0,0 +1,17 @@
+/// @file durability.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the policies deciding when the trace is forced to the storage device.
+
+#pragma once
+
+namespace cpptracer
+{
+
+/// @brief When the tracer forces the written trace to the storage device, see Tracer::setDurability.
+enum class Durability {
+    None,      ///< Leaves the written trace to the page cache of the operating system.
+    Periodic,  ///< Writes and syncs the trace once enough bytes or time have accumulated, grouping the syncs.
+    EveryFlush ///< Syncs the trace each time the buffer is written.
+};
+
+} // namespace cpptracer
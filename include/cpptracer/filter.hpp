@@ -0,0 +1,136 @@
+/// @file filter.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the filters which decide if a floating point value has changed.
+
+#pragma once
+
+#include "feq.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace cpptracer
+{
+
+/// @brief The kind of filter applied to a floating point value.
+enum class FilterKind : unsigned char {
+    Tolerance, ///< The relative tolerance of is_equal, the default.
+    Absolute,  ///< Changed if it moves by more than the threshold.
+    Relative,  ///< Changed if it moves by more than the threshold times its magnitude.
+    Ulp,       ///< Changed if it moves by more than the threshold units in the last place.
+    Quantize   ///< Changed if it moves to a different multiple of the step.
+};
+
+/// @brief Decides if a floating point value has changed w.r.t. the last written one.
+/// @details Since the comparison is against the last written value, small
+/// movements do not accumulate unnoticed, and noisy signals produce a new
+/// value only once they leave the band around the last one.
+struct ChangeFilter {
+    /// The kind of filter.
+    FilterKind kind{FilterKind::Tolerance};
+    /// The threshold, for the quantization it is the inverse of the step.
+    double threshold{1e-09};
+
+    /// @brief Provides the default filter, based on a relative tolerance.
+    /// @param tolerance the tolerance used by is_equal.
+    /// @return the filter.
+    static auto tolerance(double tolerance) -> ChangeFilter { return {FilterKind::Tolerance, tolerance}; }
+
+    /// @brief Provides an absolute deadband.
+    /// @param band the largest movement which is ignored.
+    /// @return the filter.
+    static auto absolute(double band) -> ChangeFilter { return {FilterKind::Absolute, band}; }
+
+    /// @brief Provides a relative deadband.
+    /// @param band the largest movement which is ignored, relative to the magnitude of the value.
+    /// @return the filter.
+    static auto relative(double band) -> ChangeFilter { return {FilterKind::Relative, band}; }
+
+    /// @brief Provides a deadband measured in units in the last place.
+    /// @param units the largest distance which is ignored, in units in the last place.
+    /// @return the filter.
+    static auto ulp(std::uint64_t units) -> ChangeFilter { return {FilterKind::Ulp, static_cast<double>(units)}; }
+
+    /// @brief Provides a quantization, the value changes when it moves to a different multiple of the step.
+    /// @param step the quantization step, must be positive.
+    /// @return the filter.
+    static auto quantize(double step) -> ChangeFilter { return {FilterKind::Quantize, 1.0 / step}; }
+};
+
+namespace detail
+{
+
+/// @brief Maps a floating point value to an integer, preserving their order.
+/// @details Negative values have all the bits but the sign flipped, so that
+/// the distance between two integers is their distance in units in the last
+/// place. Long doubles are mapped as doubles.
+/// @tparam T the floating point type.
+/// @param value the value.
+/// @return the ordered integer.
+template <typename T>
+inline auto to_ordered(T value) -> std::int64_t
+{
+    if constexpr (sizeof(T) == sizeof(std::int32_t)) {
+        std::int32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits ^ ((bits >> 31) & INT32_MAX);
+    } else if constexpr (sizeof(T) == sizeof(std::int64_t)) {
+        std::int64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits ^ ((bits >> 63) & INT64_MAX);
+    } else {
+        return to_ordered(static_cast<double>(value));
+    }
+}
+
+/// @brief Checks if a floating point value has changed, according to a filter.
+/// @details Each filter is evaluated with a single comparison, written so
+/// that NaN values always count as changed, unless they are bitwise equal.
+/// @tparam T the floating point type.
+/// @param previous the last written value.
+/// @param current the current value.
+/// @param kind the kind of filter.
+/// @param threshold the threshold of the filter.
+/// @return true if the value has changed.
+template <typename T>
+inline auto filter_changed(T previous, T current, FilterKind kind, double threshold) -> bool
+{
+    static_assert(std::is_floating_point<T>::value, "Filters apply only to floating point values.");
+    if constexpr (sizeof(T) <= sizeof(std::uint64_t)) {
+        if (std::memcmp(&previous, &current, sizeof(T)) == 0) {
+            return false;
+        }
+    } else if ((previous <= current) && (previous >= current)) {
+        // The padding bytes of long doubles are not meaningful.
+        return false;
+    }
+    const auto a = static_cast<double>(previous);
+    const auto b = static_cast<double>(current);
+    switch (kind) {
+    case FilterKind::Absolute:
+        return !(std::abs(a - b) <= threshold);
+    case FilterKind::Relative:
+        return !(std::abs(a - b) <= threshold * std::max(std::abs(a), std::abs(b)));
+    case FilterKind::Ulp: {
+        // The difference is taken as unsigned, so that it cannot overflow.
+        auto distance = static_cast<std::uint64_t>(to_ordered(previous));
+        distance -= static_cast<std::uint64_t>(to_ordered(current));
+        distance = std::min(distance, ~distance + 1U);
+        return static_cast<double>(distance) > threshold;
+    }
+    case FilterKind::Quantize: {
+        const double qa = std::floor(a * threshold + 0.5);
+        const double qb = std::floor(b * threshold + 0.5);
+        return !((qa <= qb) && (qa >= qb));
+    }
+    default:
+        return !is_equal(previous, current, threshold);
+    }
+}
+
+} // namespace detail
+
+} // namespace cpptracer
@@ -0,0 +1,285 @@
+/// @file format.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the functions used to write values in the VCD format.
+
+#pragma once
+
+#include "utilities.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace cpptracer
+{
+
+namespace detail
+{
+
+/// @brief Compile-time description of how a type is written to the VCD.
+/// @tparam T the type of the traced variable.
+template <typename T>
+struct signal_info;
+
+/// @brief Provides the description of bool values.
+template <>
+struct signal_info<bool> {
+    static constexpr const char *var = "$var integer 1 "; ///< The $var prefix.
+    static constexpr const char *npy = "b1";              ///< The NumPy type, without the byte order.
+};
+
+/// @brief Provides the description of int8_t values.
+template <>
+struct signal_info<int8_t> {
+    static constexpr const char *var = "$var integer  8 "; ///< The $var prefix.
+    static constexpr const char *npy = "i1";               ///< The NumPy type, without the byte order.
+};
+
+/// @brief Provides the description of int16_t values.
+template <>
+struct signal_info<int16_t> {
+    static constexpr const char *var = "$var integer 16 "; ///< The $var prefix.
+    static constexpr const char *npy = "i2";               ///< The NumPy type, without the byte order.
+};
+
+/// @brief Provides the description of int32_t values.
+template <>
+struct signal_info<int32_t> {
+    static constexpr const char *var = "$var integer 32 "; ///< The $var prefix.
+    static constexpr const char *npy = "i4";               ///< The NumPy type, without the byte order.
+};
+
+/// @brief Provides the description of int64_t values.
+template <>
+struct signal_info<int64_t> {
+    static constexpr const char *var = "$var integer 64 "; ///< The $var prefix.
+    static constexpr const char *npy = "i8";               ///< The NumPy type, without the byte order.
+};
+
+/// @brief Provides the description of uint8_t values.
+template <>
+struct signal_info<uint8_t> {
+    static constexpr const char *var = "$var integer  8 "; ///< The $var prefix.
+    static constexpr const char *npy = "u1";               ///< The NumPy type, without the byte order.
+};
+
+/// @brief Provides the description of uint16_t values.
+template <>
+struct signal_info<uint16_t> {
+    static constexpr const char *var = "$var integer 16 "; ///< The $var prefix.
+    static constexpr const char *npy = "u2";               ///< The NumPy type, without the byte order.
+};
+
+/// @brief Provides the description of uint32_t values.
+template <>
+struct signal_info<uint32_t> {
+    static constexpr const char *var = "$var integer 32 "; ///< The $var prefix.
+    static constexpr const char *npy = "u4";               ///< The NumPy type, without the byte order.
+};
+
+/// @brief Provides the description of uint64_t values.
+template <>
+struct signal_info<uint64_t> {
+    static constexpr const char *var = "$var integer 64 "; ///< The $var prefix.
+    static constexpr const char *npy = "u8";               ///< The NumPy type, without the byte order.
+};
+
+/// @brief Provides the description of float values.
+template <>
+struct signal_info<float> {
+    static constexpr const char *var    = "$var real 32 "; ///< The $var prefix.
+    static constexpr const char *format = "r%.*e";         ///< The printf format.
+    static constexpr double tolerance   = 1e-09;           ///< The default tolerance.
+    static constexpr const char *npy    = "f4";            ///< The NumPy type, without the byte order.
+};
+
+/// @brief Provides the description of double values.
+template <>
+struct signal_info<double> {
+    static constexpr const char *var    = "$var real 64 "; ///< The $var prefix.
+    static constexpr const char *format = "r%.*e";         ///< The printf format.
+    static constexpr double tolerance   = 1e-12;           ///< The default tolerance.
+    static constexpr const char *npy    = "f8";            ///< The NumPy type, without the byte order.
+};
+
+/// @brief Provides the description of long double values.
+template <>
+struct signal_info<long double> {
+    static constexpr const char *var    = "$var real 64 "; ///< The $var prefix.
+    static constexpr const char *format = "r%.*Le";        ///< The printf format.
+    static constexpr double tolerance   = 1e-24;           ///< The default tolerance.
+    static constexpr const char *npy    = nullptr;         ///< The NumPy type, without the byte order.
+};
+
+/// @brief Provides the description of bool arrays.
+/// @tparam N the size of the array.
+template <std::size_t N>
+struct signal_info<std::array<bool, N>> {
+    static constexpr const char *var = "$var wire "; ///< The $var prefix.
+};
+
+/// @brief Appends the value to the string, followed by a space.
+/// @details Integers are written as binary values, floating point values as
+/// real values with the given precision, and bool arrays as binary vectors.
+/// @tparam T the type of the value.
+/// @param buffer the output string.
+/// @param value the value.
+/// @param precision the precision used for floating point values.
+template <typename T>
+inline void append_value(std::string &buffer, const T &value, int precision)
+{
+    if constexpr (std::is_same<T, bool>::value) {
+        buffer += value ? "b1 " : "b0 ";
+    } else if constexpr (std::is_integral<T>::value) {
+        buffer += 'b';
+        utility::append_binary(buffer, static_cast<std::make_unsigned_t<T>>(value), sizeof(T) * 8U);
+        buffer += ' ';
+    } else if constexpr (std::is_floating_point<T>::value) {
+        char chars[512];
+        int length = std::snprintf(chars, sizeof(chars), signal_info<T>::format, precision, value);
+        buffer.append(chars, std::min(static_cast<std::size_t>(length), sizeof(chars) - 1U));
+        buffer += ' ';
+    } else {
+        buffer += 'b';
+        for (bool bit : value) {
+            buffer += bit ? '1' : '0';
+        }
+        buffer += ' ';
+    }
+}
+
+/// @brief Appends the symbol with the given index to the string, followed by a newline.
+/// @param buffer the output string.
+/// @param index the index of the symbol.
+inline void append_symbol(std::string &buffer, std::size_t index)
+{
+    char chars[24];
+    auto result = std::to_chars(chars, chars + sizeof(chars), index);
+    *result.ptr = '\n';
+    buffer.append(chars, static_cast<std::size_t>(result.ptr - chars) + 1U);
+}
+
+/// @brief Appends the raw bytes of a value to a buffer of records.
+/// @tparam T the type of the value, which must be trivially copyable.
+/// @param buffer the buffer of records.
+/// @param value the value.
+template <typename T>
+inline void append_raw(std::string &buffer, const T &value)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be stored raw.");
+    buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+/// @brief Reads a value stored by append_raw.
+/// @tparam T the type of the value.
+/// @param raw the position of the value, moved past it.
+/// @return the value.
+template <typename T>
+inline auto read_raw(const char *&raw) -> T
+{
+    T value;
+    std::memcpy(&value, raw, sizeof(T));
+    raw += sizeof(T);
+    return value;
+}
+
+/// @brief Appends a value to a checkpoint, see Tracer::saveCheckpoint.
+/// @tparam T the type of the value.
+/// @param buffer the checkpoint.
+/// @param value the value.
+template <typename T>
+inline void append_state(std::string &buffer, const T &value)
+{
+    if constexpr (std::is_same<T, std::vector<bool>>::value) {
+        append_raw(buffer, static_cast<std::uint64_t>(value.size()));
+        for (const bool bit : value) {
+            buffer.push_back(bit ? '1' : '0');
+        }
+    } else {
+        append_raw(buffer, value);
+    }
+}
+
+/// @brief Appends a string to a checkpoint, preceded by its length.
+/// @param buffer the checkpoint.
+/// @param text the string.
+inline void append_string(std::string &buffer, std::string_view text)
+{
+    append_raw(buffer, static_cast<std::uint32_t>(text.size()));
+    buffer.append(text);
+}
+
+/// @brief Reads the values of a checkpoint, checking that they are not truncated.
+class RawReader
+{
+public:
+    /// @brief Constructor.
+    /// @param _data the checkpoint, which must outlive the reader.
+    explicit RawReader(std::string_view _data)
+        : data(_data)
+    {
+        // Nothing to do.
+    }
+
+    /// @brief Reads the given number of bytes.
+    /// @param size the number of bytes.
+    /// @return the position of the bytes.
+    auto bytes(std::size_t size) -> const char *
+    {
+        if (size > data.size()) {
+            throw std::runtime_error("The checkpoint is truncated.");
+        }
+        const char *position = data.data();
+        data.remove_prefix(size);
+        return position;
+    }
+
+    /// @brief Reads a value stored by append_state.
+    /// @tparam T the type of the value.
+    /// @param value the value.
+    template <typename T>
+    void read(T &value)
+    {
+        if constexpr (std::is_same<T, std::vector<bool>>::value) {
+            std::uint64_t size = 0;
+            this->read(size);
+            const char *bits = this->bytes(static_cast<std::size_t>(size));
+            value.assign(static_cast<std::size_t>(size), false);
+            for (std::size_t index = 0; index < value.size(); ++index) {
+                value[index] = (bits[index] == '1');
+            }
+        } else {
+            const char *raw = this->bytes(sizeof(T));
+            value           = read_raw<T>(raw);
+        }
+    }
+
+    /// @brief Reads a string stored with its length.
+    /// @return the string.
+    auto readString() -> std::string_view
+    {
+        std::uint32_t size = 0;
+        this->read(size);
+        return std::string_view(this->bytes(size), size);
+    }
+
+    /// @brief Checks if the whole checkpoint has been read.
+    /// @return true if there is nothing left.
+    auto empty() const -> bool { return data.empty(); }
+
+private:
+    /// The part of the checkpoint which has not been read yet.
+    std::string_view data;
+};
+
+} // namespace detail
+
+} // namespace cpptracer
@@ -0,0 +1,18 @@
+/// @file overflow.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the policies applied when the memory budget of the tracer is exhausted.
+
+#pragma once
+
+namespace cpptracer
+{
+
+/// @brief What the tracer does when its memory budget is exhausted.
+enum class OverflowPolicy {
+    Flush,    ///< Writes the buffered trace to file, and keeps tracing.
+    Drop,     ///< Drops the samples, and counts them, until the buffered trace is flushed.
+    Decimate, ///< Halves the sampling rate each time half of the remaining budget is used, and stops when it is full.
+    Stop      ///< Stops tracing, leaving a comment inside the trace.
+};
+
+} // namespace cpptracer
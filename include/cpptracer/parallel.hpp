@@ -0,0 +1,365 @@
+/// @file parallel.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the engine which samples the traces on several threads.
+
+#pragma once
+
+#include "scope.hpp"
+#include "stats.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cpptracer
+{
+
+namespace detail
+{
+
+/// @brief Pool of threads which run the tasks of a job in parallel.
+/// @details The tasks of a job are claimed one at a time from a shared atomic
+/// counter, so that threads which finish early take over the remaining tasks.
+/// The calling thread takes part in the job.
+class ThreadPool
+{
+public:
+    /// @brief Constructor.
+    /// @param threads the total number of threads, including the calling one.
+    explicit ThreadPool(std::size_t threads)
+    {
+        for (std::size_t index = 1; index < threads; ++index) {
+            workers.emplace_back([this]() { this->workerLoop(); });
+        }
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The other entity to copy.
+    ThreadPool(const ThreadPool &other) = delete;
+
+    /// @brief Copy assignment operator.
+    /// @param other The other entity to copy.
+    /// @return A reference to this object.
+    auto operator=(const ThreadPool &other) -> ThreadPool & = delete;
+
+    /// @brief Destructor, stops the threads.
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        start_condition.notify_all();
+        for (auto &worker : workers) {
+            worker.join();
+        }
+    }
+
+    /// @brief Returns the total number of threads, including the calling one.
+    /// @return the number of threads.
+    auto size() const -> std::size_t { return workers.size() + 1U; }
+
+    /// @brief Runs the given function for each task, and waits for all of them.
+    /// @param tasks the number of tasks.
+    /// @param function the function, receiving the index of the task.
+    void run(std::size_t tasks, std::function<void(std::size_t)> function)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job          = std::move(function);
+            job_size     = tasks;
+            next_task    = 0;
+            busy_workers = workers.size();
+            ++generation;
+        }
+        start_condition.notify_all();
+        this->runTasks();
+        std::unique_lock<std::mutex> lock(mutex);
+        done_condition.wait(lock, [this]() { return busy_workers == 0; });
+    }
+
+private:
+    /// The worker threads.
+    std::vector<std::thread> workers;
+    /// Protects the state of the current job.
+    std::mutex mutex;
+    /// Signals the workers that a new job is available.
+    std::condition_variable start_condition;
+    /// Signals the calling thread that the workers are done.
+    std::condition_variable done_condition;
+    /// The function of the current job.
+    std::function<void(std::size_t)> job;
+    /// The number of tasks of the current job.
+    std::size_t job_size{0};
+    /// The next task to claim.
+    std::atomic<std::size_t> next_task{0};
+    /// The number of workers which have not finished the current job.
+    std::size_t busy_workers{0};
+    /// Identifies the current job.
+    std::uint64_t generation{0};
+    /// If true, the workers must terminate.
+    bool stopping{false};
+
+    /// @brief Claims and runs the tasks of the current job, until none is left.
+    void runTasks()
+    {
+        for (std::size_t task = next_task++; task < job_size; task = next_task++) {
+            job(task);
+        }
+    }
+
+    /// @brief The loop of the worker threads.
+    void workerLoop()
+    {
+        std::uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                start_condition.wait(lock, [this, seen]() { return stopping || (generation != seen); });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+            this->runTasks();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --busy_workers;
+            }
+            done_condition.notify_one();
+        }
+    }
+};
+
+/// @brief Samples the traces on several threads.
+/// @details The hierarchy is flattened into the list of traces in output
+/// order, which is split into chunks. Each chunk is compared and formatted
+/// into its own buffer, and the buffers are concatenated in order, so that
+/// the output is identical to the one of the serial sampling.
+class ParallelSampler
+{
+public:
+    /// @brief Constructor.
+    /// @param threads the total number of threads, including the calling one.
+    explicit ParallelSampler(std::size_t threads)
+        : pool(std::max<std::size_t>(1U, threads))
+    {
+        // Nothing to do.
+    }
+
+    /// @brief Returns the total number of threads.
+    /// @return the number of threads.
+    auto getThreads() const -> std::size_t { return pool.size(); }
+
+    /// @brief Flattens the hierarchy below the given scope.
+    /// @param root the root of the hierarchy.
+    void build(Scope *root)
+    {
+        scopes.clear();
+        parents.clear();
+        traces.clear();
+        // Visit the scopes in the same order as the serial sampling.
+        std::vector<std::pair<Scope *, std::size_t>> stack{{root, 0U}};
+        while (!stack.empty()) {
+            auto current = stack.back();
+            stack.pop_back();
+            const std::size_t index = scopes.size();
+            scopes.emplace_back(current.first);
+            parents.emplace_back(current.second);
+            for (auto *trace : current.first->traces) {
+                traces.emplace_back(trace, index);
+            }
+            for (auto *trace : current.first->adopted) {
+                traces.emplace_back(trace, index | adopted_flag);
+            }
+            for (auto it = current.first->subscopes.rbegin(); it != current.first->subscopes.rend(); ++it) {
+                stack.emplace_back(*it, index);
+            }
+        }
+        states.assign(scopes.size(), 0U);
+        // Use a few chunks per thread, so that faster threads can balance the load.
+        const std::size_t target = pool.size() * 8U;
+        chunk_size               = std::max<std::size_t>(256U, (traces.size() + target - 1U) / target);
+        chunks.resize((traces.size() + chunk_size - 1U) / chunk_size);
+    }
+
+    /// @brief Returns the number of flattened traces.
+    /// @return the number of traces.
+    auto size() const -> std::size_t { return traces.size(); }
+
+    /// @brief Compares and formats the traces, without updating their previous values.
+    /// @details The check which decides if the sample is taken matches the
+    /// serial one: a sample is taken if a value has changed, or if an unmuted
+    /// scope has a pending dump.
+    /// @param force if true, all the values are formatted.
+    /// @return true if the sample has to be taken.
+    auto sample(bool force) -> bool
+    {
+        bool pending = false;
+        // Compute the state of the scopes, parents come before their children.
+        for (std::size_t index = 0; index < scopes.size(); ++index) {
+            Scope *scope             = scopes[index];
+            const unsigned char base = (index == 0) ? (force ? (visible | forced) : visible) : states[parents[index]];
+            unsigned char state      = 0;
+            if (((base & visible) != 0) && !scope->muted) {
+                state = visible | (base & forced);
+                if (scope->dump_pending) {
+                    state |= forced;
+                    pending = true;
+                }
+                if (scope->snapshotChanged()) {
+                    state |= inspected | guarded;
+                } else if ((state & forced) != 0) {
+                    state |= inspected;
+                }
+            }
+            states[index] = state;
+        }
+        // Compare and format the chunks.
+        pool.run(chunks.size(), [this](std::size_t chunk) { this->sampleChunk(chunk); });
+        return pending || std::any_of(chunks.begin(), chunks.end(), [](const Chunk &chunk) { return chunk.changes; });
+    }
+
+    /// @brief Writes the formatted values, in order.
+    /// @param stream the output stream.
+    void write(std::ostream &stream) const
+    {
+        for (const auto &chunk : chunks) {
+            stream.write(chunk.buffer.data(), static_cast<std::streamsize>(chunk.buffer.size()));
+        }
+    }
+
+    /// @brief Calls the given function on each trace written by the sample, in output order.
+    /// @details It must be called before commit, which updates their previous values.
+    /// @param function the function, which receives the trace.
+    template <typename Function>
+    void forEachWritten(Function &&function) const
+    {
+        for (const auto &chunk : chunks) {
+            for (const Trace *trace : chunk.changed) {
+                function(trace);
+            }
+        }
+    }
+
+    /// @brief Updates the previous values of the written traces, and the state of the scopes.
+    /// @return the number of written values.
+    auto commit() -> std::uint64_t
+    {
+        pool.run(chunks.size(), [this](std::size_t chunk) {
+            for (auto *trace : chunks[chunk].changed) {
+                trace->updatePrevious();
+            }
+        });
+        std::uint64_t values = 0;
+        for (const auto &chunk : chunks) {
+            values += chunk.changed.size();
+            for (const auto &entry : chunk.scope_changes) {
+                CPPTRACER_STATS(scopes[entry.first]->changes += entry.second;)
+                (void)entry;
+            }
+        }
+        for (std::size_t index = 0; index < scopes.size(); ++index) {
+            if ((states[index] & inspected) != 0) {
+                scopes[index]->updateSnapshot();
+            }
+            if ((states[index] & visible) != 0) {
+                scopes[index]->dump_pending = false;
+            }
+        }
+        return values;
+    }
+
+private:
+    /// @brief The output of a chunk of traces.
+    struct Chunk {
+        /// The formatted values.
+        std::string buffer;
+        /// If true, at least one value of the chunk has changed.
+        bool changes{false};
+        /// The traces which have been written.
+        std::vector<Trace *> changed;
+        /// The number of values written by each scope, as (scope index, count).
+        std::vector<std::pair<std::size_t, std::uint64_t>> scope_changes;
+    };
+
+    /// The scope and everything above it are not muted.
+    static constexpr unsigned char visible   = 1U;
+    /// The values of the scope must be written, even if they did not change.
+    static constexpr unsigned char forced    = 2U;
+    /// The traces of the scope must be inspected.
+    static constexpr unsigned char inspected = 4U;
+    /// The guarding snapshot of the scope has changed.
+    static constexpr unsigned char guarded   = 8U;
+
+    /// Marks the traces adopted by their scope, which are not guarded by its snapshot, see Scope::adopted.
+    static constexpr std::size_t adopted_flag = ~(~std::size_t(0) >> 1U);
+
+    /// The pool of threads.
+    ThreadPool pool;
+    /// The scopes, in output order.
+    std::vector<Scope *> scopes;
+    /// The index of the parent of each scope.
+    std::vector<std::size_t> parents;
+    /// The traces in output order, with the index of their scope, marked by adopted_flag for the adopted ones.
+    std::vector<std::pair<Trace *, std::size_t>> traces;
+    /// The state of each scope for the current sample.
+    std::vector<unsigned char> states;
+    /// The number of traces of each chunk.
+    std::size_t chunk_size{1};
+    /// The output of each chunk.
+    std::vector<Chunk> chunks;
+
+    /// @brief Compares and formats a chunk of traces.
+    /// @param index the index of the chunk.
+    void sampleChunk(std::size_t index)
+    {
+        Chunk &chunk = chunks[index];
+        chunk.buffer.clear();
+        chunk.changed.clear();
+        chunk.scope_changes.clear();
+        chunk.changes         = false;
+        const std::size_t end = std::min(traces.size(), (index + 1U) * chunk_size);
+        for (std::size_t position = index * chunk_size; position < end; ++position) {
+            Trace *trace            = traces[position].first;
+            const bool adopted      = (traces[position].second & adopted_flag) != 0;
+            const std::size_t scope = traces[position].second & ~adopted_flag;
+            unsigned char state     = states[scope];
+            if (adopted && ((state & visible) != 0)) {
+                // The adopted traces are always inspected.
+                state |= inspected | guarded;
+            }
+            if ((state & inspected) == 0) {
+                continue;
+            }
+            if ((state & forced) != 0) {
+                // Write the whole trace, checking for changes until one is found.
+                chunk.buffer += trace->getValue();
+                chunk.changes = chunk.changes || (((state & guarded) != 0) && trace->hasChanged());
+            } else if (trace->hasChanged()) {
+                // Write the part of the trace which has changed.
+                chunk.buffer += trace->getChangedValue();
+                chunk.changes = true;
+            } else {
+                continue;
+            }
+            chunk.changed.emplace_back(trace);
+            // Count the values of consecutive traces of the same scope together.
+            if (chunk.scope_changes.empty() || (chunk.scope_changes.back().first != scope)) {
+                chunk.scope_changes.emplace_back(scope, 0U);
+            }
+            ++chunk.scope_changes.back().second;
+        }
+    }
+};
+
+} // namespace detail
+
+} // namespace cpptracer
@@ -0,0 +1,52 @@
+/// @file precompiled.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the instantiations provided by the precompiled library.
+/// @details When CPPTRACER_PRECOMPILED is defined (as done by the
+/// `cpptracer_static` CMake target), the traces of the common types are
+/// declared `extern template`, so the translation units including the tracer
+/// do not instantiate them again, and use the ones compiled inside the library.
+
+#pragma once
+
+#include "tracer.hpp"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/// @brief Expands the given macro for each scalar type compiled inside the precompiled library.
+#define CPPTRACER_PRECOMPILED_SCALARS(X)                                                                               \
+    X(bool)                                                                                                            \
+    X(std::int8_t)                                                                                                     \
+    X(std::int16_t)                                                                                                    \
+    X(std::int32_t)                                                                                                    \
+    X(std::int64_t)                                                                                                    \
+    X(std::uint8_t)                                                                                                    \
+    X(std::uint16_t)                                                                                                   \
+    X(std::uint32_t)                                                                                                   \
+    X(std::uint64_t)                                                                                                   \
+    X(float)                                                                                                           \
+    X(double)                                                                                                          \
+    X(long double)
+
+/// @brief Declares, or defines if PREFIX is empty, the instantiations for a scalar type.
+#define CPPTRACER_INSTANTIATE_SCALAR(PREFIX, T)                                                                        \
+    PREFIX template class TraceWrapper<T>;                                                                             \
+    PREFIX template class ArrayTrace<T>;                                                                               \
+    PREFIX template auto Tracer::addTrace<T>(const T &, std::string_view) -> TraceWrapper<T> *;                        \
+    PREFIX template auto Tracer::addArrayTrace<T>(const T *, std::size_t, std::string_view) -> ArrayTrace<T> *;
+
+/// @brief Declares the instantiations for a scalar type.
+#define CPPTRACER_EXTERN_SCALAR(T) CPPTRACER_INSTANTIATE_SCALAR(extern, T)
+
+namespace cpptracer
+{
+
+#ifdef CPPTRACER_PRECOMPILED
+CPPTRACER_PRECOMPILED_SCALARS(CPPTRACER_EXTERN_SCALAR)
+extern template class TraceWrapper<std::vector<bool>>;
+extern template auto Tracer::addTrace<std::vector<bool>>(const std::vector<bool> &, std::string_view)
+    -> TraceWrapper<std::vector<bool>> *;
+#endif
+
+} // namespace cpptracer
@@ -0,0 +1,122 @@
+/// @file reorder.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the buffer which puts the recorded changes back in time order.
+
+#pragma once
+
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cpptracer
+{
+
+namespace detail
+{
+
+/// @brief Min-heap of value changes, ordered by time and then by arrival.
+/// @details The raw bytes of the values are stored in a separate buffer,
+/// which is compacted when most of it belongs to changes already emitted.
+class ReorderBuffer
+{
+public:
+    /// @brief A change waiting to be emitted.
+    struct Change {
+        /// The scaled time of the change.
+        std::uint64_t time;
+        /// The arrival order of the change, which breaks ties.
+        std::uint64_t sequence;
+        /// The trace which has changed.
+        const Trace *trace;
+        /// The position of the raw bytes of the value.
+        std::size_t offset;
+        /// The number of raw bytes of the value.
+        std::size_t size;
+    };
+
+    /// @brief Adds a change.
+    /// @tparam T the type of the value.
+    /// @param time the scaled time of the change.
+    /// @param trace the trace which has changed.
+    /// @param value the new value.
+    template <typename T>
+    void push(std::uint64_t time, const Trace *trace, const T &value)
+    {
+        heap.push_back(Change{time, sequence++, trace, values.size(), sizeof(T)});
+        std::push_heap(heap.begin(), heap.end(), later);
+        append_raw(values, value);
+        live_bytes += sizeof(T);
+    }
+
+    /// @brief Returns the time of the earliest change, there must be at least one.
+    /// @return the scaled time.
+    auto earliest() const -> std::uint64_t { return heap.front().time; }
+
+    /// @brief Checks if there are no changes.
+    /// @return true if there are no changes.
+    auto empty() const -> bool { return heap.empty(); }
+
+    /// @brief Removes the changes up to the given time, in order.
+    /// @tparam Function the type of the function.
+    /// @param limit the latest time which is removed.
+    /// @param function the function called with the time, the trace, the raw bytes and their number, for each change.
+    template <typename Function>
+    void pop(std::uint64_t limit, Function &&function)
+    {
+        while (!heap.empty() && (heap.front().time <= limit)) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            const Change change = heap.back();
+            heap.pop_back();
+            live_bytes -= change.size;
+            function(change.time, change.trace, values.data() + change.offset, change.size);
+        }
+        this->compact();
+    }
+
+    /// @brief Returns the memory used by the buffer.
+    /// @return the number of bytes.
+    auto getMemoryUsage() const -> std::size_t { return (heap.capacity() * sizeof(Change)) + values.capacity(); }
+
+private:
+    /// The changes, arranged as a min-heap.
+    std::vector<Change> heap;
+    /// The raw bytes of the values.
+    std::string values;
+    /// The number of bytes of the values of the changes inside the heap.
+    std::size_t live_bytes{0};
+    /// The arrival order of the next change.
+    std::uint64_t sequence{0};
+
+    /// @brief Orders the changes so that the heap returns the earliest first.
+    /// @param lhs the first change.
+    /// @param rhs the second change.
+    /// @return true if the first change comes after the second one.
+    static auto later(const Change &lhs, const Change &rhs) -> bool
+    {
+        return (lhs.time != rhs.time) ? (lhs.time > rhs.time) : (lhs.sequence > rhs.sequence);
+    }
+
+    /// @brief Releases the bytes of the emitted values, once they are most of the buffer.
+    void compact()
+    {
+        if (heap.empty()) {
+            values.clear();
+        } else if ((values.size() >= 4096U) && (values.size() > (2U * live_bytes))) {
+            // Move the bytes of the pending values to a new buffer, in heap order.
+            std::string compacted;
+            compacted.reserve(2U * live_bytes);
+            for (auto &change : heap) {
+                compacted.append(values, change.offset, change.size);
+                change.offset = compacted.size() - change.size;
+            }
+            values.swap(compacted);
+        }
+    }
+};
+
+} // namespace detail
+
+} // namespace cpptracer
@@ -6,28 +6,53 @@
 
 #include "trace.hpp"
 
-#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <typeindex>
+#include <utility>
+#include <vector>
 
 namespace cpptracer
 {
 
 /// @brief Hierarchical group of traces.
+/// @details Scopes and traces are stored inside the arena of the tracer, and
+/// refer to each other with plain pointers. Each scope destroys its traces.
 class Scope
 {
 public:
-    /// Name of the scope.
-    std::string name;
+    /// Name of the scope, stored inside the arena of the tracer.
+    std::string_view name;
     /// List of traces inside the scope.
-    std::vector<std::shared_ptr<Trace>> traces;
+    std::vector<Trace *> traces;
     /// List of subscopes.
-    std::vector<std::shared_ptr<Scope>> subscopes;
-    /// Pointer to the parent scope, if null this is the root.
-    std::weak_ptr<Scope> parent;
+    std::vector<Scope *> subscopes;
+    /// List of aliases inside the scope, with their names and the traces whose symbol they share.
+    std::vector<std::pair<std::string_view, const Trace *>> aliases;
+    /// The aliased traces written by the scope, because the scopes owning them are muted.
+    std::vector<Trace *> adopted;
+    /// Pointer to the parent scope, the root is the parent of itself.
+    Scope *parent{nullptr};
+    /// If true, the scope and everything below it is skipped while sampling.
+    bool muted{false};
+    /// If true, every trace below the scope is dumped at the next sample.
+    bool dump_pending{false};
+    /// Pointer to the memory guarding the traces of the scope, if any.
+    const unsigned char *snapshot_source{nullptr};
+    /// Copy of the guarding memory, taken when the traces were last sampled.
+    std::vector<unsigned char> snapshot;
+    /// Number of values written by the traces of the scope, see TracerStats.
+    std::uint64_t changes{0};
+    /// Filter of the floating point traces below the scope, unless overridden.
+    std::optional<ChangeFilter> filter;
 
     /// @brief Construct a new scope with the given name.
     /// @param _name name of the scope.
-    Scope(std::string _name)
-        : name(std::move(_name))
+    Scope(std::string_view _name)
+        : name(_name)
     {
         // Nothing to do.
     }
@@ -35,10 +60,18 @@ public:
     /// @brief Move constructor.
     /// @param other The other entity to move.
     Scope(Scope &&other) noexcept
-        : name(std::move(other.name))
+        : name(other.name)
         , traces(std::move(other.traces))
         , subscopes(std::move(other.subscopes))
-        , parent(std::move(other.parent))
+        , aliases(std::move(other.aliases))
+        , adopted(std::move(other.adopted))
+        , parent(std::exchange(other.parent, nullptr))
+        , muted(other.muted)
+        , dump_pending(other.dump_pending)
+        , snapshot_source(other.snapshot_source)
+        , snapshot(std::move(other.snapshot))
+        , changes(other.changes)
+        , filter(other.filter)
     {
     }
 
@@ -50,11 +83,18 @@ public:
         if (this == &other) {
             return *this;
         }
-        name      = std::move(other.name);
-        traces    = std::move(other.traces);
-        subscopes = std::move(other.subscopes);
-        parent    = other.parent;
-        other.parent.reset();
+        name            = other.name;
+        traces          = std::move(other.traces);
+        subscopes       = std::move(other.subscopes);
+        aliases         = std::move(other.aliases);
+        adopted         = std::move(other.adopted);
+        parent          = std::exchange(other.parent, nullptr);
+        muted           = other.muted;
+        dump_pending    = other.dump_pending;
+        snapshot_source = other.snapshot_source;
+        snapshot        = std::move(other.snapshot);
+        changes         = other.changes;
+        filter          = other.filter;
         return *this;
     }
 
@@ -67,22 +107,137 @@ public:
     /// @return A reference to this object.
     auto operator=(const Scope &other) -> Scope & = delete;
 
-    /// @brief Destructor.
-    ~Scope() = default;
+    /// @brief Destructor, destroys the traces of the scope.
+    /// @details The memory of the traces belongs to the arena of the tracer.
+    ~Scope()
+    {
+        for (auto *trace : traces) {
+            trace->~Trace();
+        }
+    }
+
+    /// @brief Guards the traces of the scope with a snapshot of the given memory.
+    /// @details While the memory does not change, the traces of the scope are
+    /// not inspected at all.
+    /// @param source pointer to the guarding memory.
+    /// @param size the size of the guarding memory.
+    void setSnapshot(const void *source, std::size_t size)
+    {
+        snapshot_source = static_cast<const unsigned char *>(source);
+        // Start from zero, like the previous values of the traces.
+        snapshot.assign(size, 0);
+    }
+
+    /// @brief Checks if the traces of the scope might have changed.
+    /// @return false if the guarding memory is unchanged, true otherwise.
+    auto snapshotChanged() const -> bool
+    {
+        return (snapshot_source == nullptr) ||
+               (std::memcmp(snapshot.data(), snapshot_source, snapshot.size()) != 0);
+    }
+
+    /// @brief Copies the current content of the guarding memory into the snapshot.
+    void updateSnapshot()
+    {
+        if (snapshot_source != nullptr) {
+            std::memcpy(snapshot.data(), snapshot_source, snapshot.size());
+        }
+    }
 
     /// @brief Prints the scope header on the output stream.
+    /// @details The hierarchy is visited with an explicit stack, so that its
+    /// depth is not limited by the call stack.
     /// @param stream the output stream.
-    void printScopeHeader(std::ostringstream &stream) const
+    void printScopeHeader(std::ostream &stream) const
+    {
+        // The open scopes, with the index of the next subscope to print.
+        std::vector<std::pair<const Scope *, std::size_t>> stack;
+        this->printScopeBegin(stream);
+        stack.emplace_back(this, 0U);
+        while (!stack.empty()) {
+            const Scope *scope = stack.back().first;
+            std::size_t index  = stack.back().second++;
+            if (index < scope->subscopes.size()) {
+                scope->subscopes[index]->printScopeBegin(stream);
+                stack.emplace_back(scope->subscopes[index], 0U);
+            } else {
+                stream << "$upscope $end\n";
+                stack.pop_back();
+            }
+        }
+    }
+
+private:
+    /// @brief Prints the beginning of the scope, and its traces.
+    /// @param stream the output stream.
+    void printScopeBegin(std::ostream &stream) const
     {
         stream << "$scope module " << name << " $end\n";
         for (const auto &trace : traces) {
             stream << "    " << trace->getVar();
         }
-        for (const auto &subscope : subscopes) {
-            subscope->printScopeHeader(stream);
+        for (const auto &alias : aliases) {
+            stream << "    " << alias.second->getAliasVar(alias.first);
         }
-        stream << "$upscope $end\n";
     }
 };
 
+namespace detail
+{
+
+/// @brief Identifies a scope by its parent and its name.
+struct ScopeKey {
+    /// The parent of the scope.
+    const Scope *parent;
+    /// The name of the scope.
+    std::string_view name;
+
+    /// @brief Compares two keys.
+    /// @param other the other key.
+    /// @return true if the keys are equal.
+    auto operator==(const ScopeKey &other) const -> bool { return (parent == other.parent) && (name == other.name); }
+};
+
+/// @brief Hash function of the scope keys.
+struct ScopeKeyHash {
+    /// @brief Computes the hash of the key.
+    /// @param key the key.
+    /// @return the hash value.
+    auto operator()(const ScopeKey &key) const -> std::size_t
+    {
+        return std::hash<const Scope *>{}(key.parent) ^ (static_cast<std::size_t>(utility::elf_hash(key.name)) << 1U);
+    }
+};
+
+/// @brief Identifies the variable of a trace by its address, its type, and its width.
+struct TraceKey {
+    /// The address of the variable.
+    const void *address;
+    /// The type of the variable.
+    std::type_index type;
+    /// The number of traced bits, if given when adding the trace, zero otherwise.
+    std::size_t width;
+
+    /// @brief Compares two keys.
+    /// @param other the other key.
+    /// @return true if the keys are equal.
+    auto operator==(const TraceKey &other) const -> bool
+    {
+        return (address == other.address) && (type == other.type) && (width == other.width);
+    }
+};
+
+/// @brief Hash function of the trace keys.
+struct TraceKeyHash {
+    /// @brief Computes the hash of the key.
+    /// @param key the key.
+    /// @return the hash value.
+    auto operator()(const TraceKey &key) const -> std::size_t
+    {
+        return std::hash<const void *>{}(key.address) ^ (std::hash<std::type_index>{}(key.type) << 1U) ^ key.width;
+    }
+};
+
+} // namespace detail
+
 } // namespace cpptracer
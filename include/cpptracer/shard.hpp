@@ -0,0 +1,169 @@
+/// @file shard.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the functions used to merge the shards of a trace, written by several processes.
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <ostream>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cpptracer
+{
+
+/// @brief Number of symbols reserved to each shard, the symbols of the shard
+/// with rank `r` start from `r * shard_symbols`.
+constexpr std::size_t shard_symbols = 1000000000U;
+
+namespace detail
+{
+
+/// @brief Reads a shard one line at a time.
+struct ShardReader {
+    /// The name of the shard.
+    std::string filename;
+    /// The input file.
+    std::ifstream input;
+    /// The last line read.
+    std::string line;
+
+    /// @brief Opens the shard.
+    /// @param _filename the name of the shard.
+    explicit ShardReader(std::string _filename)
+        : filename(std::move(_filename))
+        , input(filename)
+    {
+        if (!input.is_open()) {
+            throw std::runtime_error("Cannot open the shard '" + filename + "'.");
+        }
+    }
+
+    /// @brief Reads the next line.
+    /// @return true if a line has been read, false at the end of the shard.
+    auto next() -> bool { return static_cast<bool>(std::getline(input, line)); }
+
+    /// @brief Checks if the last line is the time of a block of values.
+    /// @return true if it is a time.
+    auto isTime() const -> bool { return !line.empty() && (line[0] == '#'); }
+
+    /// @brief Parses the time of the last line, which must be a time.
+    /// @return the time.
+    auto getTime() const -> std::uint64_t
+    {
+        try {
+            return std::stoull(line.substr(1));
+        } catch (const std::exception &) {
+            throw std::runtime_error("Invalid time '" + line + "' inside the shard '" + filename + "'.");
+        }
+    }
+};
+
+} // namespace detail
+
+/// @brief Merges the shards of a trace into a single trace.
+/// @details The shards are streamed one line at a time: the headers are
+/// concatenated, the initial dumps are joined, and the blocks of values are
+/// merged by time with a k-way merge, so that the memory does not depend on
+/// the size of the shards. The shards must share the timescale, and use
+/// distinct symbols, like the ones written with Tracer::enableSharding.
+/// @param inputs the names of the shards.
+/// @param output the output stream.
+inline void merge_shards(const std::vector<std::string> &inputs, std::ostream &output)
+{
+    std::vector<detail::ShardReader> shards;
+    shards.reserve(inputs.size());
+    for (const auto &input : inputs) {
+        shards.emplace_back(input);
+    }
+    // Copy the header of the first shard, and the scopes of all of them.
+    std::string timescale;
+    for (std::size_t index = 0; index < shards.size(); ++index) {
+        auto &shard = shards[index];
+        std::string section;
+        std::string content;
+        while (shard.next() && (shard.line != "$enddefinitions $end")) {
+            if ((shard.line == "$date") || (shard.line == "$version") || (shard.line == "$timescale")) {
+                section = shard.line;
+                content.clear();
+            } else if (section.empty()) {
+                output << shard.line << "\n";
+            } else if (shard.line != "$end") {
+                content += shard.line + "\n";
+            } else {
+                if ((section == "$timescale") && (index == 0)) {
+                    timescale = content;
+                } else if ((section == "$timescale") && (content != timescale)) {
+                    throw std::runtime_error("The shard '" + shard.filename + "' has a different timescale.");
+                }
+                if (index == 0) {
+                    output << section << "\n" << content << "$end\n";
+                }
+                section.clear();
+            }
+        }
+        if (shard.line != "$enddefinitions $end") {
+            throw std::runtime_error("The shard '" + shard.filename + "' has no definitions.");
+        }
+    }
+    output << "$enddefinitions $end\n";
+    // Join the initial dumps.
+    bool dumped = false;
+    for (auto &shard : shards) {
+        if (!shard.next()) {
+            continue;
+        }
+        if (shard.line == "$dumpvars") {
+            output << (dumped ? "" : "$dumpvars\n");
+            dumped = true;
+            while (shard.next() && (shard.line != "$end")) {
+                output << shard.line << "\n";
+            }
+            shard.line.clear();
+            shard.next();
+        }
+    }
+    if (dumped) {
+        output << "$end\n";
+    }
+    // Merge the blocks of values by time, the ones without time come first.
+    using Block = std::pair<std::uint64_t, std::size_t>;
+    std::priority_queue<Block, std::vector<Block>, std::greater<Block>> blocks;
+    for (std::size_t index = 0; index < shards.size(); ++index) {
+        auto &shard = shards[index];
+        if (!shard.line.empty() || shard.next()) {
+            blocks.emplace(shard.isTime() ? shard.getTime() : 0U, index);
+        }
+    }
+    bool timed              = false;
+    std::uint64_t last_time = 0;
+    while (!blocks.empty()) {
+        const Block block = blocks.top();
+        blocks.pop();
+        auto &shard = shards[block.second];
+        if (shard.isTime()) {
+            if (!timed || (block.first != last_time)) {
+                output << shard.line << "\n";
+            }
+            timed     = true;
+            last_time = block.first;
+        } else {
+            output << shard.line << "\n";
+        }
+        // Copy the block, until the next time.
+        while (shard.next()) {
+            if (shard.isTime()) {
+                blocks.emplace(shard.getTime(), block.second);
+                break;
+            }
+            output << shard.line << "\n";
+        }
+    }
+}
+
+} // namespace cpptracer
@@ -0,0 +1,117 @@
+/// @file simd.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Vectorized kernels used to compare blocks of memory.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace cpptracer
+{
+
+namespace simd
+{
+
+/// Number of bytes compared at once by mismatch_mask.
+constexpr std::size_t block_size = 32U;
+
+/// @brief Compares two blocks of block_size bytes.
+/// @param a the first block.
+/// @param b the second block.
+/// @return a mask where the i-th bit is set if the i-th bytes differ.
+inline auto mismatch_mask(const unsigned char *a, const unsigned char *b) -> std::uint32_t
+{
+#if defined(__AVX2__)
+    const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
+    const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b));
+    return ~static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+#elif defined(__SSE2__) || defined(_M_X64)
+    const __m128i va_lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+    const __m128i vb_lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+    const __m128i va_hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + 16));
+    const __m128i vb_hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + 16));
+    const auto lo       = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va_lo, vb_lo)));
+    const auto hi       = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va_hi, vb_hi)));
+    return ~(lo | (hi << 16U));
+#else
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    // Skip the byte-wise comparison when the blocks are equal, which is the common case.
+    const uint8x16_t diff_lo = veorq_u8(vld1q_u8(a), vld1q_u8(b));
+    const uint8x16_t diff_hi = veorq_u8(vld1q_u8(a + 16), vld1q_u8(b + 16));
+    if (vmaxvq_u8(vorrq_u8(diff_lo, diff_hi)) == 0) {
+        return 0;
+    }
+#endif
+    std::uint32_t mask = 0;
+    for (std::size_t i = 0; i < block_size; ++i) {
+        mask |= static_cast<std::uint32_t>(a[i] != b[i]) << i;
+    }
+    return mask;
+#endif
+}
+
+/// @brief Returns the index of the least significant bit set in the mask.
+/// @param mask the input mask, must not be zero.
+/// @return the index of the bit.
+inline auto lowest_bit(std::uint32_t mask) -> std::size_t
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<std::size_t>(__builtin_ctz(mask));
+#else
+    std::size_t index = 0;
+    while ((mask & 1U) == 0) {
+        mask >>= 1U;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+/// @brief Calls the function for each element which differs between the two arrays.
+/// @details The arrays are compared bitwise, block_size bytes at a time.
+/// Elements are visited in increasing order.
+/// @tparam Bytes the size of the elements, in bytes.
+/// @tparam Function the type of the function.
+/// @param previous the first array.
+/// @param current the second array.
+/// @param size the number of elements.
+/// @param function the function, receiving the index of the element.
+template <std::size_t Bytes, typename Function>
+inline void for_each_mismatch(const void *previous, const void *current, std::size_t size, Function &&function)
+{
+    static_assert((block_size % Bytes) == 0, "Elements must not straddle blocks.");
+    const auto *a           = static_cast<const unsigned char *>(previous);
+    const auto *b           = static_cast<const unsigned char *>(current);
+    const std::size_t bytes = size * Bytes;
+    std::size_t offset      = 0;
+    for (; (offset + block_size) <= bytes; offset += block_size) {
+        std::uint32_t mask = mismatch_mask(a + offset, b + offset);
+        while (mask != 0) {
+            const std::size_t byte = lowest_bit(mask);
+            function((offset + byte) / Bytes);
+            // Skip the remaining bytes of the same element.
+            const std::size_t next = ((byte / Bytes) + 1U) * Bytes;
+            mask &= (next >= block_size) ? 0U : (~std::uint32_t(0) << next);
+        }
+    }
+    // Compare the remaining elements one by one.
+    for (std::size_t index = offset / Bytes; index < size; ++index) {
+        if (std::memcmp(a + (index * Bytes), b + (index * Bytes), Bytes) != 0) {
+            function(index);
+        }
+    }
+}
+
+} // namespace simd
+
+} // namespace cpptracer
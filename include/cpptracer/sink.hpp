@@ -0,0 +1,649 @@
+/// @file sink.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the sinks which receive the trace, and the buffer handed to them.
+
+#pragma once
+
+#include "compression.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+/// @brief Defined on the platforms providing the POSIX file and signal calls.
+#define CPPTRACER_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace cpptracer
+{
+
+#ifdef CPPTRACER_POSIX
+
+namespace detail
+{
+
+/// @brief Writes the given bytes to a file descriptor, using only async-signal-safe calls.
+/// @param fd the file descriptor.
+/// @param data the bytes.
+/// @param size the number of bytes.
+/// @return true on success, false otherwise.
+inline auto write_fd(int fd, const char *data, std::size_t size) noexcept -> bool
+{
+    for (std::size_t done = 0; done < size;) {
+        const ssize_t count = ::write(fd, data + done, size - done);
+        if ((count < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        done += static_cast<std::size_t>(count);
+    }
+    return true;
+}
+
+} // namespace detail
+
+#endif
+
+/// @brief Receives the trace, one buffer at a time.
+/// @details The tracer formats the trace inside a buffer, and hands it over
+/// to the sink when it is written (see Tracer::flushTrace), without copying
+/// it. The sink can take the content by swapping the buffer with its own
+/// storage; whatever is left inside the buffer is discarded, and its storage
+/// is reused by the tracer.
+class TraceSink
+{
+public:
+    /// @brief Constructor.
+    TraceSink() = default;
+
+    /// @brief Copy constructor.
+    /// @param other The other entity to copy.
+    TraceSink(const TraceSink &other) = delete;
+
+    /// @brief Move constructor.
+    /// @param other The other entity to move.
+    TraceSink(TraceSink &&other) = delete;
+
+    /// @brief Copy assignment operator.
+    /// @param other The other entity to copy.
+    /// @return A reference to this object.
+    auto operator=(const TraceSink &other) -> TraceSink & = delete;
+
+    /// @brief Move assignment operator.
+    /// @param other The other entity to move.
+    /// @return A reference to this object.
+    auto operator=(TraceSink &&other) -> TraceSink & = delete;
+
+    /// @brief Destructor.
+    virtual ~TraceSink() = default;
+
+    /// @brief Receives the next part of the trace.
+    /// @param buffer the buffer, which can be taken by swapping it.
+    /// @return true on success, false otherwise.
+    virtual auto write(std::string &buffer) -> bool = 0;
+
+    /// @brief Called once the trace is complete.
+    /// @return true on success, false otherwise.
+    virtual auto close() -> bool { return true; }
+
+    /// @brief Forces the part of the trace written so far to the storage device, see Tracer::setDurability.
+    /// @return true on success, false otherwise.
+    virtual auto sync() -> bool { return true; }
+
+    /// @brief Writes the last part of the trace from the handler of a fatal signal, see Tracer::enableCrashFlush.
+    /// @details Only async-signal-safe calls can be used, so nothing can be
+    /// allocated. Sinks which cannot do it keep the default, which writes nothing.
+    /// @param data the bytes.
+    /// @param size the number of bytes.
+    /// @return true on success, false otherwise.
+    virtual auto emergencyWrite(const char *data, std::size_t size) noexcept -> bool
+    {
+        (void)data;
+        (void)size;
+        return false;
+    }
+};
+
+/// @brief Writes the trace to a file.
+/// @details The first write truncates the file, the following ones append to
+/// it. The file is closed after each write, so the written part of the trace
+/// can be read while tracing.
+class FileSink : public TraceSink
+{
+public:
+    /// @brief Constructor.
+    /// @param _filename the name of the file.
+    /// @param _size the number of bytes of the file which are kept, the file
+    /// is cut after them and the writes are appended, used to resume a trace.
+    explicit FileSink(std::string _filename, std::uint64_t _size = 0)
+        : filename(std::move(_filename))
+        , written(_size > 0)
+        , size(_size)
+    {
+        if (_size > 0) {
+            std::error_code error;
+            if (std::filesystem::file_size(filename, error) < _size) {
+                throw std::runtime_error("The trace file '" + filename + "' is shorter than the part to keep.");
+            }
+            std::filesystem::resize_file(filename, _size, error);
+            if (error) {
+                throw std::runtime_error("Cannot cut the trace file '" + filename + "': " + error.message());
+            }
+        }
+    }
+
+    auto write(std::string &buffer) -> bool override
+    {
+        std::ofstream outfile(filename, std::ios_base::binary | (written ? std::ios_base::app : std::ios_base::trunc));
+        if (!outfile.is_open()) {
+            std::cerr << "Failed to open the trace file'" << filename << "'\n";
+            return false;
+        }
+        outfile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        written = true;
+        size += buffer.size();
+        return static_cast<bool>(outfile);
+    }
+
+    auto sync() -> bool override
+    {
+#ifdef CPPTRACER_POSIX
+        if (!written) {
+            return true;
+        }
+        // Any descriptor of the file can sync the data written through the stream.
+        const int fd = ::open(filename.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        const bool success = (::fsync(fd) == 0);
+        return (::close(fd) == 0) && success;
+#else
+        return true;
+#endif
+    }
+
+    auto emergencyWrite(const char *data, std::size_t length) noexcept -> bool override
+    {
+#ifdef CPPTRACER_POSIX
+        const int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (written ? O_APPEND : O_TRUNC), 0644);
+        if (fd < 0) {
+            return false;
+        }
+        written            = true;
+        const bool success = detail::write_fd(fd, data, length);
+        return (::close(fd) == 0) && success;
+#else
+        (void)data;
+        (void)length;
+        return false;
+#endif
+    }
+
+    /// @brief Provides the name of the file.
+    /// @return the name of the file.
+    auto getFilename() const -> const std::string & { return filename; }
+
+    /// @brief Provides the size of the file.
+    /// @return the number of bytes.
+    auto getSize() const -> std::uint64_t { return size; }
+
+private:
+    /// The name of the file.
+    std::string filename;
+    /// If true, part of the trace has already been written.
+    bool written;
+    /// The number of bytes of the file.
+    std::uint64_t size;
+};
+
+/// @brief Keeps the trace in memory, e.g., to check it inside the tests.
+class MemorySink : public TraceSink
+{
+public:
+    auto write(std::string &buffer) -> bool override
+    {
+        if (content.empty()) {
+            // Take the first buffer as it is.
+            content.swap(buffer);
+        } else {
+            content += buffer;
+        }
+        return true;
+    }
+
+    /// @brief Provides the trace written so far.
+    /// @return the trace.
+    auto getContent() const -> const std::string & { return content; }
+
+    /// @brief Takes the trace written so far, leaving the sink empty.
+    /// @return the trace.
+    auto takeContent() -> std::string
+    {
+        std::string result;
+        result.swap(content);
+        return result;
+    }
+
+private:
+    /// The trace written so far.
+    std::string content;
+};
+
+/// @brief Writes the trace to an output stream, e.g., `std::cout` to pipe it into another program.
+class StreamSink : public TraceSink
+{
+public:
+    /// @brief Constructor.
+    /// @param _stream the stream, which must outlive the sink.
+    explicit StreamSink(std::ostream &_stream)
+        : stream(_stream)
+    {
+        // Nothing to do.
+    }
+
+    auto write(std::string &buffer) -> bool override
+    {
+        stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        stream.flush();
+        return static_cast<bool>(stream);
+    }
+
+private:
+    /// The output stream.
+    std::ostream &stream;
+};
+
+#ifdef ENABLE_COMPRESSION
+
+/// @brief Compresses each buffer into a gzip member, and forwards it to another sink.
+/// @details The concatenation of the members is still a valid gzip file.
+class CompressingSink : public TraceSink
+{
+public:
+    /// @brief Constructor.
+    /// @param _next the sink which receives the compressed buffers.
+    /// @param _level the compression level.
+    explicit CompressingSink(std::unique_ptr<TraceSink> _next, int _level = Z_BEST_COMPRESSION)
+        : next(std::move(_next))
+        , level(_level)
+    {
+        // Nothing to do.
+    }
+
+    auto write(std::string &buffer) -> bool override
+    {
+        const auto start = std::chrono::steady_clock::now();
+        compressed       = compression::compress(buffer, level);
+        elapsed += std::chrono::steady_clock::now() - start;
+        input_bytes += buffer.size();
+        output_bytes += compressed.size();
+        return next->write(compressed);
+    }
+
+    auto close() -> bool override { return next->close(); }
+
+    auto sync() -> bool override { return next->sync(); }
+
+    /// @details Compressing would allocate, so the data is forwarded inside a
+    /// gzip member made of stored deflate blocks, which is still readable
+    /// after the members written so far.
+    auto emergencyWrite(const char *data, std::size_t size) noexcept -> bool override
+    {
+        // The header: magic, deflate, no flags, no time, no extra flags, unknown system.
+        const unsigned char header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 255};
+        bool success = next->emergencyWrite(reinterpret_cast<const char *>(header), sizeof(header));
+        // The stored blocks, the last one is marked as final.
+        std::size_t done = 0;
+        do {
+            const std::size_t length    = std::min<std::size_t>(size - done, 65535U);
+            const bool last             = (done + length == size);
+            const unsigned char block[5] = {
+                static_cast<unsigned char>(last ? 1U : 0U),
+                static_cast<unsigned char>(length & 0xFFU),
+                static_cast<unsigned char>(length >> 8U),
+                static_cast<unsigned char>(~length & 0xFFU),
+                static_cast<unsigned char>((~length >> 8U) & 0xFFU),
+            };
+            success = success && next->emergencyWrite(reinterpret_cast<const char *>(block), sizeof(block));
+            success = success && ((length == 0) || next->emergencyWrite(data + done, length));
+            done += length;
+        } while (done < size);
+        // The trailer: the checksum and the size of the data.
+        uLong checksum = ::crc32(0L, Z_NULL, 0);
+        for (std::size_t offset = 0; offset < size; offset += 65535U) {
+            const auto length = static_cast<uInt>(std::min<std::size_t>(size - offset, 65535U));
+            checksum          = ::crc32(checksum, reinterpret_cast<const Bytef *>(data + offset), length);
+        }
+        unsigned char trailer[8];
+        for (unsigned index = 0; index < 4; ++index) {
+            trailer[index]     = static_cast<unsigned char>((checksum >> (8U * index)) & 0xFFU);
+            trailer[index + 4] = static_cast<unsigned char>((size >> (8U * index)) & 0xFFU);
+        }
+        return success && next->emergencyWrite(reinterpret_cast<const char *>(trailer), sizeof(trailer));
+    }
+
+    /// @brief Provides the number of bytes received.
+    /// @return the number of bytes.
+    auto getInputBytes() const -> std::uint64_t { return input_bytes; }
+
+    /// @brief Provides the number of compressed bytes forwarded.
+    /// @return the number of bytes.
+    auto getOutputBytes() const -> std::uint64_t { return output_bytes; }
+
+    /// @brief Provides the time spent compressing.
+    /// @return the time.
+    auto getCompressionTime() const -> std::chrono::nanoseconds { return elapsed; }
+
+private:
+    /// The sink which receives the compressed buffers.
+    std::unique_ptr<TraceSink> next;
+    /// The compression level.
+    int level;
+    /// The last compressed buffer.
+    std::string compressed;
+    /// The number of bytes received.
+    std::uint64_t input_bytes{0};
+    /// The number of compressed bytes forwarded.
+    std::uint64_t output_bytes{0};
+    /// The time spent compressing.
+    std::chrono::nanoseconds elapsed{};
+};
+
+#endif
+
+namespace detail
+{
+
+/// @brief The part of an output buffer which ends with a complete sample, written by the handler of the fatal signals.
+/// @details The handler can run on any thread, so the buffer clears the
+/// committed part before moving or releasing its characters, and waits for a
+/// handler which is already writing them.
+class CommittedTail
+{
+public:
+    /// @brief Sets the committed part.
+    /// @param _data the first character.
+    /// @param _size the number of characters.
+    void commit(const char *_data, std::size_t _size) noexcept
+    {
+        this->clear();
+        data.store(_data, std::memory_order_relaxed);
+        size.store(_size, std::memory_order_release);
+    }
+
+    /// @brief Clears the committed part, so that its characters can be moved or released.
+    /// @return the number of characters which were committed.
+    auto clear() noexcept -> std::size_t
+    {
+        const std::size_t committed = size.exchange(0, std::memory_order_seq_cst);
+        // A handler which has already read the size is still writing the characters.
+        while (flushing.load(std::memory_order_seq_cst)) {
+            // Wait for the handler.
+        }
+        return committed;
+    }
+
+    /// @brief Hands the committed part to the given function, and clears it, called by the handler.
+    /// @param function the function, receiving the first character and the number of characters.
+    template <typename Function>
+    void flush(Function &&function) noexcept
+    {
+        flushing.store(true, std::memory_order_seq_cst);
+        const std::size_t length = size.exchange(0, std::memory_order_seq_cst);
+        const char *bytes        = data.load(std::memory_order_acquire);
+        if ((length > 0) && (bytes != nullptr)) {
+            function(bytes, length);
+        }
+        flushing.store(false, std::memory_order_release);
+    }
+
+private:
+    /// The first character of the committed part.
+    std::atomic<const char *> data{nullptr};
+    /// The number of committed characters, zero while they are being replaced.
+    std::atomic<std::size_t> size{0};
+    /// True while the handler writes the committed characters.
+    std::atomic<bool> flushing{false};
+};
+
+/// @brief Stream buffer which writes inside a string, which can be handed over without copying it.
+class StringStreamBuffer : public std::streambuf
+{
+public:
+    /// @brief Constructor.
+    StringStreamBuffer() = default;
+
+    /// @brief Copy constructor.
+    /// @param other The other entity to copy.
+    StringStreamBuffer(const StringStreamBuffer &other) = delete;
+
+    /// @brief Move constructor.
+    /// @param other The other entity to move.
+    StringStreamBuffer(StringStreamBuffer &&other) noexcept
+        : std::streambuf()
+    {
+        *this = std::move(other);
+    }
+
+    /// @brief Copy assignment operator.
+    /// @param other The other entity to copy.
+    /// @return A reference to this object.
+    auto operator=(const StringStreamBuffer &other) -> StringStreamBuffer & = delete;
+
+    /// @brief Move assignment operator.
+    /// @param other The other entity to move.
+    /// @return A reference to this object.
+    auto operator=(StringStreamBuffer &&other) noexcept -> StringStreamBuffer &
+    {
+        // The put area is rebuilt, since moving the storage can move the characters.
+        const std::size_t used      = other.size();
+        const std::size_t committed = other.tail ? other.tail->clear() : 0U;
+        storage                     = std::move(other.storage);
+        tail                        = std::exchange(other.tail, nullptr);
+        other.storage.clear();
+        other.reset(0);
+        this->reset(used);
+        this->commit(committed);
+        return *this;
+    }
+
+    /// @brief Destructor.
+    ~StringStreamBuffer() override = default;
+
+    /// @brief Provides the number of characters written.
+    /// @return the number of characters.
+    auto size() const -> std::size_t { return static_cast<std::size_t>(this->pptr() - this->pbase()); }
+
+    /// @brief Provides the characters written.
+    /// @return the position of the first character.
+    auto data() const -> const char * { return this->pbase(); }
+
+    /// @brief Swaps the written characters with the content of the given string, and empties the buffer.
+    /// @details The storage of the given string is kept, and reused by the following writes.
+    /// @param buffer the string which receives the characters.
+    void take(std::string &buffer)
+    {
+        // The characters leave the buffer, and are written by the sink.
+        if (tail) {
+            tail->clear();
+        }
+        storage.resize(this->size());
+        storage.swap(buffer);
+        storage.clear();
+        this->reset(0);
+    }
+
+    /// @brief Sets the committed part which follows the characters of the buffer.
+    /// @param _tail the committed part, null to stop following it.
+    void setTail(CommittedTail *_tail) { tail = _tail; }
+
+    /// @brief Commits the first characters of the buffer, so that they are written by the handler of the fatal signals.
+    /// @param count the number of characters.
+    void commit(std::size_t count) noexcept
+    {
+        if (tail) {
+            tail->commit(this->data(), count);
+        }
+    }
+
+protected:
+    auto overflow(int_type character) -> int_type override
+    {
+        if (traits_type::eq_int_type(character, traits_type::eof())) {
+            return traits_type::not_eof(character);
+        }
+        this->grow(1);
+        *this->pptr() = traits_type::to_char_type(character);
+        this->advance(1);
+        return character;
+    }
+
+    auto xsputn(const char_type *data, std::streamsize count) -> std::streamsize override
+    {
+        const auto length = static_cast<std::size_t>(count);
+        if (static_cast<std::size_t>(this->epptr() - this->pptr()) < length) {
+            this->grow(length);
+        }
+        std::memcpy(this->pptr(), data, length);
+        this->advance(length);
+        return count;
+    }
+
+    auto seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which)
+        -> pos_type override
+    {
+        // Only the position of the end can be queried, which is what tellp does.
+        if ((offset == 0) && (direction == std::ios_base::cur) && ((which & std::ios_base::out) != 0)) {
+            return pos_type(static_cast<off_type>(this->size()));
+        }
+        return pos_type(off_type(-1));
+    }
+
+private:
+    /// The characters, followed by the free space of the put area.
+    std::string storage;
+    /// The committed part, which follows the characters when they are moved.
+    CommittedTail *tail{nullptr};
+
+    /// @brief Makes room for the given number of characters.
+    /// @param count the number of characters.
+    void grow(std::size_t count)
+    {
+        // The storage can be reallocated, so the committed part is cleared meanwhile.
+        const std::size_t committed = tail ? tail->clear() : 0U;
+        const std::size_t used      = this->size();
+        storage.resize(std::max(used + count, std::max<std::size_t>(4096U, 2U * storage.size())));
+        this->reset(used);
+        this->commit(committed);
+    }
+
+    /// @brief Sets the put area over the whole storage.
+    /// @param used the number of characters already written.
+    void reset(std::size_t used)
+    {
+        storage.resize(std::max(storage.size(), storage.capacity()));
+        this->setp(&storage[0], &storage[0] + storage.size());
+        this->advance(used);
+    }
+
+    /// @brief Moves the put position forward, pbump takes only an int.
+    /// @param count the number of characters.
+    void advance(std::size_t count)
+    {
+        for (; count > INT_MAX; count -= INT_MAX) {
+            this->pbump(INT_MAX);
+        }
+        this->pbump(static_cast<int>(count));
+    }
+};
+
+/// @brief Output stream writing inside a string, which is handed over to the sinks without copying it.
+class OutputBuffer : public std::ostream
+{
+public:
+    /// @brief Constructor.
+    OutputBuffer()
+        : std::ostream(nullptr)
+    {
+        this->rdbuf(&buffer);
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The other entity to copy.
+    OutputBuffer(const OutputBuffer &other) = delete;
+
+    /// @brief Move constructor.
+    /// @param other The other entity to move.
+    OutputBuffer(OutputBuffer &&other) noexcept
+        : std::ostream(std::move(other))
+        , buffer(std::move(other.buffer))
+    {
+        this->set_rdbuf(&buffer);
+    }
+
+    /// @brief Copy assignment operator.
+    /// @param other The other entity to copy.
+    /// @return A reference to this object.
+    auto operator=(const OutputBuffer &other) -> OutputBuffer & = delete;
+
+    /// @brief Move assignment operator.
+    /// @param other The other entity to move.
+    /// @return A reference to this object.
+    auto operator=(OutputBuffer &&other) noexcept -> OutputBuffer &
+    {
+        std::ostream::operator=(std::move(other));
+        buffer = std::move(other.buffer);
+        this->set_rdbuf(&buffer);
+        return *this;
+    }
+
+    /// @brief Destructor.
+    ~OutputBuffer() override = default;
+
+    /// @brief Provides the number of characters written.
+    /// @return the number of characters.
+    auto size() const -> std::size_t { return buffer.size(); }
+
+    /// @brief Provides the characters written, valid until the next write.
+    /// @return the position of the first character.
+    auto data() const -> const char * { return buffer.data(); }
+
+    /// @brief Swaps the written characters with the content of the given string, and empties the buffer.
+    /// @param other the string which receives the characters, its storage is reused.
+    void take(std::string &other) { buffer.take(other); }
+
+    /// @brief Sets the committed part which follows the characters of the buffer.
+    /// @param tail the committed part, null to stop following it.
+    void setTail(CommittedTail *tail) { buffer.setTail(tail); }
+
+    /// @brief Commits the first characters of the buffer, so that they are written by the handler of the fatal signals.
+    /// @param count the number of characters.
+    void commit(std::size_t count) noexcept { buffer.commit(count); }
+
+private:
+    /// The buffer holding the characters.
+    StringStreamBuffer buffer;
+};
+
+} // namespace detail
+
+} // namespace cpptracer
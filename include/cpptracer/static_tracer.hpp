@@ -0,0 +1,290 @@
+/// @file static_tracer.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains a tracer whose list of signals is fixed at compile time.
+
+#pragma once
+
+#include "format.hpp"
+#include "tracer.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cpptracer
+{
+
+/// @brief A variable traced by the StaticTracer.
+/// @tparam T the type of the traced variable.
+template <typename T>
+struct StaticSignal {
+    /// A pointer to the variable that has to be traced.
+    const T *ptr;
+    /// The name of the trace.
+    const char *name;
+
+    /// @brief Constructor.
+    /// @param variable the variable which has to be traced.
+    /// @param _name the name of the trace.
+    StaticSignal(const T &variable, const char *_name)
+        : ptr(&variable)
+        , name(_name)
+    {
+        // Nothing to do.
+    }
+};
+
+/// @brief C++ variable tracer, for a list of variables known at compile time.
+/// @details Change detection and formatting are unrolled over the list of
+/// signals, without virtual calls and without heap allocations besides the
+/// growth of the output buffer. The produced trace is identical to the one
+/// produced by a Tracer with the same variables added to the root scope.
+/// There are no scope filters, see Tracer::setScopeFilter: the floating
+/// point signals change when they differ beyond the tolerance of is_equal.
+/// @tparam Signals the types of the traced variables.
+template <typename... Signals>
+class StaticTracer
+{
+public:
+    /// The number of traced variables.
+    static constexpr std::size_t size = sizeof...(Signals);
+
+    /// @brief Constructor.
+    /// @param _filename The name of the file.
+    /// @param _timescale The timescale to use.
+    /// @param _root the name of the root scope.
+    /// @param signals the variables which have to be traced.
+    StaticTracer(std::string _filename, TimeScale const &_timescale, std::string _root, StaticSignal<Signals>... signals)
+        : filename(std::move(_filename))
+        , root(std::move(_root))
+        , names{signals.name...}
+        , pointers(signals.ptr...)
+        , previous()
+        , timescale(_timescale)
+        , sampling(_timescale)
+    {
+        precisions.fill(32);
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The other entity to copy.
+    StaticTracer(const StaticTracer &other) = delete;
+
+    /// @brief Move constructor.
+    /// @param other The other entity to move.
+    StaticTracer(StaticTracer &&other) noexcept = default;
+
+    /// @brief Copy assignment operator.
+    /// @param other The other entity to copy.
+    /// @return A reference to this object.
+    auto operator=(const StaticTracer &other) -> StaticTracer & = delete;
+
+    /// @brief Move assignment operator.
+    /// @param other The other entity to move.
+    /// @return A reference to this object.
+    auto operator=(StaticTracer &&other) noexcept -> StaticTracer & = default;
+
+    /// @brief Destructor.
+    ~StaticTracer()
+    {
+        // Close the output file.
+        this->closeTrace();
+    }
+
+    /// @brief Sets the sampling period.
+    /// @param _sampling the sampling period.
+    void setSampling(TimeScale const &_sampling) { sampling = _sampling; }
+
+    /// @brief Sets the version text to display in $version section
+    /// @param _version_text the version text.
+    void setVersionText(std::string _version_text) { version_text = std::move(_version_text); }
+
+    /// @brief Changes the output precision of a floating point variable.
+    /// @param index the position of the variable inside the list of signals.
+    /// @param _precision the desired output precision.
+    void setPrecision(std::size_t index, int _precision) { precisions.at(index) = _precision; }
+
+    /// @brief Reserves space inside the output buffer, to avoid its growth while sampling.
+    /// @param bytes the number of bytes to reserve.
+    void reserve(std::size_t bytes) { outbuffer.reserve(bytes); }
+
+    /// @brief Returns the time for the next sample.
+    /// @return the time for the next sample.
+    auto nextSampleTime() const -> double { return next_sample; }
+
+    /// @brief Creates the trace.
+    void createTrace()
+    {
+        // Write the header.
+        outbuffer += "$date\n";
+        outbuffer += "    " + utility::get_date_time() + "\n";
+        outbuffer += "$end\n";
+        outbuffer += "$version\n";
+        if (version_text.empty()) {
+            outbuffer += "    Tracer ";
+            outbuffer += std::to_string(static_cast<int>(CPPTRACER_MAJOR_VERSION)) + ".";
+            outbuffer += std::to_string(static_cast<int>(CPPTRACER_MINOR_VERSION)) + ".";
+            outbuffer += std::to_string(static_cast<int>(CPPTRACER_MICRO_VERSION));
+            outbuffer += " - By Enrico Fraccaroli (Galfurian) <enry.frak@gmail.com>\n";
+        } else {
+            outbuffer += version_text;
+        }
+        outbuffer += "$end\n";
+        outbuffer += "$timescale\n";
+        outbuffer += "    " + std::to_string(timescale.getTimeNumber()) + timescale.getTimeUnit().toString() + "\n";
+        outbuffer += "$end\n";
+        outbuffer += "$scope module " + root + " $end\n";
+        this->appendVars(std::index_sequence_for<Signals...>{});
+        outbuffer += "$upscope $end\n";
+        outbuffer += "$enddefinitions $end\n";
+    }
+
+    /// @brief Updates the trace file with the current variable values.
+    /// @param t The time at which the traces have been updated.
+    void updateTrace(const double &t)
+    {
+        // Write time.
+        if ((!this->changed()) || (next_sample > t)) {
+            return;
+        }
+        // Dump variables.
+        if (first_dump) {
+            outbuffer += "$dumpvars\n";
+        } else {
+            outbuffer += '#';
+            outbuffer += std::to_string(static_cast<unsigned long>(
+                std::round(static_cast<long double>(t) / timescale.getTimeUnit().toValue())));
+            outbuffer += '\n';
+        }
+        // Write the values.
+        this->appendValues(std::index_sequence_for<Signals...>{});
+        // Write the closure.
+        if (first_dump) {
+            outbuffer += "$end\n";
+            first_dump = false;
+        }
+        // Set the time of the next sample.
+        next_sample += sampling.getValue();
+    }
+
+    /// @brief Checks if some value has changed.
+    /// @return true if at least one value has changed, false otherwise.
+    auto changed() const -> bool { return this->changedAny(std::index_sequence_for<Signals...>{}); }
+
+    /// @brief Closes the trace file.
+    /// @return true on success, false otherwise.
+    auto closeTrace() -> bool
+    {
+        if (outbuffer.empty()) {
+            return true;
+        }
+        std::ofstream outfile(filename, std::ios_base::trunc);
+        if (!outfile.is_open()) {
+            std::cerr << "Failed to open the trace file'" << filename << "'\n";
+            return false;
+        }
+        outfile.write(outbuffer.data(), static_cast<std::streamsize>(outbuffer.size()));
+        outfile.close();
+        outbuffer.clear();
+        return true;
+    }
+
+private:
+    /// Name of the trace file.
+    std::string filename;
+    /// Name of the root scope.
+    std::string root;
+    /// The names of the traces.
+    std::array<const char *, size> names;
+    /// Pointers to the traced variables.
+    std::tuple<const Signals *...> pointers;
+    /// Previous values of the traces.
+    std::tuple<Signals...> previous;
+    /// The floating point precisions.
+    std::array<int, size> precisions{};
+    /// The output buffer.
+    std::string outbuffer;
+    /// The timescale.
+    TimeScale timescale;
+    /// The sampling period.
+    TimeScale sampling;
+    /// Identifies the first dump of the values.
+    bool first_dump{true};
+    /// Next sampling time.
+    double next_sample{};
+    /// Version text to display in $version section
+    std::string version_text;
+
+    /// @brief Appends the $var of all the traces.
+    /// @tparam I the indices of the traces.
+    template <std::size_t... I>
+    void appendVars(std::index_sequence<I...> /*unused*/)
+    {
+        (this->appendVar<I>(), ...);
+    }
+
+    /// @brief Appends the $var of the I-th trace.
+    /// @tparam I the index of the trace.
+    template <std::size_t I>
+    void appendVar()
+    {
+        using value_type = std::tuple_element_t<I, std::tuple<Signals...>>;
+        outbuffer += "    ";
+        outbuffer += detail::signal_info<value_type>::var;
+        if constexpr (utility::is_std_array<value_type>::value) {
+            outbuffer += std::to_string(std::tuple_size<value_type>::value) + " ";
+        }
+        outbuffer += std::to_string(I) + " " + names[I] + " $end\n";
+    }
+
+    /// @brief Checks if at least one trace has changed.
+    /// @tparam I the indices of the traces.
+    /// @return true if at least one trace has changed.
+    template <std::size_t... I>
+    auto changedAny(std::index_sequence<I...> /*unused*/) const -> bool
+    {
+        return (this->hasChanged<I>() || ...);
+    }
+
+    /// @brief Checks if the I-th trace has changed.
+    /// @tparam I the index of the trace.
+    /// @return true if the trace has changed.
+    template <std::size_t I>
+    auto hasChanged() const -> bool
+    {
+        using value_type    = std::tuple_element_t<I, std::tuple<Signals...>>;
+        const auto &current = *std::get<I>(pointers);
+        if constexpr (std::is_floating_point<value_type>::value) {
+            return !is_equal(std::get<I>(previous), current, detail::signal_info<value_type>::tolerance);
+        } else {
+            return std::get<I>(previous) != current;
+        }
+    }
+
+    /// @brief Appends the values of the traces which have changed.
+    /// @tparam I the indices of the traces.
+    template <std::size_t... I>
+    void appendValues(std::index_sequence<I...> /*unused*/)
+    {
+        ((first_dump || this->hasChanged<I>() ? this->appendValue<I>() : void()), ...);
+    }
+
+    /// @brief Appends the value of the I-th trace, and updates its previous value.
+    /// @tparam I the index of the trace.
+    template <std::size_t I>
+    void appendValue()
+    {
+        const auto &current = *std::get<I>(pointers);
+        detail::append_value(outbuffer, current, precisions[I]);
+        detail::append_symbol(outbuffer, I);
+        std::get<I>(previous) = current;
+    }
+};
+
+} // namespace cpptracer
@@ -0,0 +1,104 @@
+/// @file stats.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the statistics collected by the tracer about itself.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// @brief Expands to its argument only when the statistics are enabled.
+#ifdef ENABLE_STATS
+#define CPPTRACER_STATS(...) __VA_ARGS__
+#else
+#define CPPTRACER_STATS(...)
+#endif
+
+namespace cpptracer
+{
+
+/// @brief Statistics about the work done by a tracer.
+/// @details The counters are collected only when the library is compiled with
+/// ENABLE_STATS, otherwise they are always zero. The times are collected only
+/// when the timers have been enabled on the tracer.
+struct TracerStats {
+    /// Number of samples which have been written.
+    std::uint64_t samples_taken{};
+    /// Number of samples which have been skipped, because nothing changed or
+    /// because they came before the next sampling time.
+    std::uint64_t samples_skipped{};
+    /// Number of samples which have been dropped because of the memory budget.
+    std::uint64_t samples_dropped{};
+    /// Number of recorded changes which have been dropped because of the memory
+    /// budget, see Tracer::recordChange.
+    std::uint64_t changes_dropped{};
+    /// Number of values written, including the initial dump.
+    std::uint64_t values_emitted{};
+    /// Number of bytes produced, before compression.
+    std::uint64_t raw_bytes{};
+    /// Number of bytes produced by the compression.
+    std::uint64_t compressed_bytes{};
+    /// Number of times the written trace has been forced to the storage device.
+    std::uint64_t syncs{};
+    /// Number of bit toggles counted, see Tracer::enableToggleCounting.
+    std::uint64_t toggles{};
+    /// Time spent checking which values have changed.
+    std::chrono::nanoseconds detection_time{};
+    /// Time spent writing the values inside the output buffer.
+    std::chrono::nanoseconds formatting_time{};
+    /// Time spent compressing the trace.
+    std::chrono::nanoseconds compression_time{};
+    /// Time spent writing the trace to file, and syncing it.
+    std::chrono::nanoseconds io_time{};
+    /// Number of values written by each scope, identified by its path.
+    std::vector<std::pair<std::string, std::uint64_t>> scope_changes;
+};
+
+namespace detail
+{
+
+/// @brief Adds the time elapsed during its lifetime to an accumulator.
+class StatsTimer
+{
+public:
+    /// @brief Constructor.
+    /// @param enabled if false, the timer does nothing.
+    /// @param _accumulator where the elapsed time is added.
+    StatsTimer(bool enabled, std::chrono::nanoseconds &_accumulator)
+        : accumulator(enabled ? &_accumulator : nullptr)
+        , start(enabled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+    {
+        // Nothing to do.
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The other entity to copy.
+    StatsTimer(const StatsTimer &other) = delete;
+
+    /// @brief Copy assignment operator.
+    /// @param other The other entity to copy.
+    /// @return A reference to this object.
+    auto operator=(const StatsTimer &other) -> StatsTimer & = delete;
+
+    /// @brief Destructor, adds the elapsed time to the accumulator.
+    ~StatsTimer()
+    {
+        if (accumulator != nullptr) {
+            *accumulator += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start);
+        }
+    }
+
+private:
+    /// Where the elapsed time is added, null if the timer is disabled.
+    std::chrono::nanoseconds *accumulator;
+    /// The moment the timer was started.
+    std::chrono::steady_clock::time_point start;
+};
+
+} // namespace detail
+
+} // namespace cpptracer
@@ -0,0 +1,36 @@
+/// @file struct_member.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the descriptor of a traced struct member.
+
+#pragma once
+
+/// @brief Describes the member of a struct, using the member name as trace name.
+/// @param type the type of the struct.
+/// @param member the name of the member.
+#define CPPTRACER_MEMBER(type, member) cpptracer::StructMember(&type::member, #member)
+
+namespace cpptracer
+{
+
+/// @brief Describes a member of a struct traced with Tracer::addStructTrace.
+/// @tparam S the type of the struct.
+/// @tparam M the type of the member.
+template <typename S, typename M>
+struct StructMember {
+    /// Pointer to the member.
+    M S::*member;
+    /// The name of the trace.
+    const char *name;
+
+    /// @brief Constructor.
+    /// @param _member pointer to the member.
+    /// @param _name the name of the trace.
+    StructMember(M S::*_member, const char *_name)
+        : member(_member)
+        , name(_name)
+    {
+        // Nothing to do.
+    }
+};
+
+} // namespace cpptracer
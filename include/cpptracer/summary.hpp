@@ -0,0 +1,195 @@
+/// @file summary.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the summary statistics of the signals, written next to the trace.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cpptracer
+{
+
+/// @brief The format of the summary written when the trace is closed, see Tracer::enableSummary.
+enum class SummaryFormat {
+    Json, ///< A JSON object, with the list of the signals.
+    Csv   ///< A CSV table, with one row per signal.
+};
+
+/// @brief The summary statistics of a signal.
+/// @details The statistics of signals which are not numeric (e.g., wide
+/// bit-vectors) are NaN, only their changes are counted.
+struct SignalSummary {
+    /// The dot-separated path of the signal, starting from the root.
+    std::string name;
+    /// The symbol of the signal inside the trace.
+    std::string symbol;
+    /// Number of times the value has changed, including the initial one.
+    std::uint64_t changes{};
+    /// Smallest value written.
+    double minimum{std::numeric_limits<double>::quiet_NaN()};
+    /// Largest value written.
+    double maximum{std::numeric_limits<double>::quiet_NaN()};
+    /// Mean of the values, weighted by the time each one has been held.
+    double mean{std::numeric_limits<double>::quiet_NaN()};
+    /// Last value written.
+    double last{std::numeric_limits<double>::quiet_NaN()};
+};
+
+namespace detail
+{
+
+/// @brief Accumulates the statistics of a signal while tracing, in constant space.
+struct SummaryAccumulator {
+    /// Number of times the value has changed.
+    std::uint64_t changes{};
+    /// Smallest value.
+    double minimum{std::numeric_limits<double>::infinity()};
+    /// Largest value.
+    double maximum{-std::numeric_limits<double>::infinity()};
+    /// Last value.
+    double last{std::numeric_limits<double>::quiet_NaN()};
+    /// Sum of the values, each one multiplied by the time it has been held.
+    double weighted{};
+    /// Scaled time of the first value.
+    std::uint64_t first_time{};
+    /// Scaled time of the last value.
+    std::uint64_t last_time{};
+
+    /// @brief Adds a written value, values equal to the last one are not changes.
+    /// @param value the value, NaN if the signal is not numeric.
+    /// @param time the scaled time of the value.
+    void add(double value, std::uint64_t time)
+    {
+        if (changes == 0) {
+            first_time = time;
+        } else if (!std::isnan(value) && (std::memcmp(&value, &last, sizeof(double)) == 0)) {
+            return;
+        } else {
+            weighted += last * static_cast<double>(time - last_time);
+        }
+        ++changes;
+        last      = value;
+        last_time = time;
+        // Comparisons with NaN are false, so the extremes keep ignoring them.
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+    }
+
+    /// @brief Computes the statistics of the signal.
+    /// @param name the path of the signal.
+    /// @param symbol the symbol of the signal.
+    /// @param end the scaled time at which the trace ends.
+    /// @return the statistics.
+    auto summarize(std::string name, std::string symbol, std::uint64_t end) const -> SignalSummary
+    {
+        SignalSummary summary;
+        summary.name    = std::move(name);
+        summary.symbol  = std::move(symbol);
+        summary.changes = changes;
+        if ((changes == 0) || std::isnan(last)) {
+            return summary;
+        }
+        end             = std::max(end, last_time);
+        summary.minimum = minimum;
+        summary.maximum = maximum;
+        summary.last    = last;
+        // The last value is held until the end, a trace ending at its first value has just that.
+        if (end == first_time) {
+            summary.mean = last;
+        } else {
+            summary.mean = (weighted + last * static_cast<double>(end - last_time)) /
+                           static_cast<double>(end - first_time);
+        }
+        return summary;
+    }
+};
+
+/// @brief Writes a number of the summary, or the given text if it is not finite.
+/// @param output the output stream.
+/// @param value the number.
+/// @param missing the text written for NaN and infinities.
+inline void write_summary_number(std::ostream &output, double value, const char *missing)
+{
+    if (std::isfinite(value)) {
+        output << std::setprecision(std::numeric_limits<double>::max_digits10) << value;
+    } else {
+        output << missing;
+    }
+}
+
+/// @brief Writes a string of the summary, quoted and escaped.
+/// @param output the output stream.
+/// @param text the string.
+/// @param escape the character placed before the quotes inside the string, '\\' for JSON, '"' for CSV.
+inline void write_summary_string(std::ostream &output, const std::string &text, char escape)
+{
+    output << '"';
+    for (const char character : text) {
+        if ((character == '"') || ((escape == '\\') && (character == '\\'))) {
+            output << escape;
+        }
+        output << character;
+    }
+    output << '"';
+}
+
+/// @brief Writes the summary of the signals.
+/// @param output the output stream.
+/// @param signals the statistics of the signals.
+/// @param format the format.
+/// @param timescale the timescale of the times, e.g., "1ns".
+/// @param end the scaled time at which the trace ends.
+inline void write_summary(std::ostream &output,
+                          const std::vector<SignalSummary> &signals,
+                          SummaryFormat format,
+                          const std::string &timescale,
+                          std::uint64_t end)
+{
+    if (format == SummaryFormat::Csv) {
+        output << "name,symbol,changes,min,max,mean,last\n";
+        for (const auto &signal : signals) {
+            write_summary_string(output, signal.name, '"');
+            output << ',';
+            write_summary_string(output, signal.symbol, '"');
+            output << ',' << signal.changes;
+            for (const double value : {signal.minimum, signal.maximum, signal.mean, signal.last}) {
+                output << ',';
+                write_summary_number(output, value, "");
+            }
+            output << '\n';
+        }
+        return;
+    }
+    output << "{\n  \"timescale\": ";
+    write_summary_string(output, timescale, '\\');
+    output << ",\n  \"end_time\": " << end << ",\n  \"signals\": [";
+    for (std::size_t index = 0; index < signals.size(); ++index) {
+        const auto &signal = signals[index];
+        output << ((index > 0) ? ",\n    {\"name\": " : "\n    {\"name\": ");
+        write_summary_string(output, signal.name, '\\');
+        output << ", \"symbol\": ";
+        write_summary_string(output, signal.symbol, '\\');
+        output << ", \"changes\": " << signal.changes << ", \"min\": ";
+        write_summary_number(output, signal.minimum, "null");
+        output << ", \"max\": ";
+        write_summary_number(output, signal.maximum, "null");
+        output << ", \"mean\": ";
+        write_summary_number(output, signal.mean, "null");
+        output << ", \"last\": ";
+        write_summary_number(output, signal.last, "null");
+        output << "}";
+    }
+    output << (signals.empty() ? "]\n}\n" : "\n  ]\n}\n");
+}
+
+} // namespace detail
+
+} // namespace cpptracer
@@ -0,0 +1,121 @@
+/// @file toggle.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the toggle counters of the bits of the signals, and the activity report.
+
+#pragma once
+
+#include "summary.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cpptracer
+{
+
+/// @brief The toggles of the bits of a signal, see Tracer::enableToggleCounting.
+struct SignalActivity {
+    /// The dot-separated path of the signal, starting from the root.
+    std::string name;
+    /// The symbol of the signal inside the trace.
+    std::string symbol;
+    /// Total number of toggles of the bits.
+    std::uint64_t toggles{};
+    /// Number of toggles of each bit, starting from the least significant one.
+    std::vector<std::uint64_t> bits;
+};
+
+/// @brief The toggles of the bits of the signals of a scope.
+struct ScopeActivity {
+    /// The dot-separated path of the scope, starting from the root.
+    std::string name;
+    /// Number of bits of the signals inside the scope and its subscopes.
+    std::uint64_t bits{};
+    /// Number of toggles of the bits inside the scope and its subscopes.
+    std::uint64_t toggles{};
+    /// The signals of the scope itself.
+    std::vector<SignalActivity> signals;
+};
+
+namespace detail
+{
+
+/// @brief Counts the bits set in a word.
+/// @param word the word.
+/// @return the number of bits set.
+inline auto popcount(std::uint64_t word) -> std::uint64_t
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<std::uint64_t>(__builtin_popcountll(word));
+#else
+    std::uint64_t count = 0;
+    for (; word != 0; word &= word - 1U) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+/// @brief Returns the index of the least significant bit set in the word.
+/// @param word the input word, must not be zero.
+/// @return the index of the bit.
+inline auto lowest_bit(std::uint64_t word) -> std::size_t
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<std::size_t>(__builtin_ctzll(word));
+#else
+    std::size_t index = 0;
+    while ((word & 1U) == 0) {
+        word >>= 1U;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+/// @brief Adds the toggles of up to 64 bits to their counters.
+/// @param counters the counters of the bits.
+/// @param diff the XOR of the current and the previous value, each bit set has toggled.
+/// @return the number of bits which have toggled.
+inline auto add_toggles(std::uint64_t *counters, std::uint64_t diff) -> std::uint64_t
+{
+    const std::uint64_t count = popcount(diff);
+    // Visit only the bits which have toggled, usually a few.
+    for (; diff != 0; diff &= diff - 1U) {
+        ++counters[lowest_bit(diff)];
+    }
+    return count;
+}
+
+/// @brief Writes the activity report, with the toggles of each scope and of the bits of its signals.
+/// @param output the output stream.
+/// @param scopes the activity of the scopes.
+inline void write_activity(std::ostream &output, const std::vector<ScopeActivity> &scopes)
+{
+    output << "{\n  \"scopes\": [";
+    for (std::size_t index = 0; index < scopes.size(); ++index) {
+        const auto &scope = scopes[index];
+        output << ((index > 0) ? ",\n    {\"name\": " : "\n    {\"name\": ");
+        write_summary_string(output, scope.name, '\\');
+        output << ", \"bits\": " << scope.bits << ", \"toggles\": " << scope.toggles << ", \"signals\": [";
+        for (std::size_t position = 0; position < scope.signals.size(); ++position) {
+            const auto &signal = scope.signals[position];
+            output << ((position > 0) ? ",\n      {\"name\": " : "\n      {\"name\": ");
+            write_summary_string(output, signal.name, '\\');
+            output << ", \"symbol\": ";
+            write_summary_string(output, signal.symbol, '\\');
+            output << ", \"toggles\": " << signal.toggles << ", \"bits\": [";
+            for (std::size_t bit = 0; bit < signal.bits.size(); ++bit) {
+                output << ((bit > 0) ? ", " : "") << signal.bits[bit];
+            }
+            output << "]}";
+        }
+        output << (scope.signals.empty() ? "]}" : "\n    ]}");
+    }
+    output << (scopes.empty() ? "]\n}\n" : "\n  ]\n}\n");
+}
+
+} // namespace detail
+
+} // namespace cpptracer
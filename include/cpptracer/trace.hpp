@@ -4,28 +4,45 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <bitset>
 #include <cstdint>
+#include <cstring>
+#include <stdexcept>
 #include <iomanip>
+#include <limits>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
-#include "feq.hpp"
+#include "filter.hpp"
+#include "format.hpp"
+#include "summary.hpp"
+#include "toggle.hpp"
+#include "traits.hpp"
 #include "utilities.hpp"
 
 namespace cpptracer
 {
 
+#ifdef __SIZEOF_INT128__
+/// @brief Unsigned 128-bit integer, available on compilers supporting it.
+__extension__ typedef unsigned __int128 uint128_t;
+#endif
+
 /// @brief Class used to store a trace.
+/// @details The name is not copied, it must outlive the trace. The tracer
+/// stores the names inside its arena.
 class Trace
 {
 public:
     /// @brief Constructor of the trace.
     /// @param _name the name of the trace.
     /// @param _symbol the symbol assigned to the trace.
-    Trace(std::string _name, std::string _symbol)
-        : name(std::move(_name))
+    Trace(std::string_view _name, std::string _symbol)
+        : name(_name)
         , symbol(std::move(_symbol))
     {
         // Nothing to do.
@@ -54,7 +71,7 @@ public:
 
     /// @brief Provides the name of the trace.
     /// @return the name of the trace.
-    auto getName() const -> const std::string & { return name; }
+    auto getName() const -> std::string { return std::string(name); }
 
     /// @brief Provides the symbol of the trace.
     /// @return the symbol of the trace.
@@ -64,10 +81,28 @@ public:
     /// @return the $var of the trace.
     virtual auto getVar() const -> std::string = 0;
 
+    /// @brief Provides the $var of an alias of the trace, which shares its symbol.
+    /// @param alias the name of the alias.
+    /// @return the $var of the alias.
+    auto getAliasVar(std::string_view alias) const -> std::string
+    {
+        // The $var ends with the name of the trace.
+        std::string var    = this->getVar();
+        const auto closure = std::string_view(" $end\n").size();
+        return var.replace(var.size() - closure - name.size(), name.size(), alias);
+    }
+
     /// @brief Provides the current value of the trace.
     /// @return the current value of the trace.
     virtual auto getValue() const -> std::string = 0;
 
+    /// @brief Provides the part of the current value which has changed
+    /// w.r.t. the previous one.
+    /// @details Traces covering several signals override it, to emit only the
+    /// signals which have changed.
+    /// @return the changed part of the current value of the trace.
+    virtual auto getChangedValue() const -> std::string { return this->getValue(); }
+
     /// @brief Checks if the value has changed w.r.t. the previous one.
     /// @return <b>True</b> if the value has changed,<br>
     ///         <b>False</b> otherwise.
@@ -76,14 +111,167 @@ public:
     /// @brief Updates the previous value with the current value.
     virtual void updatePrevious() = 0;
 
+    /// @brief Provides an estimate of the memory owned by the trace, besides the trace itself.
+    /// @return the number of bytes.
+    virtual auto getMemoryUsage() const -> std::size_t { return 0; }
+
+    /// @brief Sets the filter inherited from the scope, used unless the trace has its own.
+    /// @details Only traces of floating point values use it.
+    /// @param filter the filter.
+    virtual void setScopeFilter(const ChangeFilter &filter) { (void)filter; }
+
+    /// @brief Appends the current value to a buffer of records, to be rendered later by renderValue.
+    /// @details Traces override it to store the raw bytes of the value, and
+    /// postpone the formatting. By default, the value is formatted right away.
+    /// @param buffer the buffer of records.
+    /// @param whole if true, the whole value is stored, otherwise only its changed part.
+    virtual void captureValue(std::string &buffer, bool whole) const
+    {
+        const std::string value = whole ? this->getValue() : this->getChangedValue();
+        detail::append_raw(buffer, static_cast<std::uint32_t>(value.size()));
+        buffer.append(value);
+    }
+
+    /// @brief Renders a value stored by captureValue.
+    /// @param output the output string.
+    /// @param raw the position of the stored value.
+    /// @return the position following the stored value.
+    virtual auto renderValue(std::string &output, const char *raw) const -> const char *
+    {
+        const auto length = detail::read_raw<std::uint32_t>(raw);
+        output.append(raw, length);
+        return raw + length;
+    }
+
+    /// @brief Appends the previous value to a checkpoint, see Tracer::saveCheckpoint.
+    /// @details Traces without a state to restore keep the default, which stores nothing.
+    /// @param buffer the checkpoint.
+    virtual void saveState(std::string &buffer) const { (void)buffer; }
+
+    /// @brief Restores the previous value stored by saveState.
+    /// @param reader the reader of the checkpoint.
+    virtual void loadState(detail::RawReader &reader) { (void)reader; }
+
+    /// @brief Provides the number of signals of the trace, each one with its own summary.
+    /// @return the number of signals.
+    virtual auto getSignalCount() const -> std::size_t { return 1; }
+
+    /// @brief Provides the value as a number, for the summary statistics.
+    /// @param raw the bytes stored by captureValue, or null to read the variable.
+    /// @return the value, NaN if it is not numeric.
+    virtual auto getNumber(const char *raw) const -> double
+    {
+        (void)raw;
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    /// @brief Adds the current value to the summaries of the signals, see Tracer::enableSummary.
+    /// @param summaries the summaries of the signals of the trace.
+    /// @param time the scaled time of the value.
+    virtual void summarize(detail::SummaryAccumulator *summaries, std::uint64_t time) const
+    {
+        summaries->add(this->getNumber(nullptr), time);
+    }
+
+    /// @brief Sets the position of the summaries of the trace, inside those of the tracer.
+    /// @param index the position of the summary of the first signal.
+    void setSummaryIndex(std::size_t index) { summary_index = index; }
+
+    /// @brief Provides the position of the summaries of the trace, inside those of the tracer.
+    /// @return the position of the summary of the first signal.
+    auto getSummaryIndex() const -> std::size_t { return summary_index; }
+
+    /// @brief Provides the number of bits whose toggles can be counted, see Tracer::enableToggleCounting.
+    /// @return the number of bits, zero for traces which are neither integers nor bit-vectors.
+    virtual auto getBitWidth() const -> std::size_t { return 0; }
+
+    /// @brief Counts the bits of the current value which differ from the previous one.
+    /// @details It must be called before updatePrevious.
+    /// @param counters the toggle counters of the bits, starting from the least significant one.
+    /// @return the number of bits which have toggled.
+    virtual auto countToggles(std::uint64_t *counters) const -> std::uint64_t
+    {
+        (void)counters;
+        return 0;
+    }
+
+    /// @brief Sets the position of the toggle counters of the trace, inside those of the tracer.
+    /// @details The number of counters is the bit width at the time of the call.
+    /// @param index the position of the counter of the least significant bit.
+    void setToggleIndex(std::size_t index)
+    {
+        toggle_index = index;
+        toggle_width = this->getBitWidth();
+    }
+
+    /// @brief Provides the position of the toggle counters of the trace, inside those of the tracer.
+    /// @return the position of the counter of the least significant bit.
+    auto getToggleIndex() const -> std::size_t { return toggle_index; }
+
+    /// @brief Provides the number of toggle counters of the trace.
+    /// @return the number of counters.
+    auto getToggleWidth() const -> std::size_t { return toggle_width; }
+
+    /// @brief Provides the NumPy type of the value, for the columnar export, see Tracer::enableColumnarExport.
+    /// @return the type without the byte order (e.g., "i4"), null if the value cannot be exported.
+    virtual auto getColumnType() const -> const char * { return nullptr; }
+
+    /// @brief Appends the value in its native binary representation, for the columnar export.
+    /// @param output the output string.
+    /// @param raw the bytes stored by captureValue, or null to read the variable.
+    virtual void appendColumnValue(std::string &output, const char *raw) const
+    {
+        (void)output;
+        (void)raw;
+    }
+
+    /// @brief Sets the position of the column of the trace, inside the columnar export.
+    /// @param index the position of the column.
+    void setColumnIndex(std::size_t index) { column_index = index; }
+
+    /// @brief Provides the position of the column of the trace, inside the columnar export.
+    /// @return the position of the column.
+    auto getColumnIndex() const -> std::size_t { return column_index; }
+
 private:
     /// The name of the trace.
-    std::string name;
+    std::string_view name;
     /// The symbol assigned to the trace.
     std::string symbol;
+    /// The position of the summaries of the trace, inside those of the tracer.
+    std::size_t summary_index{};
+    /// The position of the toggle counters of the trace, inside those of the tracer.
+    std::size_t toggle_index{};
+    /// The number of toggle counters of the trace.
+    std::size_t toggle_width{};
+    /// The position of the column of the trace, inside the columnar export.
+    std::size_t column_index{};
+};
+
+namespace detail
+{
+
+/// @brief Checks if the traces of the given type store their values as raw
+/// bytes, which renderValue turns into text.
+/// @details The user-defined types store the raw value provided by their trace_traits.
+/// @tparam T the type of the traced variable.
+template <typename T>
+struct has_raw_values
+    : std::integral_constant<bool, std::is_floating_point<T>::value ||
+                                       (std::is_integral<T>::value && (sizeof(T) <= sizeof(std::uint64_t))) ||
+                                       has_trace_traits<T>::value> {
 };
 
+/// @brief Packed bit-vectors store their words as raw bytes.
+/// @tparam W the number of words.
+template <std::size_t W>
+struct has_raw_values<std::array<std::uint64_t, W>> : std::true_type {
+};
+
+} // namespace detail
+
 /// @brief Class used to store a trace of a specific type.
+/// @details Besides the built-in types, it traces the types described by trace_traits.
 /// @tparam T the type of the traced variable.
 template <typename T>
 class TraceWrapper : public Trace
@@ -99,19 +287,19 @@ public:
     /// @param _symbol the symbol to assign.
     /// @param _ptr pointer to the variable.
     /// @param _precision the desired output precision.
-    TraceWrapper(std::string _name, std::string _symbol, pointer_type _ptr, int _precision = 32)
-        : Trace(std::move(_name), std::move(_symbol))
+    TraceWrapper(std::string_view _name, std::string _symbol, pointer_type _ptr, int _precision = 32)
+        : Trace(_name, std::move(_symbol))
         , ptr(_ptr)
         , previous()
         , precision(_precision)
 
     {
         if constexpr (std::is_same<T, float>::value) {
-            tolerance = 1e-09;
+            filter_threshold = 1e-09;
         } else if constexpr (std::is_same<T, double>::value) {
-            tolerance = 1e-12;
+            filter_threshold = 1e-12;
         } else if constexpr (std::is_same<T, long double>::value) {
-            tolerance = 1e-24;
+            filter_threshold = 1e-24;
         }
     }
 
@@ -143,23 +331,193 @@ public:
 
     void updatePrevious() override { previous = (*ptr); }
 
+    void saveState(std::string &buffer) const override { detail::append_state(buffer, previous); }
+
+    void loadState(detail::RawReader &reader) override { reader.read(previous); }
+
+    void captureValue(std::string &buffer, bool whole) const override
+    {
+        if constexpr (is_custom) {
+            detail::append_raw(buffer, traits::raw(*ptr));
+        } else if constexpr (is_raw) {
+            detail::append_raw(buffer, *ptr);
+        } else {
+            Trace::captureValue(buffer, whole);
+        }
+    }
+
+    auto renderValue(std::string &output, const char *raw) const -> const char * override
+    {
+        if constexpr (is_custom) {
+            detail::append_traits_value<traits>(output, detail::read_raw<raw_type>(raw), precision);
+            output.append(this->getSymbol()).push_back('\n');
+            return raw;
+        } else if constexpr (is_raw) {
+            detail::append_value(output, detail::read_raw<T>(raw), precision);
+            output.append(this->getSymbol()).push_back('\n');
+            return raw;
+        } else {
+            return Trace::renderValue(output, raw);
+        }
+    }
+
+    auto getNumber(const char *raw) const -> double override
+    {
+        if constexpr (is_custom) {
+            return static_cast<double>((raw != nullptr) ? detail::read_raw<raw_type>(raw) : traits::raw(*ptr));
+        } else if constexpr (std::is_arithmetic<T>::value) {
+            return static_cast<double>((raw != nullptr) ? detail::read_raw<T>(raw) : *ptr);
+        } else {
+            return Trace::getNumber(raw);
+        }
+    }
+
+    auto getColumnType() const -> const char * override
+    {
+        if constexpr (is_custom) {
+            return detail::npy_type<raw_type>();
+        } else if constexpr (is_raw && std::is_arithmetic<T>::value) {
+            return detail::signal_info<T>::npy;
+        } else {
+            return Trace::getColumnType();
+        }
+    }
+
+    void appendColumnValue(std::string &output, const char *raw) const override
+    {
+        if constexpr (is_custom) {
+            detail::append_raw(output, (raw != nullptr) ? detail::read_raw<raw_type>(raw) : traits::raw(*ptr));
+        } else if constexpr (is_raw && std::is_arithmetic<T>::value) {
+            detail::append_raw(output, (raw != nullptr) ? detail::read_raw<T>(raw) : *ptr);
+        } else {
+            Trace::appendColumnValue(output, raw);
+        }
+    }
+
+    auto getBitWidth() const -> std::size_t override
+    {
+        if constexpr (is_custom) {
+            return std::is_integral<raw_type>::value ? traits::width : 0U;
+        } else if constexpr (std::is_same<T, bool>::value) {
+            return 1U;
+        } else if constexpr (std::is_same<T, std::vector<bool>>::value) {
+            return ptr->size();
+        } else if constexpr (is_bits) {
+            return sizeof(T) * 8U;
+        } else {
+            return 0U;
+        }
+    }
+
+    auto countToggles(std::uint64_t *counters) const -> std::uint64_t override
+    {
+        if constexpr (is_custom && std::is_integral<raw_type>::value) {
+            using U                  = std::make_unsigned_t<raw_type>;
+            const std::uint64_t diff = static_cast<std::uint64_t>(static_cast<U>(traits::raw(previous))) ^
+                                       static_cast<std::uint64_t>(static_cast<U>(traits::raw(*ptr)));
+            // Only the bits of the signal are counted.
+            const std::uint64_t mask = (traits::width >= 64U) ? ~std::uint64_t(0) : ((1ULL << traits::width) - 1U);
+            return detail::add_toggles(counters, diff & mask);
+        } else if constexpr (is_custom) {
+            return Trace::countToggles(counters);
+        } else if constexpr (std::is_same<T, bool>::value) {
+            counters[0] += (previous != *ptr) ? 1U : 0U;
+            return (previous != *ptr) ? 1U : 0U;
+        } else if constexpr (std::is_same<T, std::vector<bool>>::value) {
+            // The vector could have been resized, only the bits having a counter are compared.
+            const std::size_t bits = std::min({this->getToggleWidth(), previous.size(), ptr->size()});
+            std::uint64_t count    = 0;
+            for (std::size_t bit = 0; bit < bits; ++bit) {
+                if (previous[bit] != (*ptr)[bit]) {
+                    ++counters[bit];
+                    ++count;
+                }
+            }
+            return count;
+#ifdef __SIZEOF_INT128__
+        } else if constexpr (std::is_same<T, uint128_t>::value) {
+            const uint128_t diff = previous ^ (*ptr);
+            return detail::add_toggles(counters, static_cast<std::uint64_t>(diff)) +
+                   detail::add_toggles(counters + 64, static_cast<std::uint64_t>(diff >> 64U));
+#endif
+        } else if constexpr (is_bits) {
+            using U = std::make_unsigned_t<T>;
+            return detail::add_toggles(counters, static_cast<std::uint64_t>(static_cast<U>(previous)) ^
+                                                     static_cast<std::uint64_t>(static_cast<U>(*ptr)));
+        } else {
+            return Trace::countToggles(counters);
+        }
+    }
+
     /// @brief Changes the output precision for floating point values.
     /// @param _precision the desired output precision.
     void setPrecision(int _precision) { precision = _precision; }
 
     /// @brief Sets the tollerance for checking equality between floating point values.
     /// @param _tolerance the tollerance for checking equality.
-    void setTolerance(double _tolerance) { tolerance = _tolerance; }
+    void setTolerance(double _tolerance)
+    {
+        filter_kind      = FilterKind::Tolerance;
+        filter_threshold = _tolerance;
+        own_filter       = true;
+    }
+
+    /// @brief Sets the filter which decides if a floating point value has
+    /// changed, overriding the one of the scope.
+    /// @tparam U the type of the variable, the check is deferred to the call.
+    /// @param filter the filter.
+    template <typename U = T>
+    void setFilter(const ChangeFilter &filter)
+    {
+        static_assert(std::is_floating_point<U>::value, "Filters apply only to floating point values.");
+        filter_kind      = filter.kind;
+        filter_threshold = filter.threshold;
+        own_filter       = true;
+    }
+
+    /// @brief Provides the filter which decides if a floating point value has changed.
+    /// @return the filter.
+    auto getFilter() const -> ChangeFilter { return {filter_kind, filter_threshold}; }
+
+    void setScopeFilter(const ChangeFilter &filter) override
+    {
+        if constexpr (std::is_floating_point<T>::value) {
+            if (!own_filter) {
+                filter_kind      = filter.kind;
+                filter_threshold = filter.threshold;
+            }
+        }
+    }
 
 private:
+    /// If true, the type is described by trace_traits.
+    static constexpr bool is_custom = detail::has_trace_traits<T>::value;
+    /// The traits of the type, see trace_traits.
+    using traits = trace_traits<T>;
+    /// The type of the raw values, the traced one unless it is described by trace_traits.
+    using raw_type = typename detail::raw_type_of<T>::type;
+    /// If true, the values are stored raw by captureValue, and formatted by renderValue.
+    static constexpr bool is_raw = detail::has_raw_values<T>::value;
+    /// If true, the value is an integer, whose bits can toggle.
+#ifdef __SIZEOF_INT128__
+    static constexpr bool is_bits = (std::is_integral<T>::value && (sizeof(T) <= sizeof(std::uint64_t))) ||
+                                    std::is_same<T, uint128_t>::value;
+#else
+    static constexpr bool is_bits = std::is_integral<T>::value && (sizeof(T) <= sizeof(std::uint64_t));
+#endif
+
     /// A pointer to the variable that has to be traced.
     pointer_type ptr;
     /// Previous value of the trace.
     value_type previous;
     /// The floating point precision.
     int precision;
-    /// The tolerance used to check if two floating point values are equal.
-    double tolerance{};
+    /// The kind of filter used to check if a floating point value has changed.
+    FilterKind filter_kind{FilterKind::Tolerance};
+    /// If true, the filter has been set on the trace, and the one of the scope is ignored.
+    bool own_filter{false};
+    /// The threshold of the filter, by default the tolerance used to check equality.
+    double filter_threshold{};
 };
 
 /// @brief Specialization for bool arrays.
@@ -182,8 +540,82 @@ public:
     /// @param _name     The name of the trace.
     /// @param _symbol   The symbol to assign.
     /// @param _ptr      Pointer to the variable.
-    TraceWrapper(std::string _name, std::string _symbol, pointer_type _ptr)
-        : Trace(std::move(_name), std::move(_symbol))
+    TraceWrapper(std::string_view _name, std::string _symbol, pointer_type _ptr)
+        : Trace(_name, std::move(_symbol))
+        , ptr(_ptr)
+        , previous()
+    {
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The other entity to copy.
+    TraceWrapper(const TraceWrapper &other) = default;
+
+    /// @brief Move constructor.
+    /// @param other The other entity to move.
+    TraceWrapper(TraceWrapper &&other) noexcept = default;
+
+    /// @brief Copy assignment operator.
+    /// @param other The other entity to copy.
+    /// @return A reference to this object.
+    auto operator=(const TraceWrapper &other) -> TraceWrapper & = default;
+
+    /// @brief Move assignment operator.
+    /// @param other The other entity to move.
+    /// @return A reference to this object.
+    auto operator=(TraceWrapper &&other) noexcept -> TraceWrapper & = default;
+
+    ~TraceWrapper() override = default;
+
+    auto getVar() const -> std::string override;
+
+    auto getValue() const -> std::string override;
+
+    auto hasChanged() const -> bool override;
+
+    void updatePrevious() override { previous = (*ptr); }
+
+    void saveState(std::string &buffer) const override { detail::append_state(buffer, previous); }
+
+    void loadState(detail::RawReader &reader) override { reader.read(previous); }
+
+    auto getBitWidth() const -> std::size_t override { return N; }
+
+    auto countToggles(std::uint64_t *counters) const -> std::uint64_t override
+    {
+        std::uint64_t count = 0;
+        for (std::size_t bit = 0; bit < N; ++bit) {
+            if (previous[bit] != (*ptr)[bit]) {
+                ++counters[bit];
+                ++count;
+            }
+        }
+        return count;
+    }
+};
+
+/// @brief Specialization for bitsets.
+/// @tparam N the number of bits.
+template <std::size_t N>
+class TraceWrapper<std::bitset<N>> : public Trace
+{
+public:
+    /// @brief The type of the traced variable.
+    using value_type   = std::bitset<N>;
+    /// @brief The pointer type of the traced variable.
+    using pointer_type = const std::bitset<N> *;
+
+    /// A pointer to the variable that has to be traced.
+    pointer_type ptr;
+    /// Previous value of the trace.
+    value_type previous;
+
+    /// @brief Constructor.
+    /// @param _name     The name of the trace.
+    /// @param _symbol   The symbol to assign.
+    /// @param _ptr      Pointer to the variable.
+    TraceWrapper(std::string_view _name, std::string _symbol, pointer_type _ptr)
+        : Trace(_name, std::move(_symbol))
         , ptr(_ptr)
         , previous()
     {
@@ -216,84 +648,210 @@ public:
     auto hasChanged() const -> bool override;
 
     void updatePrevious() override { previous = (*ptr); }
+
+    void saveState(std::string &buffer) const override { detail::append_state(buffer, previous); }
+
+    void loadState(detail::RawReader &reader) override { reader.read(previous); }
+
+    auto getBitWidth() const -> std::size_t override { return N; }
+
+    auto countToggles(std::uint64_t *counters) const -> std::uint64_t override
+    {
+        const std::bitset<N> diff = previous ^ (*ptr);
+        if (diff.none()) {
+            return 0;
+        }
+        for (std::size_t bit = 0; bit < N; ++bit) {
+            counters[bit] += diff[bit] ? 1U : 0U;
+        }
+        return diff.count();
+    }
+};
+
+/// @brief Specialization for packed bit-vectors, stored as arrays of words.
+/// @details The first word holds the least significant bits, and only the
+/// lowest `width` bits are traced.
+/// @tparam W the number of words.
+template <std::size_t W>
+class TraceWrapper<std::array<std::uint64_t, W>> : public Trace
+{
+public:
+    /// @brief The type of the traced variable.
+    using value_type   = std::array<std::uint64_t, W>;
+    /// @brief The pointer type of the traced variable.
+    using pointer_type = const std::array<std::uint64_t, W> *;
+
+    /// A pointer to the variable that has to be traced.
+    pointer_type ptr;
+    /// Previous value of the trace.
+    value_type previous;
+    /// The number of traced bits.
+    std::size_t width;
+
+    /// @brief Constructor.
+    /// @param _name     The name of the trace.
+    /// @param _symbol   The symbol to assign.
+    /// @param _ptr      Pointer to the variable.
+    /// @param _width    The number of traced bits.
+    TraceWrapper(std::string_view _name, std::string _symbol, pointer_type _ptr, std::size_t _width = W * 64U)
+        : Trace(_name, std::move(_symbol))
+        , ptr(_ptr)
+        , previous()
+        , width(_width)
+    {
+        if ((width == 0) || (width > W * 64U)) {
+            throw std::runtime_error("The width of '" + this->getName() + "' does not fit its words.");
+        }
+    }
+
+    /// @brief Copy constructor.
+    /// @param other The other entity to copy.
+    TraceWrapper(const TraceWrapper &other) = default;
+
+    /// @brief Move constructor.
+    /// @param other The other entity to move.
+    TraceWrapper(TraceWrapper &&other) noexcept = default;
+
+    /// @brief Copy assignment operator.
+    /// @param other The other entity to copy.
+    /// @return A reference to this object.
+    auto operator=(const TraceWrapper &other) -> TraceWrapper & = default;
+
+    /// @brief Move assignment operator.
+    /// @param other The other entity to move.
+    /// @return A reference to this object.
+    auto operator=(TraceWrapper &&other) noexcept -> TraceWrapper & = default;
+
+    ~TraceWrapper() override = default;
+
+    auto getVar() const -> std::string override;
+
+    auto getValue() const -> std::string override;
+
+    auto hasChanged() const -> bool override;
+
+    void updatePrevious() override { previous = (*ptr); }
+
+    void saveState(std::string &buffer) const override { detail::append_state(buffer, previous); }
+
+    void loadState(detail::RawReader &reader) override { reader.read(previous); }
+
+    auto getBitWidth() const -> std::size_t override { return width; }
+
+    auto countToggles(std::uint64_t *counters) const -> std::uint64_t override
+    {
+        // XOR whole words, masking the bits above the width inside the last one.
+        const std::size_t nwords = (width + 63U) / 64U;
+        const std::size_t bits   = width - (nwords - 1U) * 64U;
+        const std::uint64_t mask = (bits == 64U) ? ~std::uint64_t(0) : ((std::uint64_t(1) << bits) - 1U);
+        std::uint64_t count      = 0;
+        for (std::size_t word = 0; word < nwords; ++word) {
+            const std::uint64_t diff = previous[word] ^ (*ptr)[word];
+            count += detail::add_toggles(counters + word * 64U, (word + 1U == nwords) ? (diff & mask) : diff);
+        }
+        return count;
+    }
+
+    void captureValue(std::string &buffer, bool) const override { detail::append_raw(buffer, *ptr); }
+
+    auto renderValue(std::string &output, const char *raw) const -> const char * override
+    {
+        const auto words = detail::read_raw<value_type>(raw);
+        output.push_back('b');
+        utility::append_binary(output, words.data(), width);
+        output.push_back(' ');
+        output.append(this->getSymbol()).push_back('\n');
+        return raw;
+    }
 };
 
 // ----------------------------------------------------------------------------
 // Provides specific definition.
+template <typename T>
+auto TraceWrapper<T>::getVar() const -> std::string
+{
+    static_assert(is_custom, "The type cannot be traced, unless it is described by cpptracer::trace_traits.");
+    static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be described by traits.");
+    static_assert((traits::width > 0) && (traits::width <= sizeof(raw_type) * 8U),
+                  "The width must be positive, and fit inside the raw type.");
+    return "$var " + std::string(traits::kind) + " " + std::to_string(traits::width) + " " + this->getSymbol() + " " +
+           this->getName() + " $end\n";
+}
+
 template <>
-auto TraceWrapper<bool>::getVar() const -> std::string
+inline auto TraceWrapper<bool>::getVar() const -> std::string
 {
     return "$var integer 1 " + this->getSymbol() + " " + this->getName() + " $end\n";
 }
 
 template <>
-auto TraceWrapper<int8_t>::getVar() const -> std::string
+inline auto TraceWrapper<int8_t>::getVar() const -> std::string
 {
     return "$var integer  8 " + this->getSymbol() + " " + this->getName() + " $end\n";
 }
 
 template <>
-auto TraceWrapper<int16_t>::getVar() const -> std::string
+inline auto TraceWrapper<int16_t>::getVar() const -> std::string
 {
     return "$var integer 16 " + this->getSymbol() + " " + this->getName() + " $end\n";
 }
 
 template <>
-auto TraceWrapper<int32_t>::getVar() const -> std::string
+inline auto TraceWrapper<int32_t>::getVar() const -> std::string
 {
     return "$var integer 32 " + this->getSymbol() + " " + this->getName() + " $end\n";
 }
 
 template <>
-auto TraceWrapper<int64_t>::getVar() const -> std::string
+inline auto TraceWrapper<int64_t>::getVar() const -> std::string
 {
     return "$var integer 64 " + this->getSymbol() + " " + this->getName() + " $end\n";
 }
 
 template <>
-auto TraceWrapper<uint8_t>::getVar() const -> std::string
+inline auto TraceWrapper<uint8_t>::getVar() const -> std::string
 {
     return "$var integer  8 " + this->getSymbol() + " " + this->getName() + " $end\n";
 }
 
 template <>
-auto TraceWrapper<uint16_t>::getVar() const -> std::string
+inline auto TraceWrapper<uint16_t>::getVar() const -> std::string
 {
     return "$var integer 16 " + this->getSymbol() + " " + this->getName() + " $end\n";
 }
 
 template <>
-auto TraceWrapper<uint32_t>::getVar() const -> std::string
+inline auto TraceWrapper<uint32_t>::getVar() const -> std::string
 {
     return "$var integer 32 " + this->getSymbol() + " " + this->getName() + " $end\n";
 }
 
 template <>
-auto TraceWrapper<uint64_t>::getVar() const -> std::string
+inline auto TraceWrapper<uint64_t>::getVar() const -> std::string
 {
     return "$var integer 64 " + this->getSymbol() + " " + this->getName() + " $end\n";
 }
 
 template <>
-auto TraceWrapper<float>::getVar() const -> std::string
+inline auto TraceWrapper<float>::getVar() const -> std::string
 {
     return "$var real 32 " + this->getSymbol() + " " + this->getName() + " $end\n";
 }
 
 template <>
-auto TraceWrapper<double>::getVar() const -> std::string
+inline auto TraceWrapper<double>::getVar() const -> std::string
 {
     return "$var real 64 " + this->getSymbol() + " " + this->getName() + " $end\n";
 }
 
 template <>
-auto TraceWrapper<long double>::getVar() const -> std::string
+inline auto TraceWrapper<long double>::getVar() const -> std::string
 {
     return "$var real 64 " + this->getSymbol() + " " + this->getName() + " $end\n";
 }
 
 template <>
-auto TraceWrapper<std::vector<bool>>::getVar() const -> std::string
+inline auto TraceWrapper<std::vector<bool>>::getVar() const -> std::string
 {
     return "$var wire " + std::to_string(ptr->size()) + " " + this->getSymbol() + " " + this->getName() + " $end\n";
 }
@@ -304,83 +862,112 @@ auto TraceWrapper<std::array<bool, N>>::getVar() const -> std::string
     return "$var wire " + std::to_string(N) + " " + this->getSymbol() + " " + this->getName() + " $end\n";
 }
 
+template <std::size_t N>
+auto TraceWrapper<std::bitset<N>>::getVar() const -> std::string
+{
+    return "$var wire " + std::to_string(N) + " " + this->getSymbol() + " " + this->getName() + " $end\n";
+}
+
+template <std::size_t W>
+auto TraceWrapper<std::array<std::uint64_t, W>>::getVar() const -> std::string
+{
+    return "$var wire " + std::to_string(width) + " " + this->getSymbol() + " " + this->getName() + " $end\n";
+}
+
+#ifdef __SIZEOF_INT128__
+template <>
+inline auto TraceWrapper<uint128_t>::getVar() const -> std::string
+{
+    return "$var integer 128 " + this->getSymbol() + " " + this->getName() + " $end\n";
+}
+#endif
+
 // ----------------------------------------------------------------------------
 // Provides specific changing check.
+template <typename T>
+auto TraceWrapper<T>::hasChanged() const -> bool
+{
+    return !traits::equal(previous, (*ptr));
+}
+
 template <>
-auto TraceWrapper<bool>::hasChanged() const -> bool
+inline auto TraceWrapper<bool>::hasChanged() const -> bool
 {
     return (previous != (*ptr));
 }
 
 template <>
-auto TraceWrapper<int8_t>::hasChanged() const -> bool
+inline auto TraceWrapper<int8_t>::hasChanged() const -> bool
 {
     return (previous != (*ptr));
 }
 
 template <>
-auto TraceWrapper<int16_t>::hasChanged() const -> bool
+inline auto TraceWrapper<int16_t>::hasChanged() const -> bool
 {
     return (previous != (*ptr));
 }
 
 template <>
-auto TraceWrapper<int32_t>::hasChanged() const -> bool
+inline auto TraceWrapper<int32_t>::hasChanged() const -> bool
 {
     return (previous != (*ptr));
 }
 
 template <>
-auto TraceWrapper<int64_t>::hasChanged() const -> bool
+inline auto TraceWrapper<int64_t>::hasChanged() const -> bool
 {
     return (previous != (*ptr));
 }
 
 template <>
-auto TraceWrapper<uint8_t>::hasChanged() const -> bool
+inline auto TraceWrapper<uint8_t>::hasChanged() const -> bool
 {
     return (previous != (*ptr));
 }
 
 template <>
-auto TraceWrapper<uint16_t>::hasChanged() const -> bool
+inline auto TraceWrapper<uint16_t>::hasChanged() const -> bool
 {
     return (previous != (*ptr));
 }
 
 template <>
-auto TraceWrapper<uint32_t>::hasChanged() const -> bool
+inline auto TraceWrapper<uint32_t>::hasChanged() const -> bool
 {
     return (previous != (*ptr));
 }
 
 template <>
-auto TraceWrapper<uint64_t>::hasChanged() const -> bool
+inline auto TraceWrapper<uint64_t>::hasChanged() const -> bool
 {
     return (previous != (*ptr));
 }
 
 template <>
-auto TraceWrapper<float>::hasChanged() const -> bool
+inline auto TraceWrapper<float>::hasChanged() const -> bool
 {
-    return !is_equal(previous, (*ptr), tolerance);
+    return detail::filter_changed(previous, (*ptr), filter_kind, filter_threshold);
 }
 
 template <>
-auto TraceWrapper<double>::hasChanged() const -> bool
+inline auto TraceWrapper<double>::hasChanged() const -> bool
 {
-    return !is_equal(previous, (*ptr), tolerance);
+    return detail::filter_changed(previous, (*ptr), filter_kind, filter_threshold);
 }
 
 template <>
-auto TraceWrapper<long double>::hasChanged() const -> bool
+inline auto TraceWrapper<long double>::hasChanged() const -> bool
 {
-    return !is_equal(previous, (*ptr), tolerance);
+    return detail::filter_changed(previous, (*ptr), filter_kind, filter_threshold);
 }
 
 template <>
-auto TraceWrapper<std::vector<bool>>::hasChanged() const -> bool
+inline auto TraceWrapper<std::vector<bool>>::hasChanged() const -> bool
 {
+    if (previous.size() != ptr->size()) {
+        return true;
+    }
     auto it_prev = previous.cbegin();
     auto it_curr = ptr->cbegin();
     while ((it_prev != previous.cend()) && (it_curr != ptr->cend())) {
@@ -395,75 +982,102 @@ auto TraceWrapper<std::vector<bool>>::hasChanged() const -> bool
 template <std::size_t N>
 auto TraceWrapper<std::array<bool, N>>::hasChanged() const -> bool
 {
-    auto it_prev = previous.cbegin();
-    auto it_curr = ptr->cbegin();
-    while ((it_prev != previous.cend()) && (it_curr != ptr->cend())) {
-        if ((*it_curr) != (*it_prev)) {
-            return true;
-        }
-        ++it_prev, ++it_curr;
+    return std::memcmp(previous.data(), ptr->data(), N * sizeof(bool)) != 0;
+}
+
+template <std::size_t N>
+auto TraceWrapper<std::bitset<N>>::hasChanged() const -> bool
+{
+    return (previous != (*ptr));
+}
+
+template <std::size_t W>
+auto TraceWrapper<std::array<std::uint64_t, W>>::hasChanged() const -> bool
+{
+    // Compare the whole words, then only the traced bits of the last word.
+    const std::size_t nwords = (width + 63U) / 64U;
+    if (std::memcmp(previous.data(), ptr->data(), (nwords - 1U) * sizeof(std::uint64_t)) != 0) {
+        return true;
     }
-    return false;
+    const std::size_t bits   = width - (nwords - 1U) * 64U;
+    const std::uint64_t mask = (bits == 64U) ? ~std::uint64_t(0) : ((std::uint64_t(1) << bits) - 1U);
+    return ((previous[nwords - 1U] ^ (*ptr)[nwords - 1U]) & mask) != 0;
 }
 
+#ifdef __SIZEOF_INT128__
+template <>
+inline auto TraceWrapper<uint128_t>::hasChanged() const -> bool
+{
+    return (previous != (*ptr));
+}
+#endif
+
 // ----------------------------------------------------------------------------
 // Provides specific values.
+template <typename T>
+auto TraceWrapper<T>::getValue() const -> std::string
+{
+    std::string value;
+    detail::append_traits_value<traits>(value, traits::raw(*ptr), precision);
+    return value + this->getSymbol() + "\n";
+}
+
 template <>
-auto TraceWrapper<bool>::getValue() const -> std::string
+inline auto TraceWrapper<bool>::getValue() const -> std::string
 {
-    return std::string((*ptr) ? "b1" : "b0") + this->getSymbol() + "\n";
+    return std::string((*ptr) ? "b1 " : "b0 ") + this->getSymbol() + "\n";
 }
 
 template <>
-auto TraceWrapper<int8_t>::getValue() const -> std::string
+inline auto TraceWrapper<int8_t>::getValue() const -> std::string
 {
     return "b" + utility::dec_to_binary(*ptr, int8_t(8)) + " " + this->getSymbol() + "\n";
 }
 
 template <>
-auto TraceWrapper<int16_t>::getValue() const -> std::string
+inline auto TraceWrapper<int16_t>::getValue() const -> std::string
 {
     return "b" + utility::dec_to_binary(*ptr, int16_t(16)) + " " + this->getSymbol() + "\n";
 }
 
 template <>
-auto TraceWrapper<int32_t>::getValue() const -> std::string
+inline auto TraceWrapper<int32_t>::getValue() const -> std::string
 {
     return "b" + utility::dec_to_binary(*ptr, int32_t(32)) + " " + this->getSymbol() + "\n";
 }
 
 template <>
-auto TraceWrapper<int64_t>::getValue() const -> std::string
+inline auto TraceWrapper<int64_t>::getValue() const -> std::string
 {
     return "b" + utility::dec_to_binary(*ptr, int64_t(64)) + " " + this->getSymbol() + "\n";
 }
 
 template <>
-auto TraceWrapper<uint8_t>::getValue() const -> std::string
+inline auto TraceWrapper<uint8_t>::getValue() const -> std::string
 {
     return "b" + utility::dec_to_binary(*ptr, uint8_t(8)) + " " + this->getSymbol() + "\n";
 }
 
 template <>
-auto TraceWrapper<uint16_t>::getValue() const -> std::string
+inline auto TraceWrapper<uint16_t>::getValue() const -> std::string
 {
     return "b" + utility::dec_to_binary(*ptr, uint16_t(16)) + " " + this->getSymbol() + "\n";
 }
 
 template <>
-auto TraceWrapper<uint32_t>::getValue() const -> std::string
+inline auto TraceWrapper<uint32_t>::getValue() const -> std::string
 {
     return "b" + utility::dec_to_binary(*ptr, uint32_t(32)) + " " + this->getSymbol() + "\n";
 }
 
 template <>
-auto TraceWrapper<uint64_t>::getValue() const -> std::string
+inline auto TraceWrapper<uint64_t>::getValue() const -> std::string
 {
     return "b" + utility::dec_to_binary(*ptr, uint64_t(64)) + " " + this->getSymbol() + "\n";
 }
 
 template <>
-auto TraceWrapper<float>::getValue() const -> std::string
+inline auto TraceWrapper<float>::getValue() const -> std::string
 {
     std::ostringstream oss;
     oss << std::scientific << std::setprecision(precision) << "r" << *ptr << " " << this->getSymbol() << "\n";
@@ -471,7 +1085,7 @@ auto TraceWrapper<float>::getValue() const -> std::string
 }
 
 template <>
-auto TraceWrapper<double>::getValue() const -> std::string
+inline auto TraceWrapper<double>::getValue() const -> std::string
 {
     std::ostringstream oss;
     oss << std::scientific << std::setprecision(precision) << "r" << *ptr << " " << this->getSymbol() << "\n";
@@ -479,7 +1093,7 @@ auto TraceWrapper<double>::getValue() const -> std::string
 }
 
 template <>
-auto TraceWrapper<long double>::getValue() const -> std::string
+inline auto TraceWrapper<long double>::getValue() const -> std::string
 {
     std::ostringstream oss;
     oss << std::scientific << std::setprecision(precision) << "r" << *ptr << " " << this->getSymbol() << "\n";
@@ -487,7 +1101,7 @@ auto TraceWrapper<long double>::getValue() const -> std::string
 }
 
 template <>
-auto TraceWrapper<std::vector<bool>>::getValue() const -> std::string
+inline auto TraceWrapper<std::vector<bool>>::getValue() const -> std::string
 {
     return "b" + utility::vector_to_binary(*ptr) + " " + this->getSymbol() + "\n";
 }
@@ -498,4 +1112,40 @@ auto TraceWrapper<std::array<bool, N>>::getValue() const -> std::string
     return "b" + utility::array_to_binary(*ptr) + " " + this->getSymbol() + "\n";
 }
 
+template <std::size_t N>
+auto TraceWrapper<std::bitset<N>>::getValue() const -> std::string
+{
+    std::string value;
+    value.reserve(N + this->getSymbol().size() + 3U);
+    value.push_back('b');
+    utility::append_binary(value, *ptr);
+    value.push_back(' ');
+    return value.append(this->getSymbol()).append("\n");
+}
+
+template <std::size_t W>
+auto TraceWrapper<std::array<std::uint64_t, W>>::getValue() const -> std::string
+{
+    std::string value;
+    value.reserve(width + this->getSymbol().size() + 3U);
+    value.push_back('b');
+    utility::append_binary(value, ptr->data(), width);
+    value.push_back(' ');
+    return value.append(this->getSymbol()).append("\n");
+}
+
+#ifdef __SIZEOF_INT128__
+template <>
+inline auto TraceWrapper<uint128_t>::getValue() const -> std::string
+{
+    std::string value;
+    value.reserve(128U + this->getSymbol().size() + 3U);
+    value.push_back('b');
+    utility::append_binary(value, static_cast<std::uint64_t>((*ptr) >> 64U), 64U);
+    utility::append_binary(value, static_cast<std::uint64_t>(*ptr), 64U);
+    value.push_back(' ');
+    return value.append(this->getSymbol()).append("\n");
+}
+#endif
+
 } // namespace cpptracer
@@ -4,18 +4,42 @@
 
 #pragma once
 
+#include "arena.hpp"
+#include "array_trace.hpp"
 #include "colors.hpp"
+#include "columns.hpp"
 #include "compression.hpp"
+#include "crash.hpp"
+#include "deferred.hpp"
+#include "direct_sink.hpp"
+#include "durability.hpp"
+#include "overflow.hpp"
+#include "parallel.hpp"
+#include "reorder.hpp"
 #include "scope.hpp"
+#include "shard.hpp"
+#include "sink.hpp"
+#include "stats.hpp"
+#include "struct_member.hpp"
+#include "summary.hpp"
 #include "timeScale.hpp"
+#include "toggle.hpp"
 #include "trace.hpp"
 #include "utilities.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <fstream> // std::ofstream
 #include <iomanip> // std::setprecision
+#include <limits>
+#include <memory>
+#include <optional>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 
 enum : unsigned char {
@@ -31,14 +55,59 @@ namespace cpptracer
 class Tracer
 {
 private:
+    /// @brief A traced variable, used to detect the aliases.
+    struct TracedVariable {
+        /// The trace of the variable.
+        Trace *trace;
+        /// The scope owning the trace.
+        Scope *scope;
+        /// The position of the trace inside the aliased traces, npos if it has no aliases.
+        std::size_t group;
+    };
+
+    /// Marks the traced variables without aliases.
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
     /// Name of the trace file.
     std::string filename;
     /// The output buffer.
-    std::ostringstream outbuffer;
+    detail::OutputBuffer outbuffer;
+    /// The sink which receives the trace, created at the first write if not set.
+    std::unique_ptr<TraceSink> sink;
+    /// Identifies the checkpoints, and their format.
+    static constexpr std::string_view checkpoint_magic = "cpptracer-checkpoint-1\n";
+    /// The buffer handed to the sink, whose storage is then reused by the output buffer.
+    std::string sink_buffer;
+    /// The sink writing the trace file, if created by the tracer, whose size is kept by the checkpoints.
+    FileSink *trace_file = nullptr;
+#ifdef CPPTRACER_POSIX
+    /// The part of the trace written on a fatal signal, null if disabled.
+    std::unique_ptr<detail::CrashFlush> crash_flush;
+#endif
+    /// When the written trace is forced to the storage device.
+    Durability durability = Durability::None;
+    /// The number of written bytes after which the trace is synced, with the periodic durability.
+    std::size_t sync_bytes = 0;
+    /// The time after which the trace is synced, with the periodic durability.
+    std::chrono::steady_clock::duration sync_interval{};
+    /// The number of bytes written since the last sync.
+    std::size_t unsynced_bytes = 0;
+    /// The time of the last sync.
+    std::chrono::steady_clock::time_point last_sync = std::chrono::steady_clock::now();
+    /// Storage of the scopes, the traces, and their names.
+    detail::Arena arena;
     /// The root of the scopes.
-    std::shared_ptr<Scope> root_scope;
+    Scope *root_scope;
     /// Pointer to the current scope.
-    std::shared_ptr<Scope> current_scope;
+    Scope *current_scope;
+    /// Index of the scopes, by parent and name.
+    std::unordered_map<detail::ScopeKey, Scope *, detail::ScopeKeyHash> scope_index;
+    /// Index of the traces, by their variable, used to detect the aliases.
+    std::unordered_map<detail::TraceKey, TracedVariable, detail::TraceKeyHash> trace_index;
+    /// The aliased traces, with the scope owning them followed by the scopes of their aliases.
+    std::vector<std::pair<Trace *, std::vector<Scope *>>> alias_groups;
+    /// Stack used to visit the scopes, kept to avoid allocating it at each sample.
+    mutable std::vector<std::pair<Scope *, bool>> scope_stack;
     /// The timescale.
     TimeScale timescale;
     /// The timescale.
@@ -54,9 +123,73 @@ private:
     /// Number of traces from all scopes
     /// Used to set unique id for each trace based on its index
     size_t traces_cout = 0;
+    /// The rank of the process, if the tracer writes a shard of the trace.
+    std::optional<std::size_t> shard_rank;
     /// Version text to display in $version section
     /// If empty, information about the library will be displayed
     std::string version_text;
+    /// The memory budget in bytes, zero if unlimited.
+    std::size_t memory_budget = 0;
+    /// What to do when the memory budget is exhausted.
+    OverflowPolicy overflow_policy = OverflowPolicy::Flush;
+    /// Estimated memory used by the scopes and the traces.
+    std::size_t registry_bytes = 0;
+    /// Number of bytes inside the output buffer.
+    std::size_t buffered_bytes = 0;
+    /// Number of samples dropped because of the memory budget.
+    std::uint64_t dropped_samples = 0;
+    /// Number of samples dropped since the last written one.
+    std::uint64_t pending_drops = 0;
+    /// Factor applied to the sampling period by the decimation.
+    unsigned decimation = 1;
+    /// Memory usage above which the sampling rate is halved again.
+    std::size_t decimation_threshold = 0;
+    /// If true, the tracing has been stopped because of the memory budget.
+    bool stopped = false;
+#ifdef ENABLE_COMPRESSION
+    /// The compressing sink created by default, if the compression is enabled.
+    CompressingSink *compressor = nullptr;
+#endif
+    /// The engine which samples the traces on several threads, null if disabled.
+    std::unique_ptr<detail::ParallelSampler> parallel_sampler;
+    /// The raw values waiting to be formatted, null if the formatting is not deferred.
+    std::unique_ptr<detail::DeferredBuffer> deferred_buffer;
+    /// Number of bytes used by the raw values waiting to be formatted.
+    std::size_t deferred_bytes = 0;
+    /// The recorded changes, waiting to be emitted in time order.
+    detail::ReorderBuffer reorder_buffer;
+    /// How late a change can be recorded, as scaled time.
+    std::uint64_t lateness_window = 0;
+    /// The latest scaled time of a recorded change.
+    std::uint64_t latest_change = 0;
+    /// The scaled time of the last emitted change.
+    std::uint64_t emitted_time = 0;
+    /// If true, at least one recorded change has been emitted.
+    bool changes_emitted = false;
+    /// Number of changes recorded after their time had already been emitted.
+    std::uint64_t late_changes = 0;
+    /// The result of closeTrace, once the trace has been closed.
+    std::optional<bool> closed;
+    /// The format of the summary written when the trace is closed, if enabled.
+    std::optional<SummaryFormat> summary_format;
+    /// The summaries of the signals, empty if disabled, see Trace::getSummaryIndex.
+    std::vector<detail::SummaryAccumulator> summaries;
+    /// The scaled time of the values being written, the end of the trace for the summaries.
+    std::uint64_t value_time = 0;
+    /// The exporter writing the values as columns, null if disabled.
+    std::unique_ptr<detail::ColumnExporter> columns;
+    /// If true, the toggles of the bits of the signals are counted.
+    bool count_toggles = false;
+    /// The toggle counters of the bits of the signals, see Trace::getToggleIndex.
+    std::vector<std::uint64_t> toggles;
+    /// If false, the values are neither formatted nor written, see disableOutput.
+    bool output_enabled = true;
+#ifdef ENABLE_STATS
+    /// The statistics about the tracer itself.
+    TracerStats statistics;
+    /// Enables the timers of the statistics.
+    bool stats_timers = false;
+#endif
 
 public:
     /// @brief Constructor.
@@ -65,11 +198,11 @@ public:
     /// @param root the name of the root scope.
     Tracer(std::string _filename, TimeScale const &_timescale, std::string root)
         : filename(std::move(_filename))
-        , root_scope(std::make_shared<Scope>(std::move(root)))
+        , arena()
+        , root_scope(arena.create<Scope>(arena.intern(root)))
         , current_scope(root_scope)
         , timescale(_timescale)
         , sampling(_timescale)
-
     {
         root_scope->parent = root_scope;
     }
@@ -79,8 +212,75 @@ public:
     Tracer(const Tracer &other) = delete;
 
     /// @brief Move constructor.
+    /// @details The moved-from tracer no longer owns a trace, and closing it does nothing.
     /// @param other The other entity to move.
-    Tracer(Tracer &&other) noexcept = default;
+    Tracer(Tracer &&other) noexcept
+        : filename(std::move(other.filename))
+        , outbuffer(std::move(other.outbuffer))
+        , sink(std::move(other.sink))
+        , sink_buffer(std::move(other.sink_buffer))
+        , trace_file(std::exchange(other.trace_file, nullptr))
+#ifdef CPPTRACER_POSIX
+        , crash_flush(std::move(other.crash_flush))
+#endif
+        , durability(other.durability)
+        , sync_bytes(other.sync_bytes)
+        , sync_interval(other.sync_interval)
+        , unsynced_bytes(other.unsynced_bytes)
+        , last_sync(other.last_sync)
+        , arena(std::move(other.arena))
+        , root_scope(std::exchange(other.root_scope, nullptr))
+        , current_scope(std::exchange(other.current_scope, nullptr))
+        , scope_index(std::move(other.scope_index))
+        , trace_index(std::move(other.trace_index))
+        , alias_groups(std::move(other.alias_groups))
+        , scope_stack(std::move(other.scope_stack))
+        , timescale(other.timescale)
+        , sampling(other.sampling)
+        , first_dump(other.first_dump)
+        , next_sample(other.next_sample)
+#ifdef ENABLE_COMPRESSION
+        , compress_traces(other.compress_traces)
+#endif
+        , traces_cout(other.traces_cout)
+        , shard_rank(other.shard_rank)
+        , version_text(std::move(other.version_text))
+        , memory_budget(other.memory_budget)
+        , overflow_policy(other.overflow_policy)
+        , registry_bytes(other.registry_bytes)
+        , buffered_bytes(other.buffered_bytes)
+        , dropped_samples(other.dropped_samples)
+        , pending_drops(other.pending_drops)
+        , decimation(other.decimation)
+        , decimation_threshold(other.decimation_threshold)
+        , stopped(other.stopped)
+#ifdef ENABLE_COMPRESSION
+        , compressor(std::exchange(other.compressor, nullptr))
+#endif
+        , parallel_sampler(std::move(other.parallel_sampler))
+        , deferred_buffer(std::move(other.deferred_buffer))
+        , deferred_bytes(other.deferred_bytes)
+        , reorder_buffer(std::move(other.reorder_buffer))
+        , lateness_window(other.lateness_window)
+        , latest_change(other.latest_change)
+        , emitted_time(other.emitted_time)
+        , changes_emitted(other.changes_emitted)
+        , late_changes(other.late_changes)
+        , closed(other.closed)
+        , summary_format(other.summary_format)
+        , summaries(std::move(other.summaries))
+        , value_time(other.value_time)
+        , columns(std::move(other.columns))
+        , count_toggles(other.count_toggles)
+        , toggles(std::move(other.toggles))
+        , output_enabled(other.output_enabled)
+#ifdef ENABLE_STATS
+        , statistics(std::move(other.statistics))
+        , stats_timers(other.stats_timers)
+#endif
+    {
+        other.closed = true;
+    }
 
     /// @brief Copy assignment operator.
     /// @param other The other entity to copy.
@@ -88,9 +288,89 @@ public:
     auto operator=(const Tracer &other) -> Tracer & = delete;
 
     /// @brief Move assignment operator.
+    /// @details The trace of this tracer is closed first, the moved-from
+    /// tracer no longer owns a trace, and closing it does nothing.
     /// @param other The other entity to move.
     /// @return A reference to this object.
-    auto operator=(Tracer &&other) noexcept -> Tracer & = default;
+    auto operator=(Tracer &&other) noexcept -> Tracer &
+    {
+        if (this == &other) {
+            return *this;
+        }
+        this->closeTrace();
+        // Stop the threads and the handler using the scopes and the buffer, before replacing them.
+        parallel_sampler.reset();
+        deferred_buffer.reset();
+#ifdef CPPTRACER_POSIX
+        crash_flush.reset();
+        outbuffer.setTail(nullptr);
+#endif
+        filename    = std::move(other.filename);
+        outbuffer   = std::move(other.outbuffer);
+        sink        = std::move(other.sink);
+        sink_buffer = std::move(other.sink_buffer);
+        trace_file  = std::exchange(other.trace_file, nullptr);
+#ifdef CPPTRACER_POSIX
+        crash_flush = std::move(other.crash_flush);
+#endif
+        durability     = other.durability;
+        sync_bytes     = other.sync_bytes;
+        sync_interval  = other.sync_interval;
+        unsynced_bytes = other.unsynced_bytes;
+        last_sync      = other.last_sync;
+        arena          = std::move(other.arena);
+        root_scope     = std::exchange(other.root_scope, nullptr);
+        current_scope  = std::exchange(other.current_scope, nullptr);
+        scope_index    = std::move(other.scope_index);
+        trace_index    = std::move(other.trace_index);
+        alias_groups   = std::move(other.alias_groups);
+        scope_stack    = std::move(other.scope_stack);
+        timescale      = other.timescale;
+        sampling       = other.sampling;
+        first_dump     = other.first_dump;
+        next_sample    = other.next_sample;
+#ifdef ENABLE_COMPRESSION
+        compress_traces = other.compress_traces;
+#endif
+        traces_cout          = other.traces_cout;
+        shard_rank           = other.shard_rank;
+        version_text         = std::move(other.version_text);
+        memory_budget        = other.memory_budget;
+        overflow_policy      = other.overflow_policy;
+        registry_bytes       = other.registry_bytes;
+        buffered_bytes       = other.buffered_bytes;
+        dropped_samples      = other.dropped_samples;
+        pending_drops        = other.pending_drops;
+        decimation           = other.decimation;
+        decimation_threshold = other.decimation_threshold;
+        stopped              = other.stopped;
+#ifdef ENABLE_COMPRESSION
+        compressor = std::exchange(other.compressor, nullptr);
+#endif
+        parallel_sampler = std::move(other.parallel_sampler);
+        deferred_buffer  = std::move(other.deferred_buffer);
+        deferred_bytes   = other.deferred_bytes;
+        reorder_buffer   = std::move(other.reorder_buffer);
+        lateness_window  = other.lateness_window;
+        latest_change    = other.latest_change;
+        emitted_time     = other.emitted_time;
+        changes_emitted  = other.changes_emitted;
+        late_changes     = other.late_changes;
+        closed           = other.closed;
+        summary_format   = other.summary_format;
+        summaries        = std::move(other.summaries);
+        value_time       = other.value_time;
+        columns          = std::move(other.columns);
+        count_toggles    = other.count_toggles;
+        toggles          = std::move(other.toggles);
+        output_enabled   = other.output_enabled;
+#ifdef ENABLE_STATS
+        statistics   = std::move(other.statistics);
+        stats_timers = other.stats_timers;
+#endif
+        other.closed = true;
+        return *this;
+    }
 
     /// @brief Destructor.
     ~Tracer()
@@ -104,7 +384,7 @@ public:
     void setSampling(TimeScale const &_sampling) { sampling = _sampling; }
 
     /// @brief Activate compression, only if enabled.
-    static void enableCompression()
+    void enableCompression()
     {
 #ifdef ENABLE_COMPRESSION
         compress_traces = true;
@@ -114,9 +394,348 @@ public:
 #endif
     }
 
+    /// @brief Sets the sink which receives the trace, instead of the trace file.
+    /// @details By default, the trace is written to the file given to the
+    /// constructor, compressed if enableCompression has been called. A sink
+    /// set here replaces both, so the compression must be added by wrapping
+    /// it in a CompressingSink. It must be set before the first write.
+    /// @param _sink the sink.
+    void setSink(std::unique_ptr<TraceSink> _sink)
+    {
+#ifdef CPPTRACER_POSIX
+        if (crash_flush) {
+            crash_flush->setSink(_sink.get());
+        }
+#endif
+#ifdef ENABLE_COMPRESSION
+        compressor = nullptr;
+#endif
+        trace_file = nullptr;
+        sink       = std::move(_sink);
+    }
+
+    /// @brief Sets when the written trace is forced to the storage device.
+    /// @details By default, the written trace is left to the page cache, and
+    /// a crash of the machine can lose what the operating system has not
+    /// stored yet. With the periodic durability, the buffered trace is written
+    /// and synced once the given number of bytes has accumulated since the
+    /// last sync, or once the given time has passed, whichever comes first, so
+    /// the cost of a sync is shared by many samples. With EveryFlush, each
+    /// write of the buffer is followed by a sync. The trace is always synced
+    /// when closed, unless the policy is None.
+    /// @param policy when the trace is synced.
+    /// @param bytes the number of bytes between the periodic syncs, zero to ignore it.
+    /// @param interval the time between the periodic syncs, zero to ignore it.
+    void setDurability(Durability policy, std::size_t bytes = 0, std::chrono::milliseconds interval = {})
+    {
+        if ((policy == Durability::Periodic) && (bytes == 0) && (interval.count() == 0)) {
+            throw std::runtime_error("The periodic durability needs a number of bytes or an interval.");
+        }
+        durability    = policy;
+        sync_bytes    = bytes;
+        sync_interval = interval;
+        last_sync     = std::chrono::steady_clock::now();
+    }
+
+    /// @brief Keeps the summary statistics of each signal, and writes them next to the trace when it is closed.
+    /// @details For each signal, the tracer counts the changes, and keeps the
+    /// smallest, the largest, and the last value, together with the mean
+    /// weighted by the time each value has been held, updating them as the
+    /// values are written. When the trace is closed, they are written to
+    /// `<filename>.summary.json` (or `.csv`), so getting them does not require
+    /// scanning the whole trace. The elements of the array traces are separate
+    /// signals, and only the changes of non-numeric signals are counted. It
+    /// must be called before createTrace.
+    /// @param format the format of the summary.
+    void enableSummary(SummaryFormat format = SummaryFormat::Json) { summary_format = format; }
+
+    /// @brief Returns the summary statistics of the values written so far.
+    /// @return the statistics of each signal, in the order of the trace, empty if not enabled.
+    auto summary() const -> std::vector<SignalSummary>
+    {
+        std::vector<SignalSummary> result;
+        if (summaries.empty()) {
+            return result;
+        }
+        std::vector<std::pair<const Scope *, std::string>> stack{{root_scope, std::string(root_scope->name)}};
+        while (!stack.empty()) {
+            auto current = std::move(stack.back());
+            stack.pop_back();
+            for (const auto *trace : current.first->traces) {
+                const std::string path    = current.second + "." + trace->getName();
+                const std::size_t signals = trace->getSignalCount();
+                const auto *accumulator   = &summaries[trace->getSummaryIndex()];
+                if (signals == 1) {
+                    result.emplace_back(accumulator->summarize(path, trace->getSymbol(), value_time));
+                    continue;
+                }
+                // The symbols of the signals of a trace are consecutive.
+                const auto first = std::stoull(trace->getSymbol());
+                for (std::size_t index = 0; index < signals; ++index) {
+                    result.emplace_back(accumulator[index].summarize(
+                        path + "[" + std::to_string(index) + "]", std::to_string(first + index), value_time));
+                }
+            }
+            for (auto it = current.first->subscopes.rbegin(); it != current.first->subscopes.rend(); ++it) {
+                stack.emplace_back(*it, current.second + "." + std::string((*it)->name));
+            }
+        }
+        return result;
+    }
+
+    /// @brief Exports the values of the signals as columns while tracing, e.g., for NumPy or pandas.
+    /// @details With ColumnFormat::Npy, each change of a signal appends its
+    /// scaled time and its value to `<filename>.<path>.npy`, an array of
+    /// records with the fields `time` (uint64) and `value`, stored in the
+    /// native type of the signal, so that `numpy.load(name, mmap_mode="r")`
+    /// maps it without parsing. With ColumnFormat::Csv, each sample appends a
+    /// row with the time and the values of all the signals to
+    /// `<filename>.columns.csv`. The values are buffered and written as the
+    /// tracing goes on, and the number of records inside the NumPy headers is
+    /// set when the trace is closed. Only the scalar integer, bool and floating
+    /// point signals are exported, and the rows of the CSV table are written
+    /// only by updateTrace. It must be called before createTrace, and the
+    /// export is not resumed by resumeTrace.
+    /// @param format the format of the columns.
+    void enableColumnarExport(ColumnFormat format = ColumnFormat::Npy)
+    {
+        columns = std::make_unique<detail::ColumnExporter>(filename, format);
+    }
+
+    /// @brief Counts the toggles of each bit of the integer and bit-vector signals.
+    /// @details Each time a value is written, it is XORed with the previous
+    /// one, and the counters of the bits which differ are incremented. When
+    /// the trace is closed, the toggles of each scope and the counters of each
+    /// bit are written to `<filename>.activity.json`, e.g., for estimating the
+    /// switching activity. The initial dump is not a toggle, and neither are
+    /// the changes recorded with recordChange. It must be called before
+    /// createTrace.
+    void enableToggleCounting() { count_toggles = true; }
+
+    /// @brief Returns the toggles counted so far, see enableToggleCounting.
+    /// @details The scopes are listed in the order of the trace, each one
+    /// followed by its subscopes, and their totals include the subscopes.
+    /// @return the activity of each scope, empty if not enabled.
+    auto activity() const -> std::vector<ScopeActivity>
+    {
+        std::vector<ScopeActivity> result;
+        // The toggles are counted once the trace has been created.
+        if (!count_toggles || toggles.empty()) {
+            return result;
+        }
+        std::vector<std::size_t> parents;
+        std::vector<std::tuple<const Scope *, std::string, std::size_t>> stack{
+            {root_scope, std::string(root_scope->name), 0U}};
+        while (!stack.empty()) {
+            auto [scope, path, parent] = std::move(stack.back());
+            stack.pop_back();
+            ScopeActivity current;
+            current.name = path;
+            for (const auto *trace : scope->traces) {
+                const std::size_t index = trace->getToggleIndex();
+                const std::size_t width = trace->getToggleWidth();
+                // The traces added after the creation of the trace have no toggles.
+                if ((width == 0) || (index + width > toggles.size())) {
+                    continue;
+                }
+                SignalActivity signal;
+                signal.name   = path + "." + trace->getName();
+                signal.symbol = trace->getSymbol();
+                const auto first = toggles.begin() + static_cast<std::ptrdiff_t>(index);
+                signal.bits.assign(first, first + static_cast<std::ptrdiff_t>(width));
+                for (const std::uint64_t count : signal.bits) {
+                    signal.toggles += count;
+                }
+                current.bits += signal.bits.size();
+                current.toggles += signal.toggles;
+                current.signals.emplace_back(std::move(signal));
+            }
+            parents.emplace_back(parent);
+            result.emplace_back(std::move(current));
+            for (auto it = scope->subscopes.rbegin(); it != scope->subscopes.rend(); ++it) {
+                stack.emplace_back(*it, path + "." + std::string((*it)->name), result.size() - 1U);
+            }
+        }
+        // The subscopes come after their parent, so their totals are complete when added to it.
+        for (std::size_t index = result.size() - 1U; index > 0; --index) {
+            result[parents[index]].bits += result[index].bits;
+            result[parents[index]].toggles += result[index].toggles;
+        }
+        return result;
+    }
+
+    /// @brief Disables the output of the trace, e.g., for a run which only collects the coverage.
+    /// @details The changes are still detected, and the toggle counters and
+    /// the summary statistics are still updated and written when the trace is
+    /// closed, but the values are neither formatted nor written, and the trace
+    /// file is not created. The parallel sampling and the deferred formatting,
+    /// which only speed up the formatting, are not used. It must be called
+    /// before createTrace.
+    void disableOutput()
+    {
+        output_enabled = false;
+        parallel_sampler.reset();
+        deferred_buffer.reset();
+    }
+
+    /// @brief Writes the buffered trace when the process receives a fatal signal.
+    /// @details On SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT, and on SIGTERM
+    /// and SIGINT unless the program handles them, the samples inside the
+    /// output buffer are appended to the trace file, which is then a valid VCD
+    /// truncated at the last complete sample; then the previous action of the
+    /// signal runs. Only async-signal-safe calls are used, so a compressed trace
+    /// gets a last, uncompressed, gzip member. The values recorded with
+    /// recordChange and not emitted yet, and those whose formatting is
+    /// deferred, are lost. Custom sinks must implement
+    /// TraceSink::emergencyWrite to take part.
+    void enableCrashFlush()
+    {
+#ifdef CPPTRACER_POSIX
+        if (!sink) {
+            sink = this->createFileSink();
+        }
+        if (!crash_flush) {
+            crash_flush = std::make_unique<detail::CrashFlush>(sink.get());
+            outbuffer.setTail(crash_flush->getTail());
+        }
+        this->updateBufferedBytes();
+#else
+        std::cerr << "Cannot flush the trace on the fatal signals on this platform.\n";
+#endif
+    }
+
+    /// @brief Sets a limit to the memory used by the tracer.
+    /// @details The budget covers the output buffer, the temporary copies made
+    /// while writing and compressing it, and the scopes and traces. It is
+    /// checked before writing each sample, and the policy is applied once it is
+    /// exhausted.
+    /// @param bytes the budget in bytes, zero to remove the limit.
+    /// @param policy what to do when the budget is exhausted.
+    void setMemoryBudget(std::size_t bytes, OverflowPolicy policy = OverflowPolicy::Flush)
+    {
+        memory_budget   = bytes;
+        overflow_policy = policy;
+        // The sampling rate is halved when half of the remaining budget is used.
+        decimation_threshold = this->memoryUsage();
+        decimation_threshold += (std::max(bytes, decimation_threshold) - decimation_threshold) / 2;
+    }
+
+    /// @brief Returns an estimate of the memory currently used by the tracer.
+    /// @return the number of bytes.
+    auto memoryUsage() const -> std::size_t
+    {
+        // The buffer is handed to the sink without copying it, compressing it requires another one.
+        return registry_bytes + deferred_bytes + reorder_buffer.getMemoryUsage() +
+               (columns ? columns->getMemoryUsage() : 0U) + buffered_bytes * (this->isCompressionEnabled() ? 2U : 1U);
+    }
+
+    /// @brief Returns the number of samples dropped because of the memory budget.
+    /// @return the number of dropped samples.
+    auto droppedSamples() const -> std::uint64_t { return dropped_samples; }
+
+    /// @brief Checks if the tracing has been stopped because of the memory budget.
+    /// @return true if the tracing has been stopped, false otherwise.
+    auto isStopped() const -> bool { return stopped; }
+
+    /// @brief Enables the sampling of the traces on several threads.
+    /// @details The traces are split into chunks, which are compared and
+    /// formatted in parallel, each one into its own buffer. The buffers are
+    /// concatenated in order, so that the trace is identical to the one
+    /// written by the serial sampling. It pays off only for designs with many
+    /// thousands of traces. The scopes and the traces must not be added after
+    /// the creation of the trace.
+    /// @param threads the number of threads, zero to use one per core, one to disable.
+    void enableParallelSampling(std::size_t threads = 0)
+    {
+        if (threads == 0) {
+            threads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        if ((threads == 1) || !output_enabled) {
+            parallel_sampler.reset();
+            return;
+        }
+        parallel_sampler = std::make_unique<detail::ParallelSampler>(threads);
+        parallel_sampler->build(root_scope);
+    }
+
+    /// @brief Postpones the formatting of the sampled values.
+    /// @details While sampling, only the raw bytes of the changed values are
+    /// stored, and they are turned into text when the trace is written to
+    /// file, or by a background thread. The trace is identical to the one
+    /// written without deferring the formatting. The traces must stay alive
+    /// until the trace is closed. It has no effect on the parallel sampling,
+    /// which already formats the values in parallel.
+    /// @param mode when the values are formatted.
+    void enableDeferredFormatting(DeferredFormatting mode = DeferredFormatting::OnFlush)
+    {
+        // Format the values stored so far, before changing mode.
+        this->renderDeferred();
+        if ((mode == DeferredFormatting::Off) || !output_enabled) {
+            deferred_buffer.reset();
+        } else {
+            deferred_buffer = std::make_unique<detail::DeferredBuffer>(mode == DeferredFormatting::Background);
+        }
+    }
+
+    /// @brief Returns the number of threads used for sampling.
+    /// @return the number of threads, one if the parallel sampling is disabled.
+    auto samplingThreads() const -> std::size_t
+    {
+        return parallel_sampler ? parallel_sampler->getThreads() : 1U;
+    }
+
+    /// @brief Makes the tracer write one shard of a trace, written by several processes.
+    /// @details The scopes are placed inside a scope named after the rank
+    /// (e.g., `rank3`), and the symbols start from `rank * shard_symbols`, so
+    /// that the shards can be merged by the `cpptracer_merge` tool, or by
+    /// merge_shards, without renaming anything. The symbols of the rank must
+    /// fit in a std::size_t, which allows only the ranks up to 3 when it has
+    /// 32 bits.
+    /// @param rank the rank of the process.
+    void enableSharding(std::size_t rank)
+    {
+        if (traces_cout != (shard_rank.value_or(0U) * shard_symbols)) {
+            throw std::runtime_error("The sharding must be enabled before adding the traces.");
+        }
+        if (rank >= std::numeric_limits<std::size_t>::max() / shard_symbols) {
+            throw std::runtime_error("The symbols of rank " + std::to_string(rank) + " do not fit in a std::size_t.");
+        }
+        shard_rank  = rank;
+        traces_cout = rank * shard_symbols;
+    }
+
+    /// @brief Enables the timers of the statistics, only if the statistics are enabled.
+    /// @details The timers read the clock a few times per sample, and are
+    /// disabled by default.
+    /// @param enable true to enable the timers, false to disable them.
+    void enableStatsTimers(bool enable = true)
+    {
+#ifdef ENABLE_STATS
+        stats_timers = enable;
+#else
+        (void)enable;
+#endif
+    }
+
+    /// @brief Returns the statistics about the work done by the tracer.
+    /// @return the statistics, all zeros if the library has been compiled without ENABLE_STATS.
+    auto stats() const -> TracerStats
+    {
+        TracerStats result;
+#ifdef ENABLE_STATS
+        result = statistics;
+        this->collectScopeChanges(root_scope, std::string(root_scope->name), result.scope_changes);
+#endif
+        return result;
+    }
+
     /// @brief Creates the trace.
     void createTrace()
     {
+        if (!output_enabled) {
+            this->prepareSampling();
+            return;
+        }
         // Write the header.
         outbuffer << "$date\n";
         outbuffer << "    " + utility::get_date_time() + "\n";
@@ -136,52 +755,176 @@ public:
         outbuffer << "    " << timescale.getTimeNumber() << timescale.getTimeUnit().toString() << "\n";
         outbuffer << "$end\n";
 
+        // The scopes of a shard are placed inside the scope of its rank.
+        if (shard_rank) {
+            outbuffer << "$scope module rank" << *shard_rank << " $end\n";
+        }
         root_scope->printScopeHeader(outbuffer);
+        if (shard_rank) {
+            outbuffer << "$upscope $end\n";
+        }
 
         outbuffer << "$enddefinitions $end\n";
+        this->updateBufferedBytes();
+
+        this->prepareSampling();
+    }
+
+    /// @brief Saves the state of the tracer, so that the trace can be resumed after a restart.
+    /// @details The recorded changes are emitted and the buffered part of the
+    /// trace is written to file. The checkpoint then stores the size of the
+    /// file, the sampling state, and the previous value of each trace, so that
+    /// resumeTrace can keep appending to the same file. Only the trace file
+    /// written by the tracer itself, compressed or not, can be resumed.
+    /// @param output the stream receiving the checkpoint, e.g., the one of the simulation.
+    void saveCheckpoint(std::ostream &output)
+    {
+        this->flushChanges();
+        if (!this->flushTrace()) {
+            throw std::runtime_error("Cannot write the trace file before the checkpoint.");
+        }
+        if (!trace_file) {
+            throw std::runtime_error(sink ? "Only the trace file written by the tracer can be checkpointed."
+                                          : "The trace must be created before saving a checkpoint.");
+        }
+        std::string state;
+        detail::append_raw(state, trace_file->getSize());
+        detail::append_raw(state, this->isCompressionEnabled());
+        detail::append_raw(state, next_sample);
+        detail::append_raw(state, first_dump);
+        detail::append_raw(state, decimation);
+        detail::append_raw(state, static_cast<std::uint64_t>(decimation_threshold));
+        detail::append_raw(state, dropped_samples);
+        detail::append_raw(state, pending_drops);
+        detail::append_raw(state, stopped);
+        detail::append_raw(state, latest_change);
+        detail::append_raw(state, emitted_time);
+        detail::append_raw(state, changes_emitted);
+        detail::append_raw(state, late_changes);
+        this->saveScopeState(root_scope, state);
+        detail::append_raw(state, static_cast<std::uint64_t>(summaries.size()));
+        for (const auto &accumulator : summaries) {
+            detail::append_raw(state, accumulator);
+        }
+        detail::append_raw(state, value_time);
+        detail::append_raw(state, static_cast<std::uint64_t>(toggles.size()));
+        for (const std::uint64_t count : toggles) {
+            detail::append_raw(state, count);
+        }
+        // The size comes first, so the checkpoint can be embedded inside other data.
+        std::string header(checkpoint_magic);
+        detail::append_raw(header, static_cast<std::uint64_t>(state.size()));
+        output.write(header.data(), static_cast<std::streamsize>(header.size()));
+        output.write(state.data(), static_cast<std::streamsize>(state.size()));
+        if (!output) {
+            throw std::runtime_error("Cannot write the checkpoint.");
+        }
+    }
+
+    /// @brief Resumes the trace from a checkpoint, instead of creating it.
+    /// @details The scopes and the traces must be added exactly as they were
+    /// when the checkpoint was saved, and so must be the compression. The
+    /// trace file is cut where the checkpoint was saved, discarding what was
+    /// written afterwards, and the following samples are appended to it
+    /// without writing the header again.
+    /// @param input the stream providing the checkpoint.
+    void resumeTrace(std::istream &input)
+    {
+        if (sink || (outbuffer.size() > 0)) {
+            throw std::runtime_error("The trace has already been created.");
+        }
+        if (columns) {
+            throw std::runtime_error("The columnar export cannot be resumed from a checkpoint.");
+        }
+        std::string header(checkpoint_magic.size() + sizeof(std::uint64_t), '\0');
+        input.read(header.data(), static_cast<std::streamsize>(header.size()));
+        if (!input || (std::string_view(header).substr(0, checkpoint_magic.size()) != checkpoint_magic)) {
+            throw std::runtime_error("The stream does not contain a checkpoint of the tracer.");
+        }
+        const char *raw  = header.data() + checkpoint_magic.size();
+        const auto size  = detail::read_raw<std::uint64_t>(raw);
+        std::string state(static_cast<std::size_t>(size), '\0');
+        input.read(state.data(), static_cast<std::streamsize>(state.size()));
+        if (!input) {
+            throw std::runtime_error("The checkpoint is truncated.");
+        }
+        detail::RawReader reader(state);
+        std::uint64_t offset = 0;
+        bool compressed      = false;
+        std::uint64_t threshold = 0;
+        reader.read(offset);
+        reader.read(compressed);
+        if (compressed != this->isCompressionEnabled()) {
+            throw std::runtime_error("The compression does not match the one of the checkpoint.");
+        }
+        reader.read(next_sample);
+        reader.read(first_dump);
+        reader.read(decimation);
+        reader.read(threshold);
+        reader.read(dropped_samples);
+        reader.read(pending_drops);
+        reader.read(stopped);
+        reader.read(latest_change);
+        reader.read(emitted_time);
+        reader.read(changes_emitted);
+        reader.read(late_changes);
+        decimation_threshold = static_cast<std::size_t>(threshold);
+        this->loadScopeState(root_scope, reader);
+        std::uint64_t count = 0;
+        reader.read(count);
+        std::vector<detail::SummaryAccumulator> accumulators(static_cast<std::size_t>(count));
+        for (auto &accumulator : accumulators) {
+            reader.read(accumulator);
+        }
+        reader.read(value_time);
+        reader.read(count);
+        std::vector<std::uint64_t> counters(static_cast<std::size_t>(count));
+        for (auto &counter : counters) {
+            reader.read(counter);
+        }
+        if (!reader.empty()) {
+            throw std::runtime_error("The checkpoint does not match the traces of the tracer.");
+        }
+        sink = this->createFileSink(offset);
+
+        this->prepareSampling();
+        if (accumulators.size() != summaries.size()) {
+            throw std::runtime_error("The summary does not match the one of the checkpoint.");
+        }
+        if (counters.size() != toggles.size()) {
+            throw std::runtime_error("The toggle counters do not match the ones of the checkpoint.");
+        }
+        summaries.swap(accumulators);
+        toggles.swap(counters);
     }
 
     /// @brief Adds a new scope, as a sibling of the current scope.
     /// @param scope_name the name of the new scope.
-    void addScope(std::string scope_name)
+    void addScope(std::string_view scope_name)
     {
         if (!current_scope) {
             throw std::runtime_error("There is no current scope.");
         }
-        // Lock the weak_ptr to get a shared_ptr to the parent.
-        auto parent = current_scope->parent.lock();
+        // Get the parent of the current scope.
+        auto parent = current_scope->parent;
         if (!parent) {
             throw std::runtime_error("Current scope has no parent.");
         }
 
-        // Create the new scope.
-        auto new_scope    = std::make_shared<Scope>(std::move(scope_name));
-        // Set the parent of the new scope.
-        new_scope->parent = parent;
-        // Add the new scope to the parent.
-        parent->subscopes.emplace_back(new_scope);
-
-        // Set the current scope.
-        current_scope = new_scope;
+        // Set the new scope as current scope.
+        current_scope = this->createScope(parent, scope_name);
     }
 
     /// @brief Adds a new scope, as a child of the current scope.
     /// @param scope_name the name of the new scope.
-    void addSubScope(std::string scope_name)
+    void addSubScope(std::string_view scope_name)
     {
         if (!current_scope) {
             throw std::runtime_error("There is no current scope.");
         }
 
-        // Create the new scope.
-        auto new_scope    = std::make_shared<Scope>(std::move(scope_name));
-        // Set the parent of the new scope.
-        new_scope->parent = current_scope;
-        // Add the new scope to the parent.
-        current_scope->subscopes.emplace_back(new_scope);
-
-        // Set the current scope.
-        current_scope = new_scope;
+        // Set the new scope as current scope.
+        current_scope = this->createScope(current_scope, scope_name);
     }
 
     /// @brief Closes the current scope.
@@ -191,8 +934,8 @@ public:
             throw std::runtime_error("There is no current scope.");
         }
 
-        // Lock the weak_ptr to get a shared_ptr to the parent.
-        auto parent = current_scope->parent.lock();
+        // Get the parent of the current scope.
+        auto parent = current_scope->parent;
         if (!parent) {
             throw std::runtime_error("Current scope has no parent.");
         }
@@ -201,29 +944,199 @@ public:
         current_scope = parent;
     }
 
+    /// @brief Mutes the scope at the given path, together with all its subscopes.
+    /// @details Muted scopes are skipped entirely while sampling, both by the
+    /// change detection and by the emission of the values. The traces aliased
+    /// by a scope which is not muted are still written.
+    /// @param path the dot-separated path of the scope, starting from the root
+    /// (e.g., "root.SCOPE1.SUBSCOPE1").
+    void muteScope(std::string_view path)
+    {
+        this->findScope(path)->muted = true;
+        if (!alias_groups.empty()) {
+            this->adoptAliases();
+        }
+    }
+
+    /// @brief Unmutes the scope at the given path.
+    /// @details If the tracing has already started, the current value of every
+    /// trace below the scope is dumped at the next sample, so that the
+    /// waveform is consistent from that point onward. Subscopes which have been
+    /// muted explicitly stay muted.
+    /// @param path the dot-separated path of the scope, starting from the root.
+    void unmuteScope(std::string_view path)
+    {
+        auto scope = this->findScope(path);
+        if (scope->muted) {
+            scope->muted        = false;
+            scope->dump_pending = !first_dump;
+            if (!alias_groups.empty()) {
+                this->adoptAliases();
+            }
+        }
+    }
+
+    /// @brief Checks if the scope at the given path is muted.
+    /// @param path the dot-separated path of the scope, starting from the root.
+    /// @return true if the scope is muted, false otherwise.
+    auto isScopeMuted(std::string_view path) const -> bool { return this->findScope(path)->muted; }
+
+    /// @brief Sets the filter of the floating point traces below the scope at the given path.
+    /// @details The filter decides when a value has changed enough to be
+    /// written (see ChangeFilter), and applies to the traces of the scope and
+    /// of its subscopes, including the elements of the array traces, unless a
+    /// subscope has its own filter, or a trace has been given one with
+    /// TraceWrapper::setFilter. The StaticTracer has no scopes, and its
+    /// signals always use the tolerance of is_equal.
+    /// @param path the dot-separated path of the scope, starting from the root.
+    /// @param filter the filter.
+    void setScopeFilter(std::string_view path, const ChangeFilter &filter)
+    {
+        auto scope    = this->findScope(path);
+        scope->filter = filter;
+        // Traces added later receive it when the trace is created.
+        this->applyScopeFilters(scope);
+    }
+
     /// @brief Add a variable to the list of traces.
+    /// @details If the name is a dot-separated path starting from the root
+    /// (e.g., "root.core3.alu.result"), the trace is added to the scope at
+    /// that path, which is created if missing, and the current scope is left
+    /// unchanged. Otherwise, the trace is added to the current scope.
+    /// If the variable is already traced with the same type (e.g., a bus seen
+    /// from several scopes), the new trace is an alias: it shares the symbol of
+    /// the existing one, so that its value is compared and written only once.
+    /// Besides the built-in types, the variables of the types described by
+    /// trace_traits (e.g., enumerations) can be traced.
     /// @tparam T the type of the variable.
     /// @param variable the variable which has to be traced.
-    /// @param name the name of the trace.
-    /// @return a pointer to the trace handler.
+    /// @param name the name of the trace, or its path.
+    /// @return a pointer to the trace handler, shared by the aliases, valid as long as the tracer.
     template <typename T>
-    auto addTrace(const T &variable, std::string name) -> std::shared_ptr<TraceWrapper<T>>
+    auto addTrace(const T &variable, std::string_view name) -> TraceWrapper<T> *
     {
-        if (current_scope == nullptr) {
-            throw std::runtime_error("There is no current scope.");
+        auto scope = this->getTargetScope(name);
+        const detail::TraceKey key{&variable, typeid(T), 0U};
+        if (auto *target = this->addAlias(key, scope, name)) {
+            return static_cast<TraceWrapper<T> *>(target);
+        }
+        auto trace = arena.createUnmanaged<TraceWrapper<T>>(arena.intern(name), std::to_string(traces_cout), &variable);
+        scope->traces.emplace_back(trace);
+        trace_index.emplace(key, TracedVariable{trace, scope, npos});
+        ++traces_cout;
+        return trace;
+    }
+
+    /// @brief Add a packed bit-vector to the list of traces.
+    /// @details Like addTrace, the bit-vector is an alias if it is already traced with the same width.
+    /// @tparam W the number of words of the bit-vector.
+    /// @param variable the variable which has to be traced, the first word holds the least significant bits.
+    /// @param name the name of the trace, or its path (see addTrace).
+    /// @param width the number of traced bits.
+    /// @return a pointer to the trace handler, valid as long as the tracer.
+    template <std::size_t W>
+    auto addTrace(const std::array<std::uint64_t, W> &variable, std::string_view name, std::size_t width)
+        -> TraceWrapper<std::array<std::uint64_t, W>> *
+    {
+        auto scope = this->getTargetScope(name);
+        const detail::TraceKey key{&variable, typeid(variable), width};
+        if (auto *target = this->addAlias(key, scope, name)) {
+            return static_cast<TraceWrapper<std::array<std::uint64_t, W>> *>(target);
         }
-        auto trace = std::make_shared<TraceWrapper<T>>(std::move(name), std::to_string(traces_cout), &variable);
-        current_scope->traces.emplace_back(trace);
+        auto trace = arena.createUnmanaged<TraceWrapper<std::array<std::uint64_t, W>>>(
+            arena.intern(name), std::to_string(traces_cout), &variable, width);
+        scope->traces.emplace_back(trace);
+        trace_index.emplace(key, TracedVariable{trace, scope, npos});
         ++traces_cout;
         return trace;
     }
 
+    /// @brief Add a contiguous array of values to the list of traces.
+    /// @details Each element is traced as a separate signal, named
+    /// `name[index]`. Elements are compared bitwise against a contiguous
+    /// shadow copy, and only the ones which changed are written.
+    /// @tparam T the type of the elements.
+    /// @param data pointer to the first element.
+    /// @param size the number of elements.
+    /// @param name the name of the trace, or its path (see addTrace).
+    /// @return a pointer to the trace handler, valid as long as the tracer.
+    template <typename T>
+    auto addArrayTrace(const T *data, std::size_t size, std::string_view name) -> ArrayTrace<T> *
+    {
+        auto scope = this->getTargetScope(name);
+        auto trace = arena.createUnmanaged<ArrayTrace<T>>(arena.intern(name), traces_cout, data, size);
+        scope->traces.emplace_back(trace);
+        traces_cout += size;
+        return trace;
+    }
+
+    /// @brief Add a struct to the list of traces, inside a new subscope.
+    /// @details The members are traced inside a subscope of the current scope,
+    /// named after the struct. While sampling, the whole struct is compared
+    /// against a snapshot with a single memcmp, and the members are inspected
+    /// only when its bytes have changed.
+    /// @tparam S the type of the struct.
+    /// @tparam Members the types of the traced members.
+    /// @param variable the struct which has to be traced.
+    /// @param name the name of the struct, used for the subscope.
+    /// @param members the traced members, see CPPTRACER_MEMBER.
+    /// @return a pointer to the new subscope, valid as long as the tracer.
+    template <typename S, typename... Members>
+    auto addStructTrace(const S &variable, std::string_view name, StructMember<S, Members>... members) -> Scope *
+    {
+        static_assert(std::is_trivially_copyable<S>::value, "Only trivially copyable structs can be traced.");
+        auto parent = current_scope;
+        this->addSubScope(name);
+        auto scope = current_scope;
+        (this->addTrace(variable.*(members.member), members.name), ...);
+        scope->setSnapshot(&variable, sizeof(S));
+        current_scope = parent;
+        return scope;
+    }
+
     /// @brief Updates the trace file with the current variable values.
     /// @param t The time at which the traces have been updated.
     void updateTrace(const double &t)
     {
+        if (stopped) {
+            CPPTRACER_STATS(++statistics.samples_skipped;)
+            return;
+        }
+        if (parallel_sampler) {
+            this->updateTraceParallel(t);
+            return;
+        }
+        // Check if some value has changed.
+        bool has_changed;
+        {
+            CPPTRACER_STATS(detail::StatsTimer timer(stats_timers, statistics.detection_time);)
+            has_changed = this->changed();
+        }
         // Write time.
-        if ((!this->changed()) || (next_sample > t)) {
+        if ((!has_changed) || (next_sample > t)) {
+            CPPTRACER_STATS(++statistics.samples_skipped;)
+            return;
+        }
+        // Apply the overflow policy, if the memory budget is exhausted.
+        if (!this->checkMemoryBudget()) {
+            return;
+        }
+        // Write and sync the previous samples, if the periodic durability is due.
+        this->applyDurability();
+        CPPTRACER_STATS(++statistics.samples_taken;)
+        CPPTRACER_STATS(detail::StatsTimer timer(stats_timers, statistics.formatting_time);)
+        value_time = this->getScaledTime<std::uint64_t>(t);
+        if (!output_enabled) {
+            // Only update the previous values, together with the summaries, the toggles and the columns.
+            this->updateTraces(root_scope, first_dump);
+            first_dump = false;
+            this->addColumnRow();
+            next_sample += sampling.getValue() * decimation;
+            return;
+        }
+        if (deferred_buffer) {
+            this->captureSample(t);
+            this->addColumnRow();
             return;
         }
         // Dump variables.
@@ -233,66 +1146,107 @@ public:
             outbuffer << '#' << this->getScaledTime<unsigned long>(t) << "\n";
         }
         // Write the values.
-        this->updateTraceRecursive(root_scope);
+        this->updateTraces(root_scope, first_dump);
         // Write the closure.
         if (first_dump) {
             outbuffer << "$end\n";
             first_dump = false;
         }
+        this->addColumnRow();
+        this->updateBufferedBytes();
         // Set the time of the next sample.
-        next_sample += sampling.getValue();
+        next_sample += sampling.getValue() * decimation;
     }
 
+    /// @brief Sets how late a change can be recorded, w.r.t. the latest recorded one.
+    /// @details Recorded changes are held until the latest recorded time is
+    /// past their own by more than the window, and then emitted in time order.
+    /// @param window the lateness window, in the same unit of the times.
+    void setLatenessWindow(double window) { lateness_window = this->getScaledTime<std::uint64_t>(window); }
+
+    /// @brief Records the change of a trace at the given time, without sampling the other traces.
+    /// @details Changes can arrive out of order, within the lateness window,
+    /// and are emitted in time order, so that the cost depends on the number
+    /// of changes instead of on the number of traces. A change arriving after
+    /// its time has been emitted is moved to the last emitted time, and
+    /// counted by lateChanges(). The traced variable is not read, and the
+    /// first change is preceded by the dump of all the traces.
+    /// @tparam T the type of the trace.
+    /// @param handle the trace, as returned by addTrace.
+    /// @param value the new value.
+    /// @param time the time of the change.
+    template <typename T>
+    void recordChange(TraceWrapper<T> *handle, const T &value, double time)
+    {
+        static_assert(detail::has_raw_values<T>::value, "Changes can be recorded only for scalar and packed traces.");
+        if (stopped) {
+            CPPTRACER_STATS(++statistics.samples_skipped;)
+            return;
+        }
+        auto scaled = this->getScaledTime<std::uint64_t>(time);
+        if (changes_emitted && (scaled < emitted_time)) {
+            scaled = emitted_time;
+            ++late_changes;
+        }
+        if constexpr (detail::has_trace_traits<T>::value) {
+            // The user-defined types store their raw value, like their traces.
+            reorder_buffer.push(scaled, handle, trace_traits<T>::raw(value));
+        } else {
+            reorder_buffer.push(scaled, handle, value);
+        }
+        latest_change = std::max(latest_change, scaled);
+        if (latest_change >= lateness_window) {
+            this->emitChanges(latest_change - lateness_window);
+        }
+    }
+
+    /// @brief Emits all the recorded changes, regardless of the lateness window.
+    void flushChanges() { this->emitChanges(std::numeric_limits<std::uint64_t>::max()); }
+
+    /// @brief Returns the number of changes recorded after their time had already been emitted.
+    /// @return the number of late changes.
+    auto lateChanges() const -> std::uint64_t { return late_changes; }
+
     /// @brief Checks if some value has changed.
     /// @return true if at least one value has changed, false otherwise.
-    auto changed() const -> bool { return this->changedRecursive(root_scope); }
+    auto changed() const -> bool { return this->changedBelow(root_scope); }
 
-    /// @brief Closes the trace file.
+    /// @brief Closes the trace file, and writes the reports next to it.
+    /// @details The trace is closed only once, the following calls (e.g., by
+    /// the destructor) do nothing and return the result of the first one.
     /// @return true on success, false otherwise.
     auto closeTrace() -> bool
     {
-        if (outbuffer.str().empty()) {
-            return true;
+        if (closed) {
+            return *closed;
         }
-        // The output file.
-        std::ofstream outfile;
-        if (cpptracer::Tracer::isCompressionEnabled()) {
-            outfile.open(filename + ".gz", std::ios_base::trunc);
-        } else {
-            outfile.open(filename, std::ios_base::trunc);
+        this->flushChanges();
+        bool success = this->writeBuffer(true);
+        if ((durability != Durability::None) && (unsynced_bytes > 0)) {
+            success = this->syncTrace() && success;
         }
-        if (!outfile.is_open()) {
-            std::cerr << "Failed to open the trace file'" << filename << "'\n";
-            return false;
+        // The reports are written next to the trace, so only by a tracer which has one.
+        const bool reports = sink || !filename.empty();
+        if (summary_format && reports) {
+            success = this->writeSummary() && success;
         }
-        if (cpptracer::Tracer::isCompressionEnabled()) {
-#ifdef ENABLE_COMPRESSION
-            // Log the compression start.
-            std::cout << KYEL << "Compressing traces..." << KRST << "\n";
-            // Save the original trace and the compressed trace.
-            std::string trace      = outbuffer.str();
-            std::string compressed = compression::compress(trace);
-            // Write the trace to file.
-            outfile << compressed;
-            // Compute the saved space.
-            auto saved = 100.0;
-            saved -= utility::get_percent(compressed.capacity(), trace.capacity());
-            // Log the compression statistics.
-            std::cout << KYEL << "Compression completed " << KRST << "\n"
-                      << std::setprecision(2) << "Original size   = " << trace.capacity() << " bytes\n"
-                      << "Compressed size = " << compressed.capacity() << " bytes\n"
-                      << "Saved space = " << saved << "%\n";
-#endif
-        } else {
-            outfile << outbuffer.str();
+        if (count_toggles && reports) {
+            success = this->writeActivity() && success;
         }
-        // Close the output file.
-        outfile.close();
-        // Clear the output buffer.
-        outbuffer.str("");
-        return true;
+        if (columns) {
+            success = columns->close() && success;
+        }
+        closed = success && (!sink || sink->close());
+        return *closed;
     }
 
+    /// @brief Writes the buffered part of the trace to file, and empties the buffer.
+    /// @details The first write truncates the file, the following ones append
+    /// to it. When the compression is enabled, each write appends a new gzip
+    /// member, and their concatenation is still a valid gzip file.
+    /// @return true on success, false otherwise.
+    auto flushTrace() -> bool { return this->writeBuffer(false); }
+
     /// @brief Sets the version text to display in $version section
     /// @param _version_text the version text.
     void setVersionText(std::string _version_text) { version_text = std::move(_version_text); }
@@ -304,7 +1258,7 @@ public:
 private:
     /// @brief Checks if the compression is enabled.
     /// @return true if the compression is enabled, false otherwise.
-    static auto isCompressionEnabled() -> bool
+    auto isCompressionEnabled() const -> bool
     {
 #ifdef ENABLE_COMPRESSION
         return compress_traces;
@@ -313,6 +1267,572 @@ private:
 #endif
     }
 
+    /// @brief Creates the sink which writes the trace file, compressed if the compression is enabled.
+    /// @param keep the number of bytes of the existing file which are kept, zero to truncate it.
+    /// @return the sink.
+    auto createFileSink(std::uint64_t keep = 0) -> std::unique_ptr<TraceSink>
+    {
+#ifdef ENABLE_COMPRESSION
+        if (compress_traces) {
+            auto file        = std::make_unique<FileSink>(filename + ".gz", keep);
+            trace_file       = file.get();
+            auto compressing = std::make_unique<CompressingSink>(std::move(file));
+            compressor       = compressing.get();
+            return compressing;
+        }
+#endif
+        auto file  = std::make_unique<FileSink>(filename, keep);
+        trace_file = file.get();
+        return file;
+    }
+
+    /// @brief Prepares the sampling, once the scopes and the traces are not changed anymore.
+    void prepareSampling()
+    {
+        this->applyScopeFilters(root_scope);
+        this->adoptAliases();
+        if (summary_format) {
+            // Place the summaries of the signals of each trace next to each other.
+            std::size_t count = 0;
+            std::vector<Scope *> stack{root_scope};
+            while (!stack.empty()) {
+                Scope *scope = stack.back();
+                stack.pop_back();
+                for (auto *trace : scope->traces) {
+                    trace->setSummaryIndex(count);
+                    count += trace->getSignalCount();
+                }
+                stack.insert(stack.end(), scope->subscopes.begin(), scope->subscopes.end());
+            }
+            summaries.assign(count, detail::SummaryAccumulator());
+        }
+        if (count_toggles) {
+            // Place the counters of the bits of each trace next to each other.
+            std::size_t count = 0;
+            std::vector<Scope *> stack{root_scope};
+            while (!stack.empty()) {
+                Scope *scope = stack.back();
+                stack.pop_back();
+                for (auto *trace : scope->traces) {
+                    trace->setToggleIndex(count);
+                    count += trace->getToggleWidth();
+                }
+                stack.insert(stack.end(), scope->subscopes.begin(), scope->subscopes.end());
+            }
+            toggles.assign(count, 0U);
+        }
+        if (columns) {
+            // The columns follow the order of the trace.
+            std::vector<std::pair<Scope *, std::string>> stack{{root_scope, std::string(root_scope->name)}};
+            while (!stack.empty()) {
+                auto current = std::move(stack.back());
+                stack.pop_back();
+                for (auto *trace : current.first->traces) {
+                    trace->setColumnIndex(columns->addColumn(trace, current.second + "." + trace->getName()));
+                }
+                for (auto it = current.first->subscopes.rbegin(); it != current.first->subscopes.rend(); ++it) {
+                    stack.emplace_back(*it, current.second + "." + std::string((*it)->name));
+                }
+            }
+            if (!columns->open()) {
+                throw std::runtime_error("Cannot create the column files of '" + filename + "'.");
+            }
+        }
+        registry_bytes = arena.getMemoryUsage() + this->getRegistryBytes(root_scope) +
+                         summaries.capacity() * sizeof(detail::SummaryAccumulator) +
+                         toggles.capacity() * sizeof(std::uint64_t);
+    }
+
+    /// @brief Writes the summary statistics of the signals next to the trace file.
+    /// @return true on success, false otherwise.
+    auto writeSummary() const -> bool
+    {
+        const bool json = (*summary_format == SummaryFormat::Json);
+        const std::string name = filename + (json ? ".summary.json" : ".summary.csv");
+        std::ofstream output(name);
+        if (!output.is_open()) {
+            std::cerr << "Failed to open the summary file '" << name << "'\n";
+            return false;
+        }
+        std::ostringstream scale;
+        scale << timescale.getTimeNumber() << timescale.getTimeUnit().toString();
+        detail::write_summary(output, this->summary(), *summary_format, scale.str(), value_time);
+        return static_cast<bool>(output);
+    }
+
+    /// @brief Writes the toggles of the scopes and of the bits of their signals next to the trace file.
+    /// @return true on success, false otherwise.
+    auto writeActivity() const -> bool
+    {
+        const std::string name = filename + ".activity.json";
+        std::ofstream output(name);
+        if (!output.is_open()) {
+            std::cerr << "Failed to open the activity file '" << name << "'\n";
+            return false;
+        }
+        detail::write_activity(output, this->activity());
+        return static_cast<bool>(output);
+    }
+
+    /// @brief Appends the state of the scope, its traces, and its subscopes to a checkpoint.
+    /// @param scope the scope.
+    /// @param buffer the checkpoint.
+    void saveScopeState(const Scope *scope, std::string &buffer) const
+    {
+        detail::append_string(buffer, scope->name);
+        detail::append_raw(buffer, scope->dump_pending);
+        detail::append_string(
+            buffer, std::string_view(reinterpret_cast<const char *>(scope->snapshot.data()), scope->snapshot.size()));
+        detail::append_raw(buffer, static_cast<std::uint64_t>(scope->traces.size()));
+        for (const auto *trace : scope->traces) {
+            detail::append_string(buffer, trace->getSymbol());
+            trace->saveState(buffer);
+        }
+        detail::append_raw(buffer, static_cast<std::uint64_t>(scope->subscopes.size()));
+        for (const auto *subscope : scope->subscopes) {
+            this->saveScopeState(subscope, buffer);
+        }
+    }
+
+    /// @brief Restores the state stored by saveScopeState, checking that the traces match.
+    /// @param scope the scope.
+    /// @param reader the reader of the checkpoint.
+    void loadScopeState(Scope *scope, detail::RawReader &reader)
+    {
+        const auto mismatch = [&scope]() {
+            return std::runtime_error("The checkpoint does not match the traces of scope '" +
+                                      std::string(scope->name) + "'.");
+        };
+        std::uint64_t count = 0;
+        if (reader.readString() != scope->name) {
+            throw mismatch();
+        }
+        reader.read(scope->dump_pending);
+        const std::string_view snapshot = reader.readString();
+        if (snapshot.size() != scope->snapshot.size()) {
+            throw mismatch();
+        }
+        std::copy(snapshot.begin(), snapshot.end(), reinterpret_cast<char *>(scope->snapshot.data()));
+        reader.read(count);
+        if (count != scope->traces.size()) {
+            throw mismatch();
+        }
+        for (auto *trace : scope->traces) {
+            if (reader.readString() != trace->getSymbol()) {
+                throw mismatch();
+            }
+            trace->loadState(reader);
+        }
+        reader.read(count);
+        if (count != scope->subscopes.size()) {
+            throw mismatch();
+        }
+        for (auto *subscope : scope->subscopes) {
+            this->loadScopeState(subscope, reader);
+        }
+    }
+
+    /// @brief Hands the buffered part of the trace to the sink, and empties the buffer.
+    /// @param verbose if true, the compression statistics are logged.
+    /// @return true on success, false otherwise.
+    auto writeBuffer(bool verbose) -> bool
+    {
+        this->renderDeferred();
+        if (outbuffer.size() == 0) {
+            return true;
+        }
+        if (!sink) {
+            sink = this->createFileSink();
+        }
+#ifdef ENABLE_COMPRESSION
+        // Log the compression start.
+        if (verbose && compressor) {
+            std::cout << ansi::fg::yellow << "Compressing traces..." << ansi::util::reset << "\n";
+        }
+        const std::uint64_t input_bytes  = compressor ? compressor->getInputBytes() : 0U;
+        const std::uint64_t output_bytes = compressor ? compressor->getOutputBytes() : 0U;
+        const auto compression_time      = compressor ? compressor->getCompressionTime() : std::chrono::nanoseconds();
+#else
+        (void)verbose;
+#endif
+        // Hand the buffer to the sink, and reuse the storage it leaves.
+        outbuffer.take(sink_buffer);
+        const std::size_t written = sink_buffer.size();
+        bool success;
+        {
+            CPPTRACER_STATS(detail::StatsTimer timer(stats_timers, statistics.io_time);)
+            success = sink->write(sink_buffer);
+        }
+        sink_buffer.clear();
+        buffered_bytes = 0;
+        this->commitCrashTail();
+        unsynced_bytes += written;
+        if (durability == Durability::EveryFlush) {
+            success = this->syncTrace() && success;
+        }
+#ifdef ENABLE_COMPRESSION
+        if (compressor) {
+            const std::uint64_t original = compressor->getInputBytes() - input_bytes;
+            const std::uint64_t reduced  = compressor->getOutputBytes() - output_bytes;
+#ifdef ENABLE_STATS
+            // The compression happens inside the sink, its time is not part of the writing.
+            statistics.compressed_bytes += reduced;
+            if (stats_timers) {
+                const auto elapsed = compressor->getCompressionTime() - compression_time;
+                statistics.compression_time += elapsed;
+                statistics.io_time -= elapsed;
+            }
+#else
+            (void)compression_time;
+#endif
+            // Log the compression statistics.
+            if (verbose) {
+                // Compute the saved space.
+                auto saved = 100.0;
+                saved -= utility::get_percent(reduced, original);
+                std::cout << ansi::fg::yellow << "Compression completed " << ansi::util::reset << "\n"
+                          << std::setprecision(2) << "Original size   = " << original << " bytes\n"
+                          << "Compressed size = " << reduced << " bytes\n"
+                          << "Saved space = " << saved << "%\n";
+            }
+        }
+#endif
+        return success;
+    }
+
+    /// @brief Updates the trace file with the current variable values, using the parallel sampling.
+    /// @details Follows the same steps of updateTrace, but the values are
+    /// formatted together with the change detection, and the previous values
+    /// are updated only once the sample is actually written.
+    /// @param t The time at which the traces have been updated.
+    void updateTraceParallel(const double &t)
+    {
+        // The sampling time is checked first, to avoid formatting skipped samples.
+        if (next_sample > t) {
+            CPPTRACER_STATS(++statistics.samples_skipped;)
+            return;
+        }
+        bool has_changed;
+        {
+            CPPTRACER_STATS(detail::StatsTimer timer(stats_timers, statistics.detection_time);)
+            has_changed = parallel_sampler->sample(first_dump);
+        }
+        if (!has_changed) {
+            CPPTRACER_STATS(++statistics.samples_skipped;)
+            return;
+        }
+        // Apply the overflow policy, if the memory budget is exhausted.
+        if (!this->checkMemoryBudget()) {
+            return;
+        }
+        // Write and sync the previous samples, if the periodic durability is due.
+        this->applyDurability();
+        CPPTRACER_STATS(++statistics.samples_taken;)
+        CPPTRACER_STATS(detail::StatsTimer timer(stats_timers, statistics.formatting_time);)
+        // Dump variables.
+        if (first_dump) {
+            outbuffer << "$dumpvars\n";
+        } else {
+            outbuffer << '#' << this->getScaledTime<unsigned long>(t) << "\n";
+        }
+        // Write the values, and update the previous ones.
+        parallel_sampler->write(outbuffer);
+        value_time = this->getScaledTime<std::uint64_t>(t);
+        if (!summaries.empty()) {
+            parallel_sampler->forEachWritten([this](const Trace *trace) {
+                trace->summarize(&summaries[trace->getSummaryIndex()], value_time);
+            });
+        }
+        if (columns) {
+            parallel_sampler->forEachWritten([this](const Trace *trace) {
+                columns->addChange(trace->getColumnIndex(), value_time, nullptr);
+            });
+        }
+        if (!toggles.empty() && !first_dump) {
+            parallel_sampler->forEachWritten([this](const Trace *trace) {
+                const std::uint64_t toggled = trace->countToggles(toggles.data() + trace->getToggleIndex());
+                CPPTRACER_STATS(statistics.toggles += toggled;)
+                (void)toggled;
+            });
+        }
+        const std::uint64_t values = parallel_sampler->commit();
+        CPPTRACER_STATS(statistics.values_emitted += values;)
+        (void)values;
+        // Write the closure.
+        if (first_dump) {
+            outbuffer << "$end\n";
+            first_dump = false;
+        }
+        this->addColumnRow();
+        this->updateBufferedBytes();
+        // Set the time of the next sample.
+        next_sample += sampling.getValue() * decimation;
+    }
+
+    /// @brief Stores the raw values of a sample, to be formatted later.
+    /// @param t The time at which the traces have been updated.
+    void captureSample(const double &t)
+    {
+        if (first_dump) {
+            deferred_buffer->beginDump();
+        } else {
+            deferred_buffer->beginSample(this->getScaledTime<unsigned long>(t));
+        }
+        this->updateTraces(root_scope, first_dump);
+        if (first_dump) {
+            deferred_buffer->endDump();
+            first_dump = false;
+        }
+        deferred_buffer->endSample();
+        // Move the text already formatted by the background thread to the output buffer.
+        deferred_buffer->collect(outbuffer);
+        this->updateBufferedBytes();
+        deferred_bytes = deferred_buffer->size();
+        // Set the time of the next sample.
+        next_sample += sampling.getValue() * decimation;
+    }
+
+    /// @brief Emits the recorded changes up to the given time, in time order.
+    /// @param limit the latest scaled time which is emitted.
+    void emitChanges(std::uint64_t limit)
+    {
+        if (reorder_buffer.empty()) {
+            return;
+        }
+        // Apply the overflow policy, if the memory budget is exhausted.
+        if (!this->checkMemoryBudget()) {
+            std::uint64_t dropped = 0;
+            reorder_buffer.pop(limit, [&dropped](std::uint64_t, const Trace *, const char *, std::size_t) {
+                ++dropped;
+            });
+            CPPTRACER_STATS(statistics.changes_dropped += dropped;)
+            (void)dropped;
+            return;
+        }
+        // Write and sync the previous changes, if the periodic durability is due.
+        this->applyDurability();
+        CPPTRACER_STATS(detail::StatsTimer timer(stats_timers, statistics.formatting_time);)
+        // The first change is preceded by the dump of all the traces.
+        if (first_dump) {
+            value_time = reorder_buffer.earliest();
+            if (!output_enabled) {
+                this->updateTraces(root_scope, true);
+            } else if (deferred_buffer) {
+                deferred_buffer->beginDump();
+                this->updateTraces(root_scope, true);
+                deferred_buffer->endDump();
+            } else {
+                outbuffer << "$dumpvars\n";
+                this->updateTraces(root_scope, true);
+                outbuffer << "$end\n";
+            }
+            first_dump = false;
+        }
+        std::string text;
+        reorder_buffer.pop(limit, [&](std::uint64_t time, const Trace *trace, const char *raw, std::size_t size) {
+            // Write the time only when it changes.
+            if (!changes_emitted || (time != emitted_time)) {
+                if (!output_enabled) {
+                    // Only the summaries are updated.
+                } else if (deferred_buffer) {
+                    deferred_buffer->beginSample(time);
+                } else {
+                    text += '#';
+                    text += std::to_string(time);
+                    text += '\n';
+                }
+                CPPTRACER_STATS(++statistics.samples_taken;)
+                emitted_time    = time;
+                changes_emitted = true;
+            }
+            if (!output_enabled) {
+                // Only the summaries are updated.
+            } else if (deferred_buffer) {
+                deferred_buffer->capture(trace, raw, size);
+            } else {
+                trace->renderValue(text, raw);
+            }
+            value_time = time;
+            if (!summaries.empty()) {
+                summaries[trace->getSummaryIndex()].add(trace->getNumber(raw), time);
+            }
+            if (columns) {
+                columns->addChange(trace->getColumnIndex(), time, raw);
+            }
+            CPPTRACER_STATS(++statistics.values_emitted;)
+        });
+        if (deferred_buffer) {
+            deferred_buffer->endSample();
+            deferred_buffer->collect(outbuffer);
+            deferred_bytes = deferred_buffer->size();
+        } else {
+            outbuffer << text;
+        }
+        this->updateBufferedBytes();
+    }
+
+    /// @brief Formats the stored raw values, and moves them to the output buffer.
+    void renderDeferred()
+    {
+        if (!deferred_buffer) {
+            return;
+        }
+        {
+            CPPTRACER_STATS(detail::StatsTimer timer(stats_timers, statistics.formatting_time);)
+            deferred_buffer->flush(outbuffer);
+        }
+        this->updateBufferedBytes();
+        deferred_bytes = deferred_buffer->size();
+    }
+
+    /// @brief Adds a row with the values of the sample to the CSV table of the columnar export, if enabled.
+    void addColumnRow()
+    {
+        if (columns) {
+            columns->addRow(value_time);
+        }
+    }
+
+    /// @brief Updates the number of buffered bytes, after writing to the output buffer.
+    void updateBufferedBytes()
+    {
+        const auto size = outbuffer.size();
+        CPPTRACER_STATS(statistics.raw_bytes += size - buffered_bytes;)
+        buffered_bytes = size;
+        this->commitCrashTail();
+    }
+
+    /// @brief Marks the content of the output buffer as the part written on a fatal signal.
+    /// @details It is called whenever the buffer ends with a complete sample.
+    void commitCrashTail()
+    {
+#ifdef CPPTRACER_POSIX
+        if (crash_flush) {
+            outbuffer.commit(buffered_bytes);
+        }
+#endif
+    }
+
+    /// @brief Forces the written trace to the storage device.
+    /// @return true on success, false otherwise.
+    auto syncTrace() -> bool
+    {
+        bool success = true;
+        if (sink) {
+            CPPTRACER_STATS(detail::StatsTimer timer(stats_timers, statistics.io_time);)
+            success = sink->sync();
+        }
+        CPPTRACER_STATS(++statistics.syncs;)
+        unsynced_bytes = 0;
+        last_sync      = std::chrono::steady_clock::now();
+        return success;
+    }
+
+    /// @brief Writes and syncs the trace, if the periodic durability is due.
+    /// @details It is checked before writing each sample, like the memory budget.
+    void applyDurability()
+    {
+        if (durability != Durability::Periodic) {
+            return;
+        }
+        const std::size_t pending = unsynced_bytes + buffered_bytes;
+        if (pending == 0) {
+            return;
+        }
+        const bool due = ((sync_bytes > 0) && (pending >= sync_bytes)) ||
+                         ((sync_interval.count() > 0) &&
+                          ((std::chrono::steady_clock::now() - last_sync) >= sync_interval));
+        if (!due) {
+            return;
+        }
+        if (!this->writeBuffer(false) || !this->syncTrace()) {
+            std::cerr << "Failed to sync the trace file '" << filename << "'.\n";
+        }
+    }
+
+    /// @brief Applies the overflow policy, if the memory budget is exhausted.
+    /// @return true if the sample can be written, false otherwise.
+    auto checkMemoryBudget() -> bool
+    {
+        if (memory_budget == 0) {
+            return true;
+        }
+        const std::size_t usage = this->memoryUsage();
+        if ((overflow_policy == OverflowPolicy::Decimate) && (usage >= decimation_threshold) &&
+            (usage < memory_budget)) {
+            // Halve the sampling rate, and wait for half of the remaining budget to be used.
+            decimation *= 2;
+            decimation_threshold += std::max<std::size_t>(1, (memory_budget - decimation_threshold) / 2);
+        }
+        if (usage < memory_budget) {
+            // Mark the gap left by the dropped samples.
+            if (pending_drops > 0) {
+                this->renderDeferred();
+                outbuffer << "$comment\n    " << pending_drops << " samples dropped, memory budget exhausted.\n$end\n";
+                pending_drops = 0;
+                this->updateBufferedBytes();
+            }
+            return true;
+        }
+        if (overflow_policy == OverflowPolicy::Flush) {
+            if (this->flushTrace()) {
+                return true;
+            }
+        } else if (overflow_policy == OverflowPolicy::Drop) {
+            ++dropped_samples;
+            ++pending_drops;
+            CPPTRACER_STATS(++statistics.samples_dropped;)
+            return false;
+        }
+        // Stop the tracing.
+        this->renderDeferred();
+        outbuffer << "$comment\n    Tracing stopped, memory budget of " << memory_budget << " bytes exhausted.\n";
+        outbuffer << "$end\n";
+        stopped = true;
+        this->updateBufferedBytes();
+        return false;
+    }
+
+    /// @brief Computes the memory used by the scopes and the traces outside of the arena.
+    /// @param scope the scope from which we start.
+    /// @return the number of bytes.
+    auto getRegistryBytes(Scope *scope) const -> std::size_t
+    {
+        std::size_t bytes = 0;
+        std::vector<Scope *> stack{scope};
+        while (!stack.empty()) {
+            scope = stack.back();
+            stack.pop_back();
+            bytes += (scope->traces.capacity() * sizeof(Trace *)) + (scope->subscopes.capacity() * sizeof(Scope *)) +
+                     (scope->aliases.capacity() * sizeof(scope->aliases[0])) +
+                     (scope->adopted.capacity() * sizeof(Trace *)) + scope->snapshot.capacity();
+            for (auto const &trace : scope->traces) {
+                bytes += trace->getMemoryUsage();
+            }
+            stack.insert(stack.end(), scope->subscopes.begin(), scope->subscopes.end());
+        }
+        return bytes;
+    }
+
+    /// @brief Applies the filters of the scopes to their floating point traces.
+    /// @param scope the scope from which we start, its own filter is used first.
+    void applyScopeFilters(Scope *scope)
+    {
+        std::vector<std::pair<Scope *, std::optional<ChangeFilter>>> stack{{scope, scope->filter}};
+        while (!stack.empty()) {
+            auto current = stack.back();
+            stack.pop_back();
+            if (current.second) {
+                for (auto *trace : current.first->traces) {
+                    trace->setScopeFilter(*current.second);
+                }
+            }
+            for (auto *subscope : current.first->subscopes) {
+                stack.emplace_back(subscope, subscope->filter ? subscope->filter : current.second);
+            }
+        }
+    }
+
     /// @brief Scales the given time to the current magnitude.
     /// @param t the input time.
     /// @return the scaled time.
@@ -322,37 +1842,274 @@ private:
         return static_cast<T>(std::round(t / timescale.getTimeUnit().toValue()));
     }
 
+    /// @brief Creates a new scope.
+    /// @param parent the parent of the new scope.
+    /// @param scope_name the name of the new scope.
+    /// @return a pointer to the new scope.
+    auto createScope(Scope *parent, std::string_view scope_name) -> Scope *
+    {
+        // Create the new scope.
+        auto new_scope    = arena.create<Scope>(arena.intern(scope_name));
+        // Set the parent of the new scope.
+        new_scope->parent = parent;
+        // Add the new scope to the parent.
+        parent->subscopes.emplace_back(new_scope);
+        // Index the new scope, the first one with a given name wins.
+        scope_index.emplace(detail::ScopeKey{parent, new_scope->name}, new_scope);
+        return new_scope;
+    }
+
+    /// @brief Searches for the scope at the given path.
+    /// @param path the dot-separated path of the scope, starting from the root.
+    /// @return a pointer to the scope.
+    auto findScope(std::string_view path) const -> Scope *
+    {
+        std::string_view::size_type end = path.find('.');
+        // The first element must be the root.
+        if (path.substr(0, end) != root_scope->name) {
+            throw std::runtime_error("Scope path '" + std::string(path) + "' does not start with the root scope.");
+        }
+        auto scope = root_scope;
+        while (end != std::string_view::npos) {
+            auto begin = end + 1;
+            end        = path.find('.', begin);
+            // Search the next scope.
+            auto it = scope_index.find(detail::ScopeKey{scope, path.substr(begin, end - begin)});
+            if (it == scope_index.end()) {
+                throw std::runtime_error("Cannot find the scope '" + std::string(path) + "'.");
+            }
+            scope = it->second;
+        }
+        return scope;
+    }
+
+    /// @brief Searches for the scope at the given path, creating the missing ones.
+    /// @param path the dot-separated path of the scope, starting from the root.
+    /// @return a pointer to the scope.
+    auto resolveScope(std::string_view path) -> Scope *
+    {
+        std::string_view::size_type end = path.find('.');
+        // The first element must be the root.
+        if (path.substr(0, end) != root_scope->name) {
+            throw std::runtime_error("Scope path '" + std::string(path) + "' does not start with the root scope.");
+        }
+        auto scope = root_scope;
+        while (end != std::string_view::npos) {
+            auto begin = end + 1;
+            end        = path.find('.', begin);
+            // Search the next scope, and create it if missing.
+            auto scope_name = path.substr(begin, end - begin);
+            auto it         = scope_index.find(detail::ScopeKey{scope, scope_name});
+            scope           = (it == scope_index.end()) ? this->createScope(scope, scope_name) : it->second;
+        }
+        return scope;
+    }
+
+    /// @brief Provides the scope where a new trace must be added.
+    /// @param name the name of the trace, if it is a path it is replaced with its last element.
+    /// @return a pointer to the scope.
+    auto getTargetScope(std::string_view &name) -> Scope *
+    {
+        const std::string_view::size_type dot = name.rfind('.');
+        if (dot != std::string_view::npos) {
+            auto scope = this->resolveScope(name.substr(0, dot));
+            name       = name.substr(dot + 1);
+            return scope;
+        }
+        if (current_scope == nullptr) {
+            throw std::runtime_error("There is no current scope.");
+        }
+        return current_scope;
+    }
+
+    /// @brief Adds an alias of the trace of a variable, if the variable is already traced.
+    /// @param key the variable.
+    /// @param scope the scope of the alias.
+    /// @param name the name of the alias.
+    /// @return the trace whose symbol is shared by the alias, null if the variable is not traced yet.
+    auto addAlias(const detail::TraceKey &key, Scope *scope, std::string_view name) -> Trace *
+    {
+        auto it = trace_index.find(key);
+        if (it == trace_index.end()) {
+            return nullptr;
+        }
+        TracedVariable &variable = it->second;
+        scope->aliases.emplace_back(arena.intern(name), variable.trace);
+        // Keep track of the scopes referencing the trace, see adoptAliases.
+        if (variable.group == npos) {
+            variable.group = alias_groups.size();
+            alias_groups.emplace_back(variable.trace, std::vector<Scope *>{variable.scope});
+        }
+        alias_groups[variable.group].second.emplace_back(scope);
+        return variable.trace;
+    }
+
+    /// @brief Checks if a scope is sampled, i.e., neither the scope nor the scopes above it are muted.
+    /// @param scope the scope.
+    /// @return true if the scope is sampled, false otherwise.
+    static auto isScopeVisible(const Scope *scope) -> bool
+    {
+        for (; scope != nullptr; scope = (scope->parent == scope) ? nullptr : scope->parent) {
+            if (scope->muted) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// @brief Assigns each aliased trace whose scope is muted to a sampled scope of one of its aliases.
+    /// @details The value of an aliased trace is compared and written only once,
+    /// by the scope owning it. When that scope is muted, the first scope of its
+    /// aliases which is still sampled writes the value in its place, so that
+    /// the aliases keep changing.
+    void adoptAliases()
+    {
+        for (const auto &group : alias_groups) {
+            for (auto *scope : group.second) {
+                scope->adopted.clear();
+            }
+        }
+        for (const auto &group : alias_groups) {
+            if (isScopeVisible(group.second.front())) {
+                continue;
+            }
+            auto adopter = std::find_if(group.second.begin() + 1, group.second.end(), isScopeVisible);
+            if (adopter != group.second.end()) {
+                (*adopter)->adopted.emplace_back(group.first);
+            }
+        }
+        // The flattened hierarchy of the parallel sampler includes the adopted traces.
+        if (parallel_sampler) {
+            parallel_sampler->build(root_scope);
+        }
+    }
+
     /// @brief Issue each trace to save the current value as `previous value`.
+    /// @details The scopes are visited in depth-first order with an explicit
+    /// stack, so that the depth of the hierarchy is not limited by the call stack.
     /// @param scope the scope from which we start the update.
-    void updateTraceRecursive(const std::shared_ptr<Scope> &scope)
+    /// @param force if true, the values are written even if they did not change.
+    void updateTraces(Scope *scope, bool force)
     {
-        for (auto const &trace : scope->traces) {
-            if (trace->hasChanged() || first_dump) {
-                // Print the trace.
-                outbuffer << trace->getValue();
-                // Update previous value.
-                trace->updatePrevious();
+        scope_stack.clear();
+        scope_stack.emplace_back(scope, force);
+        while (!scope_stack.empty()) {
+            std::tie(scope, force) = scope_stack.back();
+            scope_stack.pop_back();
+            if (scope->muted) {
+                continue;
+            }
+            // Handle the pending dump of an unmuted scope.
+            force               = force || scope->dump_pending;
+            scope->dump_pending = false;
+            // Inspect the traces only if the guarding snapshot has changed.
+            if (force || scope->snapshotChanged()) {
+                for (auto *trace : scope->traces) {
+                    this->writeTrace(scope, trace, force);
+                }
+                scope->updateSnapshot();
+            }
+            // The adopted traces are not guarded by the snapshot of the scope.
+            for (auto *trace : scope->adopted) {
+                this->writeTrace(scope, trace, force);
             }
+            // Push the subscopes in reverse order, so that they are visited in order.
+            for (auto it = scope->subscopes.rbegin(); it != scope->subscopes.rend(); ++it) {
+                scope_stack.emplace_back(*it, force);
+            }
+        }
+    }
+
+    /// @brief Writes the value of a trace, if it has changed, and saves it as `previous value`.
+    /// @param scope the scope writing the trace.
+    /// @param trace the trace.
+    /// @param force if true, the value is written even if it did not change.
+    void writeTrace(Scope *scope, Trace *trace, bool force)
+    {
+        if (!force && !trace->hasChanged()) {
+            return;
+        }
+        if (!output_enabled) {
+            // The value is not written, see disableOutput.
+        } else if (deferred_buffer) {
+            // Store the raw value, it is formatted later.
+            deferred_buffer->capture(trace, force);
+        } else if (force) {
+            // Print the whole trace.
+            outbuffer << trace->getValue();
+        } else {
+            // Print the part of the trace which has changed.
+            outbuffer << trace->getChangedValue();
+        }
+        if (!summaries.empty()) {
+            trace->summarize(&summaries[trace->getSummaryIndex()], value_time);
+        }
+        if (columns) {
+            columns->addChange(trace->getColumnIndex(), value_time, nullptr);
         }
-        for (auto &subscope : scope->subscopes) {
-            this->updateTraceRecursive(subscope);
+        // The initial values are not toggles.
+        if (!toggles.empty() && !first_dump) {
+            const std::uint64_t toggled = trace->countToggles(toggles.data() + trace->getToggleIndex());
+            CPPTRACER_STATS(statistics.toggles += toggled;)
+            (void)toggled;
         }
+        // Update previous value.
+        trace->updatePrevious();
+        CPPTRACER_STATS(++statistics.values_emitted; ++scope->changes;)
+        (void)scope;
     }
 
+#ifdef ENABLE_STATS
+    /// @brief Collects the number of values written by each scope.
+    /// @param scope the scope from which we start.
+    /// @param path the path of the scope.
+    /// @param changes the output list.
+    void collectScopeChanges(Scope *scope,
+                             const std::string &path,
+                             std::vector<std::pair<std::string, std::uint64_t>> &changes) const
+    {
+        std::vector<std::pair<Scope *, std::string>> stack{{scope, path}};
+        while (!stack.empty()) {
+            auto current = std::move(stack.back());
+            stack.pop_back();
+            changes.emplace_back(current.second, current.first->changes);
+            for (auto it = current.first->subscopes.rbegin(); it != current.first->subscopes.rend(); ++it) {
+                stack.emplace_back(*it, current.second + "." + std::string((*it)->name));
+            }
+        }
+    }
+#endif
+
     /// @brief Checks if at least one variable has changed inside/below a scope.
     /// @param scope the scope from which we start the check.
-    auto changedRecursive(const std::shared_ptr<Scope> &scope) const -> bool
+    auto changedBelow(Scope *scope) const -> bool
     {
-        auto trace_has_changed     = [](const auto &trace) { return trace->hasChanged(); };
-        auto subscopes_has_changed = [this](const auto &subscope) { return this->changedRecursive(subscope); };
-        if (std::any_of(scope->traces.begin(), scope->traces.end(), trace_has_changed)) {
-            return true;
-        }
-        if (std::any_of(scope->subscopes.begin(), scope->subscopes.end(), subscopes_has_changed)) {
-            return true;
+        auto trace_has_changed = [](const auto &trace) { return trace->hasChanged(); };
+        scope_stack.clear();
+        scope_stack.emplace_back(scope, false);
+        while (!scope_stack.empty()) {
+            scope = scope_stack.back().first;
+            scope_stack.pop_back();
+            if (scope->muted) {
+                continue;
+            }
+            if (scope->dump_pending) {
+                return true;
+            }
+            if ((scope->snapshotChanged() &&
+                 std::any_of(scope->traces.begin(), scope->traces.end(), trace_has_changed)) ||
+                std::any_of(scope->adopted.begin(), scope->adopted.end(), trace_has_changed)) {
+                return true;
+            }
+            for (auto const &subscope : scope->subscopes) {
+                scope_stack.emplace_back(subscope, false);
+            }
         }
         return false;
     }
 };
 
 } // namespace cpptracer
+
+// The instantiations compiled inside the precompiled library.
+#include "precompiled.hpp"
@@ -0,0 +1,126 @@
+/// @file traits.hpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Contains the customization point used to trace user-defined types.
+
+#pragma once
+
+#include "format.hpp"
+#include "utilities.hpp"
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+namespace cpptracer
+{
+
+/// @brief Describes how a user-defined type is traced, so that it can be passed to Tracer::addTrace.
+/// @details Specialize it for a trivially copyable type (e.g., a fixed-point
+/// class, or a strong typedef) to trace its variables directly, instead of
+/// copying them into a shadow variable of a built-in type at each step. The
+/// specialization provides:
+///  - `raw_type`, the built-in integer (up to 64 bits), bool, float or double holding the value;
+///  - `width`, the number of bits of the signal, at most those of `raw_type`;
+///  - `kind`, the kind of the `$var` (e.g., "integer", "wire", or "real");
+///  - `raw(value)`, which extracts the value as `raw_type`;
+///  - `equal(lhs, rhs)`, which checks if two values are the same.
+///
+/// The values are then compared with `equal`, and written by the same
+/// routines of the built-in types, from the raw values. Enumerations are
+/// traced as their underlying type, unless a specialization is given.
+/// @tparam T the type of the traced variable.
+/// @tparam Enable used to specialize the traits for groups of types.
+template <typename T, typename Enable = void>
+struct trace_traits {
+};
+
+/// @brief Describes the enumerations, traced as their underlying type.
+/// @tparam T the type of the enumeration.
+template <typename T>
+struct trace_traits<T, std::enable_if_t<std::is_enum<T>::value>> {
+    using raw_type                     = std::underlying_type_t<T>; ///< The type holding the value.
+    static constexpr std::size_t width = sizeof(raw_type) * 8U;     ///< The number of bits.
+    static constexpr const char *kind  = "integer";                 ///< The kind of the $var.
+
+    /// @brief Extracts the value.
+    /// @param value the input value.
+    /// @return the underlying value.
+    static auto raw(const T &value) -> raw_type { return static_cast<raw_type>(value); }
+
+    /// @brief Checks if two values are the same.
+    /// @param lhs the first value.
+    /// @param rhs the second value.
+    /// @return true if they are equal.
+    static auto equal(const T &lhs, const T &rhs) -> bool { return lhs == rhs; }
+};
+
+namespace detail
+{
+
+/// @brief Checks if the given type is described by trace_traits.
+/// @tparam T the type of the traced variable.
+template <typename T, typename = void>
+struct has_trace_traits : std::false_type {
+};
+
+/// @brief The types whose traits provide the raw type are described by trace_traits.
+/// @tparam T the type of the traced variable.
+template <typename T>
+struct has_trace_traits<T, std::void_t<typename trace_traits<T>::raw_type>> : std::true_type {
+};
+
+/// @brief Provides the type of the raw values of a traced type, the type itself unless described by trace_traits.
+/// @tparam T the type of the traced variable.
+template <typename T, typename = void>
+struct raw_type_of {
+    using type = T; ///< The type of the raw values.
+};
+
+/// @brief Provides the raw type given by trace_traits.
+/// @tparam T the type of the traced variable.
+template <typename T>
+struct raw_type_of<T, std::void_t<typename trace_traits<T>::raw_type>> {
+    using type = typename trace_traits<T>::raw_type; ///< The type of the raw values.
+};
+
+/// @brief Provides the NumPy type of a built-in type, for the columnar export.
+/// @tparam T the built-in type.
+/// @return the type without the byte order (e.g., "i4"), null if it has none.
+template <typename T>
+constexpr auto npy_type() -> const char *
+{
+    if constexpr (std::is_same<T, bool>::value) {
+        return "b1";
+    } else if constexpr (std::is_floating_point<T>::value) {
+        return (sizeof(T) == 4U) ? "f4" : ((sizeof(T) == 8U) ? "f8" : nullptr);
+    } else if constexpr (std::is_signed<T>::value) {
+        return (sizeof(T) == 1U) ? "i1" : ((sizeof(T) == 2U) ? "i2" : ((sizeof(T) == 4U) ? "i4" : "i8"));
+    } else {
+        return (sizeof(T) == 1U) ? "u1" : ((sizeof(T) == 2U) ? "u2" : ((sizeof(T) == 4U) ? "u4" : "u8"));
+    }
+}
+
+/// @brief Appends the raw value of a user-defined type to the string, followed by a space.
+/// @details Integers are written with the number of bits given by the
+/// traits, the other values as the built-in types.
+/// @tparam Traits the traits of the type.
+/// @param buffer the output string.
+/// @param value the raw value.
+/// @param precision the precision used for floating point values.
+template <typename Traits>
+inline void append_traits_value(std::string &buffer, typename Traits::raw_type value, int precision)
+{
+    using R = typename Traits::raw_type;
+    if constexpr (std::is_integral<R>::value && !std::is_same<R, bool>::value) {
+        buffer += 'b';
+        utility::append_binary(buffer, static_cast<std::uint64_t>(static_cast<std::make_unsigned_t<R>>(value)),
+                               Traits::width);
+        buffer += ' ';
+    } else {
+        append_value(buffer, value, precision);
+    }
+}
+
+} // namespace detail
+
+} // namespace cpptracer
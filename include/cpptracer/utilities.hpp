@@ -4,16 +4,21 @@
 
 #pragma once
 
+#include <array>
+#include <bitset>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <map>
 #include <sstream>
+#include <string_view>
 #include <string>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <type_traits>
 #include <vector>
 
 namespace cpptracer
@@ -22,6 +27,19 @@ namespace cpptracer
 namespace utility
 {
 
+/// @brief Checks if the given type is an std::array.
+/// @tparam T the type to check.
+template <typename T>
+struct is_std_array : std::false_type {
+};
+
+/// @brief Checks if the given type is an std::array.
+/// @tparam T the type of the elements.
+/// @tparam N the number of elements.
+template <typename T, std::size_t N>
+struct is_std_array<std::array<T, N>> : std::true_type {
+};
+
 /// @brief Creates a new directory at the given location.
 /// @param path of the new directory.
 inline void create_dir(std::string const &path)
@@ -50,10 +68,79 @@ auto dec_to_binary(T value, T length) -> std::string
     return buffer;
 }
 
+/// @brief Table with the binary expansion of each byte, most significant bit first.
+/// @return the table.
+inline auto byte_expansion_table() -> const std::array<std::array<char, 8>, 256> &
+{
+    static const std::array<std::array<char, 8>, 256> table = [] {
+        std::array<std::array<char, 8>, 256> result{};
+        for (std::size_t byte = 0; byte < 256; ++byte) {
+            for (std::size_t bit = 0; bit < 8; ++bit) {
+                result[byte][bit] = ((byte >> (7U - bit)) & 1U) ? '1' : '0';
+            }
+        }
+        return result;
+    }();
+    return table;
+}
+
+/// @brief Appends the binary representation of the given value to the string.
+/// @details Whole bytes are expanded eight characters at a time, using a
+/// lookup table.
+/// @param buffer the output string.
+/// @param value the input value, stored in the least significant bits.
+/// @param length the number of bits to append (at most 64).
+inline void append_binary(std::string &buffer, std::uint64_t value, std::size_t length)
+{
+    const auto &table = byte_expansion_table();
+    std::size_t i     = length;
+    // Expand the bits which do not fill a whole byte.
+    for (; (i % 8U) != 0; --i) {
+        buffer.push_back(((value >> (i - 1U)) & 1U) ? '1' : '0');
+    }
+    // Expand the remaining bytes.
+    for (; i > 0; i -= 8U) {
+        const auto &chars = table[(value >> (i - 8U)) & 0xFFU];
+        buffer.append(chars.data(), chars.size());
+    }
+}
+
+/// @brief Appends the binary representation of a packed array of words.
+/// @param buffer the output string.
+/// @param words the words, the least significant one first.
+/// @param width the number of bits to append.
+inline void append_binary(std::string &buffer, const std::uint64_t *words, std::size_t width)
+{
+    const std::size_t nwords = (width + 63U) / 64U;
+    for (std::size_t word = nwords; word > 0; --word) {
+        append_binary(buffer, words[word - 1U], (word == nwords) ? (width - (nwords - 1U) * 64U) : 64U);
+    }
+}
+
+/// @brief Appends the binary representation of a bitset.
+/// @tparam N the number of bits.
+/// @param buffer the output string.
+/// @param bits the input bitset.
+template <std::size_t N>
+inline void append_binary(std::string &buffer, const std::bitset<N> &bits)
+{
+    if constexpr (N <= 64U) {
+        append_binary(buffer, bits.to_ullong(), N);
+    } else {
+        // Extract the bitset one word at a time.
+        const std::bitset<N> mask(~0ULL);
+        std::array<std::uint64_t, (N + 63U) / 64U> words{};
+        for (std::size_t word = 0; word < words.size(); ++word) {
+            words[word] = ((bits >> (word * 64U)) & mask).to_ullong();
+        }
+        append_binary(buffer, words.data(), N);
+    }
+}
+
 /// @brief Transforms the boolean vector to a binary string.
 /// @param vector the input vector.
 /// @return the string representing the binary value.
-auto vector_to_binary(const std::vector<bool> &vector) -> std::string
+inline auto vector_to_binary(const std::vector<bool> &vector) -> std::string
 {
     std::string buffer(vector.size(), '0');
     std::string::iterator it = buffer.begin();
@@ -82,7 +169,7 @@ auto array_to_binary(const std::array<bool, N> &array) -> std::string
 /// Peter J. Weinberger of AT&T Bell Labs.
 /// @param s the input string.
 /// @return the hash value.
-inline auto elf_hash(std::string const &s) -> unsigned int
+inline auto elf_hash(std::string_view s) -> unsigned int
 {
     unsigned int hash = 0;
     unsigned int x    = 0;
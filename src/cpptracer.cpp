@@ -0,0 +1,18 @@
+/// @file cpptracer.cpp
+/// @author Enrico Fraccaroli (enry.frak@gmail.com)
+/// @brief Compiles the instantiations declared in precompiled.hpp, once for all the users of the library.
+
+#include "cpptracer/tracer.hpp"
+
+/// @brief Defines the instantiations for a scalar type.
+#define CPPTRACER_DEFINE_SCALAR(T) CPPTRACER_INSTANTIATE_SCALAR(, T)
+
+namespace cpptracer
+{
+
+CPPTRACER_PRECOMPILED_SCALARS(CPPTRACER_DEFINE_SCALAR)
+template class TraceWrapper<std::vector<bool>>;
+template auto Tracer::addTrace<std::vector<bool>>(const std::vector<bool> &, std::string_view)
+    -> TraceWrapper<std::vector<bool>> *;
+
+} // namespace cpptracer
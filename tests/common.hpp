@@ -0,0 +1,54 @@
+/// @file common.hpp
+/// @brief Contains the functions shared by the tests.
+
+#pragma once
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef ENABLE_COMPRESSION
+#include <zlib.h>
+#endif
+
+/// @brief Reads the whole content of a file, decompressing it if its name ends with ".gz".
+/// @param filename the name of the file.
+/// @return the content of the file.
+inline std::string read_file(const std::string &filename)
+{
+#ifdef ENABLE_COMPRESSION
+    if (filename.size() > 3 && filename.compare(filename.size() - 3, 3, ".gz") == 0) {
+        std::string content;
+        gzFile file = gzopen(filename.c_str(), "rb");
+        char chunk[4096];
+        int count;
+        while ((count = gzread(file, chunk, sizeof(chunk))) > 0) {
+            content.append(chunk, static_cast<std::size_t>(count));
+        }
+        gzclose(file);
+        return content;
+    }
+#endif
+    std::ifstream infile(filename, std::ios::binary);
+    std::stringstream content;
+    content << infile.rdbuf();
+    return content.str();
+}
+
+/// @brief Removes the $date section, which changes between runs.
+/// @param content the content of the trace.
+/// @return the content without the date.
+inline std::string strip_date(const std::string &content)
+{
+    const auto start = content.find("$date\n");
+    const auto end   = content.find("$end\n", start);
+    if ((start == std::string::npos) || (end == std::string::npos)) {
+        return content;
+    }
+    return content.substr(0, start) + content.substr(end + 5);
+}
+
+/// @brief Reads the content of a trace file, skipping the $date section.
+/// @param filename the name of the file.
+/// @return the content of the file.
+inline std::string read_trace(const std::string &filename) { return strip_date(read_file(filename)); }
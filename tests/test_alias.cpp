@@ -0,0 +1,166 @@
+#include "cpptracer/tracer.hpp"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+
+/// Number of steps of the simulation.
+constexpr int steps = 100;
+
+/// @brief Extracts the symbols of the $var inside the header of a trace.
+/// @param text the trace.
+/// @return the symbol of each signal, by its dot-separated path.
+inline auto read_symbols(const std::string &text) -> std::map<std::string, std::string>
+{
+    std::map<std::string, std::string> symbols;
+    std::vector<std::string> scopes;
+    std::istringstream input(text);
+    std::string line;
+    while (std::getline(input, line) && (line != "$enddefinitions $end")) {
+        std::istringstream words(line);
+        std::string first, second, third, fourth, fifth;
+        words >> first >> second >> third >> fourth >> fifth;
+        if (first == "$scope") {
+            scopes.emplace_back(scopes.empty() ? third : scopes.back() + "." + third);
+        } else if (first == "$upscope") {
+            scopes.pop_back();
+        } else if (first == "$var") {
+            symbols[scopes.back() + "." + fifth] = fourth;
+        }
+    }
+    return symbols;
+}
+
+/// @brief Counts the values written for a symbol, after the header.
+/// @param text the trace.
+/// @param symbol the symbol.
+/// @return the number of values.
+inline auto count_values(const std::string &text, const std::string &symbol) -> std::size_t
+{
+    std::size_t count = 0;
+    std::istringstream input(text.substr(text.find("$enddefinitions $end")));
+    std::string line;
+    while (std::getline(input, line)) {
+        const auto space = line.rfind(' ');
+        if ((space != std::string::npos) && (line.compare(space + 1, std::string::npos, symbol) == 0)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+/// @brief Traces the aliases, and checks that they share the symbol and the values.
+/// @return true on success.
+inline bool check_shared()
+{
+    std::uint32_t bus = 0;
+    double level      = 0.0;
+    std::array<std::uint64_t, 2> wide{};
+    {
+        cpptracer::Tracer tracer("test_alias.vcd", cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+        auto *master = tracer.addTrace(bus, "root.master.bus");
+        auto *slave  = tracer.addTrace(bus, "root.slave.bus");
+        tracer.addTrace(level, "root.master.level");
+        tracer.addTrace(level, "root.level");
+        tracer.addTrace(wide, "root.wide", 70);
+        // The same memory with another type or width is a different signal.
+        tracer.addTrace(wide, "root.narrow", 20);
+        tracer.addTrace(wide[0], "root.low");
+        if (master != slave) {
+            std::cerr << "The aliases do not share the trace handler.\n";
+            return false;
+        }
+        tracer.createTrace();
+        for (int step = 1; step <= steps; ++step) {
+            bus     = static_cast<std::uint32_t>(step * 7);
+            level   = step * 0.25;
+            wide[0] = static_cast<std::uint64_t>(step) << 10U;
+            tracer.updateTrace(step);
+        }
+    }
+    std::ifstream infile("test_alias.vcd");
+    std::stringstream content;
+    content << infile.rdbuf();
+    const std::string text = content.str();
+    auto symbols           = read_symbols(text);
+    if (symbols.size() != 7) {
+        std::cerr << "The header has " << symbols.size() << " $var, instead of 7.\n";
+        return false;
+    }
+    // Each value of the aliased variables is written once, for the symbol they share.
+    const std::vector<std::pair<std::string, std::string>> shared = {{"root.master.bus", "root.slave.bus"},
+                                                                      {"root.master.level", "root.level"}};
+    for (const auto &[name, alias] : shared) {
+        if (symbols[name] != symbols[alias]) {
+            std::cerr << alias << " is not an alias of " << name << ".\n";
+            return false;
+        }
+        // The first step is the initial dump, then a value for each step.
+        if (count_values(text, symbols[name]) != steps) {
+            std::cerr << "The values of " << name << " are written " << count_values(text, symbols[name])
+                      << " times, instead of " << steps << ".\n";
+            return false;
+        }
+    }
+    const std::vector<std::string> distinct = {"root.wide", "root.narrow", "root.low"};
+    for (std::size_t index = 0; index < distinct.size(); ++index) {
+        for (std::size_t other = index + 1; other < distinct.size(); ++other) {
+            if (symbols[distinct[index]] == symbols[distinct[other]]) {
+                std::cerr << distinct[index] << " and " << distinct[other] << " share the same symbol.\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// @brief Mutes the scopes of the aliases, and checks that the values are written while any of them is not muted.
+/// @param threads the number of sampling threads.
+/// @return true on success.
+inline bool check_muted(std::size_t threads)
+{
+    std::uint32_t bus          = 0;
+    const std::string filename = "test_alias_muted_" + std::to_string(threads) + ".vcd";
+    {
+        cpptracer::Tracer tracer(filename, cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+        tracer.enableParallelSampling(threads);
+        tracer.addTrace(bus, "root.master.bus");
+        tracer.addTrace(bus, "root.slave.port.bus");
+        // The scope owning the trace is muted from the start.
+        tracer.muteScope("root.master");
+        tracer.createTrace();
+        for (int step = 1; step <= steps; ++step) {
+            if (step == steps / 2) {
+                tracer.unmuteScope("root.master");
+                tracer.muteScope("root.slave");
+            } else if (step == steps * 3 / 4) {
+                // Both scopes are muted.
+                tracer.muteScope("root.master");
+            }
+            bus = static_cast<std::uint32_t>(step * 3);
+            tracer.updateTrace(step);
+        }
+    }
+    std::ifstream infile(filename);
+    std::stringstream content;
+    content << infile.rdbuf();
+    const std::string text = content.str();
+    auto symbols           = read_symbols(text);
+    // A value for each step, until both scopes are muted.
+    const std::size_t expected = steps * 3 / 4 - 1;
+    if ((symbols["root.master.bus"] != symbols["root.slave.port.bus"]) ||
+        (count_values(text, symbols["root.master.bus"]) != expected)) {
+        std::cerr << "The values of the muted aliases are written " << count_values(text, symbols["root.master.bus"])
+                  << " times, instead of " << expected << ", with " << threads << " threads.\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int, char *[])
+{
+    if (!check_shared() || !check_muted(1) || !check_muted(3)) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "cpptracer/tracer.hpp"
+
+#include "common.hpp"
+
+#include <cstring>
+
+int main(int, char **)
+{
+    cpptracer::TimeScale timeStep(1, cpptracer::TimeUnit::SEC);
+
+    // Sizes chosen to exercise both the vectorized blocks and the tail.
+    std::vector<std::int32_t> integers(101, 0);
+    std::vector<double> reals(37, 1.0);
+    std::vector<std::uint8_t> bytes(70, 0);
+    std::vector<long double> extended(9, 1.0L);
+    std::vector<double> noisy(19, 1.0);
+
+    {
+        cpptracer::Tracer bulk("test_array_trace_bulk.vcd", timeStep, "root");
+        cpptracer::Tracer single("test_array_trace_single.vcd", timeStep, "root");
+
+        bulk.addArrayTrace(integers.data(), integers.size(), "integers");
+        bulk.addArrayTrace(reals.data(), reals.size(), "reals");
+        bulk.addArrayTrace(bytes.data(), bytes.size(), "bytes");
+        bulk.addArrayTrace(extended.data(), extended.size(), "extended");
+        bulk.addArrayTrace(noisy.data(), noisy.size(), "noisy");
+        for (std::size_t i = 0; i < integers.size(); ++i) {
+            single.addTrace(integers[i], "integers[" + std::to_string(i) + "]");
+        }
+        for (std::size_t i = 0; i < reals.size(); ++i) {
+            single.addTrace(reals[i], "reals[" + std::to_string(i) + "]");
+        }
+        for (std::size_t i = 0; i < bytes.size(); ++i) {
+            single.addTrace(bytes[i], "bytes[" + std::to_string(i) + "]");
+        }
+        for (std::size_t i = 0; i < extended.size(); ++i) {
+            single.addTrace(extended[i], "extended[" + std::to_string(i) + "]");
+        }
+        for (std::size_t i = 0; i < noisy.size(); ++i) {
+            single.addTrace(noisy[i], "noisy[" + std::to_string(i) + "]");
+        }
+
+        bulk.createTrace();
+        single.createTrace();
+
+        constexpr std::size_t significant = cpptracer::detail::significant_bytes<long double>;
+        std::size_t seed                  = 1;
+        for (int step = 0; step < 100; ++step) {
+            // Change a few pseudo-random elements.
+            for (int change = 0; change < 5; ++change) {
+                seed = (seed * 1103515245U + 12345U) % 2147483648U;
+                integers[seed % integers.size()] += 1;
+                reals[seed % reals.size()] *= 2.0;
+                bytes[seed % bytes.size()] = static_cast<std::uint8_t>(bytes[seed % bytes.size()] + 1U);
+                extended[seed % extended.size()] += 0.25L;
+                noisy[seed % noisy.size()] += 1.0;
+            }
+            // Add noise below the tolerance, which is not a change, as the sign of zero.
+            for (auto &value : noisy) {
+                value *= 1.0 + 1e-15;
+            }
+            noisy[0] = (step % 2 == 0) ? 0.0 : -0.0;
+            // Scribble over the padding bytes of the long doubles, which are not part of their values.
+            for (auto &value : extended) {
+                auto *padding = reinterpret_cast<unsigned char *>(&value) + significant;
+                std::memset(padding, step, sizeof(long double) - significant);
+            }
+            bulk.updateTrace(step);
+            single.updateTrace(step);
+        }
+    }
+
+    std::string bulk_trace   = read_trace("test_array_trace_bulk.vcd");
+    std::string single_trace = read_trace("test_array_trace_single.vcd");
+    if (bulk_trace.empty() || (bulk_trace != single_trace)) {
+        std::cerr << "The array trace differs from the one of the single traces.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include "cpptracer/tracer.hpp"
+
+#include <fstream>
+#include <sstream>
+
+/// @brief Reads the values of the given symbol from a trace file.
+/// @param filename the name of the file.
+/// @param symbol the symbol of the trace.
+/// @return the values, in order.
+inline std::vector<std::string> read_values(const std::string &filename, const std::string &symbol)
+{
+    std::ifstream infile(filename);
+    std::vector<std::string> values;
+    std::string line;
+    while (std::getline(infile, line)) {
+        std::string::size_type space = line.find(' ');
+        if ((line[0] == 'b') && (space != std::string::npos) && (line.substr(space + 1) == symbol)) {
+            values.emplace_back(line.substr(1, space - 1));
+        }
+    }
+    return values;
+}
+
+int main(int, char **)
+{
+    cpptracer::TimeScale timeStep(1, cpptracer::TimeUnit::SEC);
+
+    // The same 100-bit value, stored in different ways.
+    std::array<bool, 100> reference{};
+    std::bitset<100> bitset;
+    std::array<std::uint64_t, 2> words{};
+    // The same 128-bit value, stored in different ways.
+    std::array<bool, 128> reference128{};
+    std::array<std::uint64_t, 2> words128{};
+#ifdef __SIZEOF_INT128__
+    cpptracer::uint128_t value128 = 0;
+#endif
+
+    {
+        cpptracer::Tracer tracer("test_bitvectors.vcd", timeStep, "root");
+        tracer.addTrace(reference, "reference");
+        tracer.addTrace(bitset, "bitset");
+        tracer.addTrace(words, "words", 100);
+        tracer.addTrace(reference128, "reference128");
+        tracer.addTrace(words128, "words128");
+#ifdef __SIZEOF_INT128__
+        tracer.addTrace(value128, "value128");
+#endif
+        tracer.createTrace();
+
+        for (std::size_t step = 0; step < 64; ++step) {
+            // Flip a pseudo-random bit of every value.
+            std::size_t bit = (step * 37U + 11U) % 100U;
+            reference[99U - bit] = !reference[99U - bit];
+            bitset.flip(bit);
+            words[bit / 64U] ^= std::uint64_t(1) << (bit % 64U);
+            bit = (step * 53U + 7U) % 128U;
+            reference128[127U - bit] = !reference128[127U - bit];
+            words128[bit / 64U] ^= std::uint64_t(1) << (bit % 64U);
+#ifdef __SIZEOF_INT128__
+            value128 ^= cpptracer::uint128_t(1) << bit;
+#endif
+            // Bits above the width are not traced.
+            words[1] ^= std::uint64_t(1) << 63U;
+            tracer.updateTrace(static_cast<double>(step));
+        }
+    }
+
+    auto expected = read_values("test_bitvectors.vcd", "0");
+    if ((expected.size() != 64U) || (expected[0].size() != 100U)) {
+        std::cerr << "Wrong reference values.\n";
+        return 1;
+    }
+    if ((read_values("test_bitvectors.vcd", "1") != expected) || (read_values("test_bitvectors.vcd", "2") != expected)) {
+        std::cerr << "Wrong 100-bit values.\n";
+        return 1;
+    }
+    expected = read_values("test_bitvectors.vcd", "3");
+    if ((expected.size() != 64U) || (read_values("test_bitvectors.vcd", "4") != expected)) {
+        std::cerr << "Wrong 128-bit values.\n";
+        return 1;
+    }
+#ifdef __SIZEOF_INT128__
+    if (read_values("test_bitvectors.vcd", "5") != expected) {
+        std::cerr << "Wrong __int128 values.\n";
+        return 1;
+    }
+#endif
+    return 0;
+}
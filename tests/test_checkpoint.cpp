@@ -0,0 +1,168 @@
+#include "cpptracer/tracer.hpp"
+
+#include "common.hpp"
+
+#include <sstream>
+
+/// The step at which the checkpoint is saved.
+constexpr int checkpoint_step = 40;
+/// The step at which the first run is interrupted, after the checkpoint.
+constexpr int crash_step = 70;
+/// The last step.
+constexpr int last_step = 120;
+
+/// @brief The state of the simulation, restored together with the tracer.
+struct State {
+    std::int32_t counter = 0;
+    double voltage       = 0.0;
+    bool toggle          = false;
+    float samples[4]     = {};
+};
+
+/// @brief Advances the simulation by one step.
+/// @param state the state.
+/// @param step the step.
+inline void advance(State &state, int step)
+{
+    state.counter += (step % 3 == 0) ? 1 : 0;
+    state.voltage = static_cast<double>(step % 7) * 0.5;
+    state.toggle  = !state.toggle;
+    state.samples[step % 4] += 1.0f;
+}
+
+/// @brief Registers the traces of the simulation.
+/// @param tracer the tracer.
+/// @param state the state.
+/// @param compress if true, the trace is compressed.
+inline void add_traces(cpptracer::Tracer &tracer, State &state, bool compress)
+{
+    if (compress) {
+        tracer.enableCompression();
+    }
+    tracer.addTrace(state.counter, "root.counter");
+    tracer.addTrace(state.voltage, "root.analog.voltage");
+    tracer.addTrace(state.toggle, "root.analog.toggle");
+    tracer.addArrayTrace(state.samples, 4, "root.samples");
+}
+
+/// @brief Checks that a trace resumed from a checkpoint matches an uninterrupted one.
+/// @param compress if true, the traces are compressed.
+/// @return true on success.
+inline bool check_resume(bool compress)
+{
+    const std::string suffix = compress ? ".vcd.gz" : ".vcd";
+    const cpptracer::TimeScale timescale(1, cpptracer::TimeUnit::NS);
+
+    // The uninterrupted run.
+    {
+        State state;
+        cpptracer::Tracer tracer("test_checkpoint_reference.vcd", timescale, "root");
+        add_traces(tracer, state, compress);
+        tracer.setVersionText("    test\n");
+        tracer.createTrace();
+        for (int step = 1; step <= last_step; ++step) {
+            advance(state, step);
+            tracer.updateTrace(step);
+        }
+    }
+
+    // The run which saves a checkpoint, and keeps writing until it is interrupted.
+    std::stringstream checkpoint;
+    State saved;
+    {
+        State state;
+        cpptracer::Tracer tracer("test_checkpoint_resumed.vcd", timescale, "root");
+        add_traces(tracer, state, compress);
+        tracer.setVersionText("    test\n");
+        tracer.createTrace();
+        for (int step = 1; step <= crash_step; ++step) {
+            advance(state, step);
+            tracer.updateTrace(step);
+            if (step == checkpoint_step) {
+                tracer.saveCheckpoint(checkpoint);
+                saved = state;
+            }
+        }
+        tracer.closeTrace();
+    }
+
+    // The restarted run, which resumes from the checkpoint.
+    {
+        State state = saved;
+        cpptracer::Tracer tracer("test_checkpoint_resumed.vcd", timescale, "root");
+        add_traces(tracer, state, compress);
+        tracer.resumeTrace(checkpoint);
+        for (int step = checkpoint_step + 1; step <= last_step; ++step) {
+            advance(state, step);
+            tracer.updateTrace(step);
+        }
+    }
+
+    std::string reference = read_file("test_checkpoint_reference" + suffix);
+    std::string resumed   = read_file("test_checkpoint_resumed" + suffix);
+#ifdef ENABLE_COMPRESSION
+    if (compress) {
+        // The gzip members differ in where they are split, compare the decompressed traces.
+        const auto gunzip = [](const std::string &filename) {
+            std::string content;
+            gzFile file = gzopen(filename.c_str(), "rb");
+            char chunk[4096];
+            int count;
+            while ((count = gzread(file, chunk, sizeof(chunk))) > 0) {
+                content.append(chunk, static_cast<std::size_t>(count));
+            }
+            gzclose(file);
+            return content;
+        };
+        reference = gunzip("test_checkpoint_reference" + suffix);
+        resumed   = gunzip("test_checkpoint_resumed" + suffix);
+    }
+#endif
+    // The dates inside the headers are the same, since the header is not rewritten.
+    reference = reference.substr(reference.find("$version"));
+    resumed   = resumed.substr(resumed.find("$version"));
+    if (reference != resumed) {
+        std::cerr << "The resumed trace does not match the uninterrupted one" << (compress ? ", compressed" : "")
+                  << ".\n";
+        return false;
+    }
+    return true;
+}
+
+/// @brief Checks that a checkpoint is rejected by a tracer with different traces.
+/// @return true on success.
+inline bool check_mismatch()
+{
+    const cpptracer::TimeScale timescale(1, cpptracer::TimeUnit::NS);
+    State state;
+    std::stringstream checkpoint;
+    {
+        cpptracer::Tracer tracer("test_checkpoint_mismatch.vcd", timescale, "root");
+        tracer.addTrace(state.counter, "root.counter");
+        tracer.createTrace();
+        tracer.updateTrace(1);
+        tracer.saveCheckpoint(checkpoint);
+    }
+    cpptracer::Tracer tracer("test_checkpoint_mismatch.vcd", timescale, "root");
+    tracer.addTrace(state.voltage, "root.voltage");
+    try {
+        tracer.resumeTrace(checkpoint);
+    } catch (const std::runtime_error &) {
+        return true;
+    }
+    std::cerr << "The checkpoint of different traces has been accepted.\n";
+    return false;
+}
+
+int main(int, char *[])
+{
+    if (!check_resume(false) || !check_mismatch()) {
+        return 1;
+    }
+#ifdef ENABLE_COMPRESSION
+    if (!check_resume(true)) {
+        return 1;
+    }
+#endif
+    return 0;
+}
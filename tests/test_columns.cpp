@@ -0,0 +1,206 @@
+#include "cpptracer/tracer.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+/// Number of steps of the simulation.
+constexpr int steps = 250;
+
+/// @brief Reads a NumPy file holding an array of (time, value) records.
+/// @tparam T the type of the values.
+/// @param filename the name of the file.
+/// @param type the expected NumPy type of the values, with the byte order.
+/// @param records receives the records.
+/// @return true on success.
+template <typename T>
+inline bool read_npy(const std::string &filename, const std::string &type,
+                     std::vector<std::pair<std::uint64_t, T>> &records)
+{
+    std::ifstream infile(filename, std::ios::binary);
+    std::stringstream content;
+    content << infile.rdbuf();
+    const std::string data = content.str();
+    if ((data.size() < 128) || (data.compare(0, 6, "\x93NUMPY") != 0) ||
+        (static_cast<unsigned char>(data[8]) + 256U * static_cast<unsigned char>(data[9]) + 10U != 128U) ||
+        (data[127] != '\n')) {
+        std::cerr << "Wrong header of " << filename << ".\n";
+        return false;
+    }
+    const std::string header = data.substr(10, 118);
+    if (header.find("('value', '" + type + "')") == std::string::npos) {
+        std::cerr << "Wrong type of " << filename << ": " << header << "\n";
+        return false;
+    }
+    const std::size_t record = sizeof(std::uint64_t) + sizeof(T);
+    const std::size_t count  = (data.size() - 128U) / record;
+    if ((data.size() - 128U) % record != 0 ||
+        header.find("'shape': (" + std::to_string(count) + ",)") == std::string::npos) {
+        std::cerr << "Wrong number of records inside " << filename << ": " << header << "\n";
+        return false;
+    }
+    records.resize(count);
+    for (std::size_t index = 0; index < count; ++index) {
+        std::memcpy(&records[index].first, data.data() + 128U + index * record, sizeof(std::uint64_t));
+        std::memcpy(&records[index].second, data.data() + 128U + index * record + sizeof(std::uint64_t), sizeof(T));
+    }
+    return true;
+}
+
+/// @brief Checks the records of a signal against the expected changes.
+/// @tparam T the type of the values.
+/// @param filename the name of the file.
+/// @param type the expected NumPy type of the values, with the byte order.
+/// @param expected the expected changes.
+/// @return true on success.
+template <typename T>
+inline bool check_npy(const std::string &filename, const std::string &type,
+                      const std::vector<std::pair<std::uint64_t, T>> &expected)
+{
+    std::vector<std::pair<std::uint64_t, T>> records;
+    if (!read_npy(filename, type, records)) {
+        return false;
+    }
+    if (records.size() != expected.size()) {
+        std::cerr << filename << " has " << records.size() << " records, instead of " << expected.size() << ".\n";
+        return false;
+    }
+    for (std::size_t index = 0; index < records.size(); ++index) {
+        if ((records[index].first != expected[index].first) ||
+            (std::memcmp(&records[index].second, &expected[index].second, sizeof(T)) != 0)) {
+            std::cerr << "Wrong record " << index << " of " << filename << ".\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Appends a change to the expected ones, if the value differs from the last one.
+/// @tparam T the type of the values.
+/// @param changes the expected changes.
+/// @param time the scaled time.
+/// @param value the value.
+template <typename T>
+inline void expect_change(std::vector<std::pair<std::uint64_t, T>> &changes, std::uint64_t time, T value)
+{
+    if (changes.empty() || (std::memcmp(&changes.back().second, &value, sizeof(T)) != 0)) {
+        changes.emplace_back(time, value);
+    }
+}
+
+/// @brief Runs the simulation with the NumPy files, and checks them.
+/// @param threads the number of sampling threads.
+/// @return true on success.
+inline bool check_npy_export(std::size_t threads)
+{
+    std::int16_t level = 0;
+    bool enable        = false;
+    double voltage     = 0.0;
+    std::uint64_t wide = 0;
+    std::vector<bool> bus(8, false);
+    std::vector<std::pair<std::uint64_t, std::int16_t>> levels;
+    std::vector<std::pair<std::uint64_t, bool>> enables;
+    std::vector<std::pair<std::uint64_t, double>> voltages;
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> wides;
+
+    const std::string filename = "test_columns_" + std::to_string(threads) + ".vcd";
+    {
+        cpptracer::Tracer tracer(filename, cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+        tracer.enableColumnarExport();
+        tracer.enableParallelSampling(threads);
+        tracer.addTrace(level, "root.level");
+        tracer.addTrace(enable, "root.core.enable");
+        tracer.addTrace(voltage, "root.core.analog.voltage");
+        tracer.addTrace(wide, "root.core.wide");
+        tracer.addTrace(bus, "root.bus");
+        tracer.createTrace();
+        for (int step = 1; step <= steps; ++step) {
+            level   = static_cast<std::int16_t>(-(step / 3));
+            enable  = (step % 10) < 4;
+            voltage = std::sin(step * 0.05) * 2.5;
+            wide    = std::uint64_t(step / 20) << 40U;
+            bus[static_cast<std::size_t>(step) % bus.size()].flip();
+            tracer.updateTrace(step);
+            const auto time = static_cast<std::uint64_t>(step) * 1000000000U;
+            expect_change(levels, time, level);
+            expect_change(enables, time, enable);
+            expect_change(voltages, time, voltage);
+            expect_change(wides, time, wide);
+        }
+    }
+    const char order = cpptracer::detail::npy_byte_order();
+    // The bit-vector is not exported.
+    if (std::ifstream(filename + ".root.bus.npy").is_open()) {
+        std::cerr << "The bit-vector has been exported.\n";
+        return false;
+    }
+    return check_npy(filename + ".root.level.npy", order + std::string("i2"), levels) &&
+           check_npy(filename + ".root.core.enable.npy", "|b1", enables) &&
+           check_npy(filename + ".root.core.analog.voltage.npy", order + std::string("f8"), voltages) &&
+           check_npy(filename + ".root.core.wide.npy", order + std::string("u8"), wides);
+}
+
+/// @brief Checks the export of the changes recorded with recordChange.
+/// @return true on success.
+inline bool check_recorded()
+{
+    std::int32_t level = 0;
+    {
+        cpptracer::Tracer tracer("test_columns_recorded.vcd", cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+        tracer.enableColumnarExport();
+        auto *trace = tracer.addTrace(level, "root.level");
+        tracer.setLatenessWindow(100.0);
+        tracer.createTrace();
+        // The changes arrive out of order inside the lateness window.
+        tracer.recordChange(trace, std::int32_t(8), 20.0);
+        tracer.recordChange(trace, std::int32_t(3), 10.0);
+        tracer.recordChange(trace, std::int32_t(-2), 30.0);
+        tracer.closeTrace();
+    }
+    // The first change is preceded by the initial value of the variable, as inside the trace.
+    const char order = cpptracer::detail::npy_byte_order();
+    return check_npy<std::int32_t>(
+        "test_columns_recorded.vcd.root.level.npy", order + std::string("i4"),
+        {{10000000000U, 0}, {10000000000U, 3}, {20000000000U, 8}, {30000000000U, -2}});
+}
+
+/// @brief Runs the simulation with the CSV table, and checks it.
+/// @return true on success.
+inline bool check_csv_export()
+{
+    std::uint8_t counter = 0;
+    float gain           = 0.5F;
+    {
+        cpptracer::Tracer tracer("test_columns.vcd", cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+        tracer.enableColumnarExport(cpptracer::ColumnFormat::Csv);
+        tracer.addTrace(counter, "root.counter");
+        tracer.addTrace(gain, "root.amp.gain");
+        tracer.createTrace();
+        for (int step = 1; step <= steps; ++step) {
+            counter = static_cast<std::uint8_t>(step);
+            gain    = (step % 2 == 0) ? 0.5F : -1.25F;
+            tracer.updateTrace(step);
+        }
+    }
+    std::ifstream infile("test_columns.vcd.columns.csv");
+    std::stringstream content;
+    content << infile.rdbuf();
+    const std::string text = content.str();
+    // A row for each sample, the values are the ones of the sample even if unchanged.
+    if ((text.rfind("time,\"root.counter\",\"root.amp.gain\"\n1000000000,1,-1.25\n2000000000,2,0.5\n", 0) != 0) ||
+        (std::count(text.begin(), text.end(), '\n') != steps + 1) ||
+        (text.find("\n250000000000,250,0.5\n") == std::string::npos)) {
+        std::cerr << "Wrong CSV table:\n" << text.substr(0, 200);
+        return false;
+    }
+    return true;
+}
+
+int main(int, char *[])
+{
+    if (!check_npy_export(1) || !check_npy_export(3) || !check_recorded() || !check_csv_export()) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include "cpptracer/tracer.hpp"
+
+#include "common.hpp"
+
+/// @brief The traced design.
+struct Design {
+    bool flag{};                        ///< Boolean signal.
+    std::int8_t small{};                ///< Small integer signal.
+    std::uint64_t large{};              ///< Large integer signal.
+    float single{};                     ///< Single precision signal.
+    long double extended{};             ///< Extended precision signal.
+    std::vector<bool> vector;           ///< Bit-vector signal.
+    std::bitset<12> bits;               ///< Bitset signal.
+    std::array<std::uint64_t, 2> words; ///< Packed bit-vector signal.
+    std::vector<std::int32_t> ints;     ///< Integer signals.
+    std::vector<double> array;          ///< Array signal.
+};
+
+/// @brief Adds the design to the tracer.
+/// @param tracer the tracer.
+/// @param design the design.
+inline void add_design(cpptracer::Tracer &tracer, const Design &design)
+{
+    tracer.addTrace(design.flag, "root.top.flag");
+    tracer.addTrace(design.small, "root.top.small");
+    tracer.addTrace(design.large, "root.top.large");
+    tracer.addTrace(design.single, "root.top.single");
+    tracer.addTrace(design.extended, "root.top.extended");
+    tracer.addTrace(design.vector, "root.top.vector");
+    tracer.addTrace(design.bits, "root.top.bits");
+    tracer.addTrace(design.words, "root.top.words", 100);
+    for (std::size_t index = 0; index < design.ints.size(); ++index) {
+        tracer.addTrace(design.ints[index], "root.unit" + std::to_string(index / 50) + ".int" + std::to_string(index));
+    }
+    tracer.addArrayTrace(design.array.data(), design.array.size(), "root.memory.array");
+}
+
+int main(int, char **)
+{
+    cpptracer::TimeScale timeStep(1, cpptracer::TimeUnit::SEC);
+
+    Design design;
+    design.vector.resize(8, false);
+    design.words = {0, 0};
+    design.ints.resize(500, 0);
+    design.array.resize(300, 0.0);
+
+    {
+        cpptracer::Tracer direct("test_deferred_direct.vcd", timeStep, "root");
+        cpptracer::Tracer on_flush("test_deferred_on_flush.vcd", timeStep, "root");
+        cpptracer::Tracer background("test_deferred_background.vcd", timeStep, "root");
+        on_flush.enableDeferredFormatting(cpptracer::DeferredFormatting::OnFlush);
+        background.enableDeferredFormatting(cpptracer::DeferredFormatting::Background);
+
+        for (auto *tracer : {&direct, &on_flush, &background}) {
+            add_design(*tracer, design);
+            tracer->createTrace();
+        }
+
+        for (std::size_t step = 0; step < 1000; ++step) {
+            design.flag = !design.flag;
+            design.small = static_cast<std::int8_t>(design.small - 3);
+            design.large += step * step;
+            design.single += 0.125f;
+            design.extended *= -1.5L;
+            design.extended += 1.0L;
+            design.vector[step % 8] = !design.vector[step % 8];
+            design.bits.flip(step % 12);
+            design.words[step % 2] ^= (1ULL << (step % 64));
+            for (std::size_t index = step % 3; index < design.ints.size(); index += 3) {
+                design.ints[index] += 1;
+            }
+            design.array[(step * 7) % design.array.size()] += 0.5;
+            // Write part of the trace while sampling.
+            if ((step % 300) == 299) {
+                for (auto *tracer : {&direct, &on_flush, &background}) {
+                    tracer->flushTrace();
+                }
+            }
+            for (auto *tracer : {&direct, &on_flush, &background}) {
+                tracer->updateTrace(static_cast<double>(step));
+            }
+        }
+    }
+
+    std::string direct_trace = read_trace("test_deferred_direct.vcd");
+    if (direct_trace.empty()) {
+        std::cerr << "The trace is empty.\n";
+        return 1;
+    }
+    if (read_trace("test_deferred_on_flush.vcd") != direct_trace) {
+        std::cerr << "The trace formatted on flush differs from the direct one.\n";
+        return 1;
+    }
+    if (read_trace("test_deferred_background.vcd") != direct_trace) {
+        std::cerr << "The trace formatted in background differs from the direct one.\n";
+        return 1;
+    }
+    return 0;
+}
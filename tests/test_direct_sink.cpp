@@ -0,0 +1,54 @@
+#include "cpptracer/tracer.hpp"
+
+#include "common.hpp"
+
+/// @brief Traces a few signals, writing the trace to the given sink.
+/// @param sink the sink.
+/// @param samples the number of samples.
+inline void trace(std::unique_ptr<cpptracer::TraceSink> sink, int samples)
+{
+    std::int32_t counter = 0;
+    double level         = 0.0;
+    cpptracer::Tracer tracer("unused.vcd", cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+    tracer.setVersionText("direct");
+    tracer.setSink(std::move(sink));
+    tracer.addTrace(counter, "counter");
+    tracer.addTrace(level, "level");
+    tracer.createTrace();
+    for (int step = 0; step < samples; ++step) {
+        counter = step;
+        level   = step * 0.5;
+        tracer.updateTrace(step);
+        if ((step % 97) == 0) {
+            tracer.flushTrace();
+        }
+    }
+}
+
+int main(int, char **)
+{
+#ifdef __linux__
+    // Traces smaller than a block, of a few blocks, and exactly one block.
+    for (int samples : {10, 1000, 20000}) {
+        trace(std::make_unique<cpptracer::FileSink>("test_direct_reference.vcd"), samples);
+        trace(std::make_unique<cpptracer::DirectFileSink>("test_direct.vcd", 4096U), samples);
+        const std::string expected = read_trace("test_direct_reference.vcd");
+        if (read_trace("test_direct.vcd") != expected) {
+            std::cerr << "The trace written with direct I/O differs, with " << samples << " samples.\n";
+            return 1;
+        }
+    }
+    // A trace which fills exactly the blocks.
+    {
+        auto sink = std::make_unique<cpptracer::DirectFileSink>("test_direct_exact.vcd", 4096U);
+        std::string buffer(8192U, 'x');
+        sink->write(buffer);
+        sink->close();
+        if (read_trace("test_direct_exact.vcd") != std::string(8192U, 'x')) {
+            std::cerr << "The trace filling exactly the blocks has not been written.\n";
+            return 1;
+        }
+    }
+#endif
+    return 0;
+}
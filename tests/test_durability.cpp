@@ -0,0 +1,190 @@
+#include "cpptracer/tracer.hpp"
+
+#include "common.hpp"
+
+#include <cstdlib>
+
+/// The step after which the trace is flushed, the following ones stay inside the buffer.
+constexpr int flush_step = 20;
+/// The last step before the crash.
+constexpr int last_step = 50;
+
+/// @brief Writes a trace, and crashes before closing it if requested.
+/// @param filename the name of the trace.
+/// @param mode how the trace is written: file, direct, or gzip.
+/// @param crash if true, the process aborts before closing the trace.
+inline void write_trace(const std::string &filename, const std::string &mode, bool crash)
+{
+    std::int32_t counter = 0;
+    double voltage       = 0.0;
+    cpptracer::Tracer tracer(filename, cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+    if (mode == "gzip") {
+        tracer.enableCompression();
+    }
+#ifdef __linux__
+    if (mode == "direct") {
+        tracer.setSink(std::make_unique<cpptracer::DirectFileSink>(filename));
+    }
+#endif
+    tracer.addTrace(counter, "root.counter");
+    tracer.addTrace(voltage, "root.voltage");
+    if (crash) {
+        tracer.enableCrashFlush();
+    }
+    tracer.setVersionText("    test\n");
+    tracer.createTrace();
+    for (int step = 1; step <= last_step; ++step) {
+        counter = step;
+        voltage = step * 0.25;
+        tracer.updateTrace(step);
+        if (step == flush_step) {
+            tracer.flushTrace();
+        }
+    }
+    if (crash) {
+        std::abort();
+    }
+}
+
+/// @brief Checks that the trace written on a crash matches the complete one.
+/// @param executable the path of this executable.
+/// @param mode how the trace is written: file, direct, or gzip.
+/// @return true on success.
+inline bool check_crash(const std::string &executable, const std::string &mode)
+{
+    const std::string suffix = (mode == "gzip") ? ".vcd.gz" : ".vcd";
+    write_trace("test_durability_reference.vcd", mode, false);
+    // The process writing the trace aborts, so its exit status is not zero.
+    if (std::system(("\"" + executable + "\" --crash " + mode + " 2> /dev/null").c_str()) == 0) {
+        std::cerr << "The crashing process has exited normally.\n";
+        return false;
+    }
+    // The dates inside the headers can differ.
+    std::string reference = read_trace("test_durability_reference" + suffix);
+    std::string crashed   = read_trace("test_durability_crash" + suffix);
+    if (reference.empty() || (reference != crashed)) {
+        std::cerr << "The trace written on the crash (" << mode << ") does not match the complete one.\n";
+        return false;
+    }
+    return true;
+}
+
+/// @brief Checks that the periodic durability writes the trace while tracing.
+/// @return true on success.
+inline bool check_periodic()
+{
+    std::int32_t counter = 0;
+    cpptracer::Tracer tracer("test_durability_periodic.vcd", cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+    tracer.setDurability(cpptracer::Durability::Periodic, 1024);
+    tracer.addTrace(counter, "root.counter");
+    tracer.createTrace();
+    for (int step = 1; step <= 1000; ++step) {
+        counter = step;
+        tracer.updateTrace(step);
+    }
+    // Without flushing, the trace has reached the file in groups of at least 1 KiB.
+    const std::size_t written = read_file("test_durability_periodic.vcd").size();
+    if (written < 1024) {
+        std::cerr << "The periodic durability has not written the trace.\n";
+        return false;
+    }
+#ifdef ENABLE_STATS
+    const auto syncs = tracer.stats().syncs;
+    if ((syncs == 0) || (syncs > written / 1024)) {
+        std::cerr << "The periodic durability has synced " << syncs << " times.\n";
+        return false;
+    }
+#endif
+    try {
+        tracer.setDurability(cpptracer::Durability::Periodic);
+    } catch (const std::runtime_error &) {
+        return true;
+    }
+    std::cerr << "The periodic durability has been accepted without a period.\n";
+    return false;
+}
+
+/// @brief Checks that each flush is synced.
+/// @return true on success.
+inline bool check_every_flush()
+{
+    std::int32_t counter = 0;
+    cpptracer::Tracer tracer("test_durability_flush.vcd", cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+    tracer.setDurability(cpptracer::Durability::EveryFlush);
+    tracer.addTrace(counter, "root.counter");
+    tracer.createTrace();
+    for (int step = 1; step <= 10; ++step) {
+        counter = step;
+        tracer.updateTrace(step);
+        tracer.flushTrace();
+    }
+    if (!tracer.closeTrace()) {
+        std::cerr << "Failed to close the synced trace.\n";
+        return false;
+    }
+#ifdef ENABLE_STATS
+    if (tracer.stats().syncs != 10) {
+        std::cerr << "Each flush should be synced, instead of " << tracer.stats().syncs << " syncs.\n";
+        return false;
+    }
+#endif
+    return true;
+}
+
+/// @brief Checks that the committed part follows the characters of the output buffer when it grows, or is taken.
+/// @return true on success.
+inline bool check_committed_tail()
+{
+    cpptracer::detail::CommittedTail tail;
+    cpptracer::detail::OutputBuffer buffer;
+    buffer.setTail(&tail);
+    buffer << "#1\n1!\n";
+    buffer.commit(buffer.size());
+    // Reallocate the storage a few times, while writing the next sample.
+    buffer << std::string(100000U, 'x');
+    std::string committed;
+    tail.flush([&committed](const char *bytes, std::size_t length) { committed.assign(bytes, length); });
+    if (committed != "#1\n1!\n") {
+        std::cerr << "The committed part does not follow the output buffer when it grows.\n";
+        return false;
+    }
+    // Once taken, the characters are written by the sink, and are no longer committed.
+    buffer.commit(buffer.size());
+    std::string taken;
+    buffer.take(taken);
+    committed.clear();
+    tail.flush([&committed](const char *bytes, std::size_t length) { committed.assign(bytes, length); });
+    if (!committed.empty()) {
+        std::cerr << "The characters handed to the sink are still committed.\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    // When spawned to crash, write the trace and abort.
+    if ((argc == 3) && (std::string(argv[1]) == "--crash")) {
+        write_trace("test_durability_crash.vcd", argv[2], true);
+        return 0;
+    }
+    if (!check_periodic() || !check_every_flush() || !check_committed_tail()) {
+        return 1;
+    }
+#ifdef CPPTRACER_POSIX
+    if (!check_crash(argv[0], "file")) {
+        return 1;
+    }
+#ifdef __linux__
+    if (!check_crash(argv[0], "direct")) {
+        return 1;
+    }
+#endif
+#ifdef ENABLE_COMPRESSION
+    if (!check_crash(argv[0], "gzip")) {
+        return 1;
+    }
+#endif
+#endif
+    return 0;
+}
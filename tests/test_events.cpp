@@ -0,0 +1,135 @@
+#include "cpptracer/tracer.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <fstream>
+#include <sstream>
+
+/// @brief Reads the lines which follow the initial dump of a trace file.
+/// @param filename the name of the file.
+/// @return the lines.
+inline std::vector<std::string> read_changes(const std::string &filename)
+{
+    std::ifstream infile(filename);
+    std::vector<std::string> lines;
+    std::string line;
+    bool in_dump = false;
+    bool values  = false;
+    while (std::getline(infile, line)) {
+        if (line == "$dumpvars") {
+            in_dump = true;
+        } else if (in_dump && (line == "$end")) {
+            in_dump = false;
+            values  = true;
+        } else if (values) {
+            lines.emplace_back(line);
+        }
+    }
+    return lines;
+}
+
+/// @brief Formats the value of a 32-bit integer trace.
+/// @param value the value.
+/// @param symbol the symbol of the trace.
+/// @return the line of the value.
+inline std::string format_value(std::int32_t value, std::size_t symbol)
+{
+    return "b" + std::bitset<32>(static_cast<std::uint32_t>(value)).to_string() + " " + std::to_string(symbol);
+}
+
+/// @brief A recorded change.
+struct Event {
+    std::size_t time;   ///< The time of the change.
+    std::size_t signal; ///< The index of the signal.
+    std::int32_t value; ///< The new value.
+};
+
+int main(int, char **)
+{
+    cpptracer::TimeScale timeStep(1, cpptracer::TimeUnit::SEC);
+
+    // Changes produced slightly out of order by three components.
+    std::vector<Event> events;
+    for (std::size_t index = 0; index < 1000; ++index) {
+        events.push_back(Event{index + (index * 7) % 3, index % 3, static_cast<std::int32_t>(index)});
+    }
+    // Record the changes with the values formatted right away, and with the formatting deferred.
+    for (const char *filename : {"test_events.vcd", "test_events_deferred.vcd"}) {
+        std::int32_t signals[3] = {0, 0, 0};
+        cpptracer::Tracer tracer(filename, timeStep, "root");
+        if (std::string(filename) == "test_events_deferred.vcd") {
+            tracer.enableDeferredFormatting(cpptracer::DeferredFormatting::OnFlush);
+        }
+        cpptracer::TraceWrapper<std::int32_t> *handles[3];
+        for (std::size_t signal = 0; signal < 3; ++signal) {
+            handles[signal] = tracer.addTrace(signals[signal], "signal" + std::to_string(signal));
+        }
+        tracer.setLatenessWindow(3.0);
+        tracer.createTrace();
+        for (const auto &event : events) {
+            tracer.recordChange(handles[event.signal], event.value, static_cast<double>(event.time));
+        }
+        if (tracer.lateChanges() != 0) {
+            std::cerr << "Changes inside the lateness window have been counted as late.\n";
+            return 1;
+        }
+    }
+    // The changes must be emitted in time order, and in arrival order for the same time.
+    std::stable_sort(events.begin(), events.end(), [](const Event &lhs, const Event &rhs) {
+        return lhs.time < rhs.time;
+    });
+    std::vector<std::string> expected;
+    for (std::size_t index = 0; index < events.size(); ++index) {
+        if ((index == 0) || (events[index].time != events[index - 1].time)) {
+            expected.emplace_back("#" + std::to_string(events[index].time));
+        }
+        expected.emplace_back(format_value(events[index].value, events[index].signal));
+    }
+    if ((read_changes("test_events.vcd") != expected) || (read_changes("test_events_deferred.vcd") != expected)) {
+        std::cerr << "The recorded changes have not been emitted in time order.\n";
+        return 1;
+    }
+
+    // A change arriving after its time has been emitted is moved to the last emitted time.
+    {
+        std::int32_t signal = 0;
+        cpptracer::Tracer tracer("test_events_late.vcd", timeStep, "root");
+        auto handle = tracer.addTrace(signal, "signal");
+        tracer.setLatenessWindow(5.0);
+        tracer.createTrace();
+        tracer.recordChange(handle, 1, 10.0);
+        tracer.recordChange(handle, 2, 20.0);
+        tracer.recordChange(handle, 3, 5.0);
+        if (tracer.lateChanges() != 1) {
+            std::cerr << "The late change has not been counted.\n";
+            return 1;
+        }
+    }
+    expected = {"#10", format_value(1, 0), format_value(3, 0), "#20", format_value(2, 0)};
+    if (read_changes("test_events_late.vcd") != expected) {
+        std::cerr << "The late change has not been moved to the last emitted time.\n";
+        return 1;
+    }
+#ifdef ENABLE_STATS
+    // The changes dropped because of the memory budget are counted.
+    {
+        std::int32_t signal = 0;
+        cpptracer::Tracer tracer("test_events_dropped.vcd", timeStep, "root");
+        auto handle = tracer.addTrace(signal, "signal");
+        tracer.createTrace();
+        tracer.setMemoryBudget(tracer.memoryUsage() + 256, cpptracer::OverflowPolicy::Drop);
+        const std::int32_t recorded = 1000;
+        for (std::int32_t value = 1; value <= recorded; ++value) {
+            tracer.recordChange(handle, value, static_cast<double>(value));
+        }
+        tracer.flushChanges();
+        const auto stats = tracer.stats();
+        // The initial dump writes one value more than the emitted changes.
+        if ((stats.changes_dropped == 0) || (stats.values_emitted - 1 + stats.changes_dropped != recorded)) {
+            std::cerr << "The dropped changes have not been counted.\n";
+            return 1;
+        }
+    }
+#endif
+    return 0;
+}
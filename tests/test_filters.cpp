@@ -0,0 +1,109 @@
+#include "cpptracer/tracer.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+/// @brief Counts the values written for each symbol, after the definitions.
+/// @param filename the name of the file.
+/// @param symbol the symbol.
+/// @return the number of values.
+inline std::size_t count_values(const std::string &filename, const std::string &symbol)
+{
+    std::ifstream infile(filename);
+    std::string line;
+    std::size_t count = 0;
+    bool values       = false;
+    while (std::getline(infile, line)) {
+        if (line == "$enddefinitions $end") {
+            values = true;
+        } else if (values && (line.size() > symbol.size()) &&
+                   (line.compare(line.size() - symbol.size() - 1, std::string::npos, " " + symbol) == 0)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+/// @brief Checks the result of a filter.
+/// @param filter the filter.
+/// @param previous the last written value.
+/// @param current the current value.
+/// @param expected the expected result.
+/// @return true if the result is the expected one.
+inline bool check(const cpptracer::ChangeFilter &filter, double previous, double current, bool expected)
+{
+    if (cpptracer::detail::filter_changed(previous, current, filter.kind, filter.threshold) != expected) {
+        std::cerr << "Wrong result of filter " << static_cast<int>(filter.kind) << " for " << previous << " -> "
+                  << current << "\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int, char **)
+{
+    using cpptracer::ChangeFilter;
+
+    // Check the single filters.
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    bool success     = true;
+    success &= check(ChangeFilter::absolute(0.1), 1.0, 1.05, false);
+    success &= check(ChangeFilter::absolute(0.1), 1.0, 1.2, true);
+    success &= check(ChangeFilter::absolute(0.1), 1.0, nan, true);
+    success &= check(ChangeFilter::relative(0.01), 1000.0, 1005.0, false);
+    success &= check(ChangeFilter::relative(0.01), 1.0, 1.05, true);
+    success &= check(ChangeFilter::ulp(0), 1.0, std::nextafter(1.0, 2.0), true);
+    success &= check(ChangeFilter::ulp(2), 1.0, std::nextafter(std::nextafter(1.0, 2.0), 2.0), false);
+    success &= check(ChangeFilter::ulp(2), -0.0, 0.0, false);
+    success &= check(ChangeFilter::ulp(2), -1.0, 1.0, true);
+    success &= check(ChangeFilter::quantize(0.5), 1.1, 1.2, false);
+    success &= check(ChangeFilter::quantize(0.5), 1.1, 1.3, true);
+    success &= check(ChangeFilter::quantize(0.5), -1.1, -1.2, false);
+    if (!success) {
+        return 1;
+    }
+
+    // Trace noisy signals, with filters set on the scopes and on the traces.
+    const std::string filename = "test_filters.vcd";
+    double noisy               = 0.0;
+    double precise             = 0.0;
+    double inherited           = 0.0;
+    double raw                 = 0.0;
+    double elements[2]         = {0.0, 0.0};
+    {
+        cpptracer::Tracer tracer(filename, cpptracer::TimeScale(1, cpptracer::TimeUnit::SEC), "root");
+        tracer.addTrace(noisy, "root.sensors.noisy");
+        tracer.addTrace(precise, "root.sensors.precise")->setFilter(ChangeFilter::ulp(0));
+        tracer.addTrace(inherited, "root.sensors.inner.inherited");
+        tracer.addTrace(raw, "raw");
+        tracer.addArrayTrace(elements, 2, "root.sensors.inner.elements");
+        tracer.setScopeFilter("root.sensors", ChangeFilter::absolute(0.05));
+        tracer.createTrace();
+
+        for (int step = 0; step < 100; ++step) {
+            // A slow ramp, with noise smaller than the deadband.
+            const double noise = ((step % 2) == 0) ? 0.01 : -0.01;
+            noisy              = std::floor(step / 25.0) + noise;
+            precise            = noisy;
+            inherited          = noisy;
+            raw                = noisy;
+            elements[0]        = noisy;
+            elements[1]        = -noisy;
+            tracer.updateTrace(step);
+        }
+    }
+
+    // The filtered signals are written at the first dump, and at each of the three steps of the ramp.
+    if ((count_values(filename, "0") != 4) || (count_values(filename, "2") != 4) ||
+        (count_values(filename, "4") != 4) || (count_values(filename, "5") != 4)) {
+        std::cerr << "The deadband of the scope has not been applied.\n";
+        return 1;
+    }
+    if ((count_values(filename, "1") != 100) || (count_values(filename, "3") != 100)) {
+        std::cerr << "The filters of the traces have not been applied.\n";
+        return 1;
+    }
+    return 0;
+}
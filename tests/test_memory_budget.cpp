@@ -0,0 +1,71 @@
+#include "cpptracer/tracer.hpp"
+
+#include "common.hpp"
+
+/// @brief Traces a counter, with the given memory budget.
+/// @param filename the name of the trace file.
+/// @param budget the memory budget, zero if unlimited.
+/// @param policy the overflow policy.
+/// @param tracer_stopped set to the stopped state of the tracer.
+/// @param dropped set to the number of dropped samples.
+/// @return the content of the trace.
+inline std::string run(const std::string &filename,
+                       std::size_t budget,
+                       cpptracer::OverflowPolicy policy,
+                       bool &tracer_stopped,
+                       std::uint64_t &dropped)
+{
+    std::int32_t counter = 0;
+    {
+        cpptracer::Tracer tracer(filename, cpptracer::TimeScale(1, cpptracer::TimeUnit::SEC), "root");
+        tracer.addTrace(counter, "counter");
+        tracer.createTrace();
+        tracer.setMemoryBudget(budget == 0 ? 0 : tracer.memoryUsage() + budget, policy);
+        for (int step = 0; step < 1000; ++step) {
+            ++counter;
+            tracer.updateTrace(step);
+        }
+        tracer_stopped = tracer.isStopped();
+        dropped        = tracer.droppedSamples();
+    }
+    return read_file(filename);
+}
+
+int main(int, char **)
+{
+    bool stopped          = false;
+    std::uint64_t dropped = 0;
+
+    std::string reference = run("test_budget_none.vcd", 0, cpptracer::OverflowPolicy::Flush, stopped, dropped);
+
+    // Flushing must produce the same trace.
+    std::string flushed = run("test_budget_flush.vcd", 256, cpptracer::OverflowPolicy::Flush, stopped, dropped);
+    if (stopped || (strip_date(flushed) != strip_date(reference))) {
+        std::cerr << "Flushing changed the trace.\n";
+        return 1;
+    }
+
+    // Stopping must leave a marker, and keep the trace short.
+    std::string stopped_trace = run("test_budget_stop.vcd", 256, cpptracer::OverflowPolicy::Stop, stopped, dropped);
+    if (!stopped || (stopped_trace.find("Tracing stopped") == std::string::npos) ||
+        (stopped_trace.size() >= reference.size())) {
+        std::cerr << "Stopping did not work.\n";
+        return 1;
+    }
+
+    // Dropping must count the samples.
+    run("test_budget_drop.vcd", 256, cpptracer::OverflowPolicy::Drop, stopped, dropped);
+    if (stopped || (dropped == 0)) {
+        std::cerr << "Dropping did not work.\n";
+        return 1;
+    }
+
+    // Decimating must write fewer samples before stopping.
+    std::string decimated = run("test_budget_decimate.vcd", 2048, cpptracer::OverflowPolicy::Decimate, stopped, dropped);
+    if ((decimated.find("#1\n") == std::string::npos) || (decimated.find("#999\n") != std::string::npos) ||
+        (decimated.size() >= reference.size())) {
+        std::cerr << "Decimating did not work.\n";
+        return 1;
+    }
+    return 0;
+}
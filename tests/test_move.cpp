@@ -0,0 +1,66 @@
+#include "cpptracer/tracer.hpp"
+
+#include "common.hpp"
+
+#include <cstdio>
+
+/// Number of steps of the simulation.
+constexpr int steps = 30;
+
+int main(int, char *[])
+{
+    std::int32_t counter = 0;
+    double level         = 0.0;
+    // The reports of a tracer without a file name would be written here.
+    std::remove(".summary.json");
+    std::remove(".activity.json");
+    {
+        cpptracer::Tracer source("test_move.vcd", cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+        source.enableSummary();
+        source.enableToggleCounting();
+        source.addTrace(counter, "root.counter");
+        source.addTrace(level, "root.core.level");
+        source.createTrace();
+        int step = 1;
+        for (; step <= steps / 3; ++step) {
+            counter = step;
+            level   = step * 0.5;
+            source.updateTrace(step);
+        }
+        // The moved tracer keeps writing the same trace.
+        cpptracer::Tracer moved(std::move(source));
+        for (; step <= 2 * steps / 3; ++step) {
+            counter = step;
+            level   = step * 0.5;
+            moved.updateTrace(step);
+        }
+        // The trace of the assigned tracer is closed, before it takes the moved one.
+        cpptracer::Tracer assigned("test_move_replaced.vcd", cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+        assigned.addTrace(counter, "root.counter");
+        assigned.createTrace();
+        assigned.updateTrace(0);
+        assigned = std::move(moved);
+        for (; step <= steps; ++step) {
+            counter = step;
+            level   = step * 0.5;
+            assigned.updateTrace(step);
+        }
+        if (!source.closeTrace() || !moved.closeTrace()) {
+            std::cerr << "Closing a moved-from tracer has failed.\n";
+            return 1;
+        }
+    }
+    if (std::ifstream(".summary.json").is_open() || std::ifstream(".activity.json").is_open()) {
+        std::cerr << "The moved-from tracers have written their reports.\n";
+        return 1;
+    }
+    const std::string text = read_trace("test_move.vcd");
+    if ((text.find("#" + std::to_string(steps) + "000000000\n") == std::string::npos) ||
+        (read_trace("test_move_replaced.vcd").find("$dumpvars\n") == std::string::npos) ||
+        !std::ifstream("test_move.vcd.summary.json").is_open() ||
+        !std::ifstream("test_move.vcd.activity.json").is_open()) {
+        std::cerr << "The moved tracer has not completed the trace:\n" << text;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "cpptracer/tracer.hpp"
+
+#include "common.hpp"
+
+/// @brief Counts the occurrences of the given substring.
+/// @param str the input string.
+/// @param what the substring to search.
+/// @return the number of occurrences.
+inline std::size_t count(const std::string &str, const std::string &what)
+{
+    std::size_t occurrences = 0;
+    for (std::size_t pos = str.find(what); pos != std::string::npos; pos = str.find(what, pos + what.size())) {
+        ++occurrences;
+    }
+    return occurrences;
+}
+
+int main(int, char **)
+{
+    cpptracer::TimeScale timeStep(1, cpptracer::TimeUnit::SEC);
+
+    std::int32_t visible = 0;
+    std::int32_t hidden  = 0;
+
+    {
+        cpptracer::Tracer tracer("test_mute.vcd", timeStep, "root");
+        tracer.addScope("VISIBLE");
+        tracer.addTrace(visible, "visible");
+        tracer.addScope("HIDDEN");
+        tracer.addTrace(hidden, "hidden");
+        tracer.closeScope();
+
+        tracer.muteScope("root.HIDDEN");
+        if (!tracer.isScopeMuted("root.HIDDEN") || tracer.isScopeMuted("root.VISIBLE")) {
+            std::cerr << "Wrong muted state.\n";
+            return 1;
+        }
+
+        tracer.createTrace();
+        for (int step = 0; step < 10; ++step) {
+            ++visible;
+            ++hidden;
+            if (step == 5) {
+                tracer.unmuteScope("root.HIDDEN");
+            }
+            tracer.updateTrace(step);
+        }
+
+        // Check that a wrong path is reported.
+        try {
+            tracer.muteScope("root.MISSING");
+            std::cerr << "Missing scope not detected.\n";
+            return 1;
+        } catch (const std::runtime_error &) {
+        }
+    }
+
+    std::string content = read_file("test_mute.vcd");
+    // The muted trace is declared in the header anyway.
+    if (count(content, "hidden $end") != 1) {
+        std::cerr << "Muted trace missing from the header.\n";
+        return 1;
+    }
+    // The visible trace changes at every sample, the hidden one only from the
+    // moment it has been unmuted (t = 5, ..., 9).
+    if ((count(content, " 0\n") != 10) || (count(content, " 1\n") != 5)) {
+        std::cerr << "Wrong number of emitted values.\n";
+        return 1;
+    }
+    return 0;
+}
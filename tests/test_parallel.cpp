@@ -0,0 +1,109 @@
+#include "cpptracer/tracer.hpp"
+
+#include "common.hpp"
+
+/// @brief A plain state struct.
+struct State {
+    std::int32_t counter; ///< A counter.
+    double position;      ///< A position.
+    bool enabled;         ///< A flag.
+};
+
+/// @brief The traced design.
+struct Design {
+    std::vector<std::int32_t> ints;         ///< Integer signals.
+    std::vector<double> reals;              ///< Real signals.
+    std::vector<std::vector<bool>> vectors; ///< Bit-vector signals.
+    std::vector<float> array;               ///< Array signal.
+    State state;                            ///< Struct signal.
+};
+
+/// @brief Adds the design to the tracer.
+/// @param tracer the tracer.
+/// @param design the design.
+inline void add_design(cpptracer::Tracer &tracer, const Design &design)
+{
+    for (std::size_t index = 0; index < design.ints.size(); ++index) {
+        const std::string unit = "root.unit" + std::to_string(index / 100);
+        tracer.addTrace(design.ints[index], unit + ".int" + std::to_string(index));
+        tracer.addTrace(design.reals[index], unit + ".real" + std::to_string(index));
+        tracer.addTrace(design.vectors[index], unit + ".core.vector" + std::to_string(index));
+    }
+    tracer.addArrayTrace(design.array.data(), design.array.size(), "root.memory.array");
+    tracer.addSubScope("top");
+    tracer.addStructTrace(
+        design.state, "state", CPPTRACER_MEMBER(State, counter), CPPTRACER_MEMBER(State, position),
+        CPPTRACER_MEMBER(State, enabled));
+    tracer.closeScope();
+}
+
+int main(int, char **)
+{
+    cpptracer::TimeScale timeStep(1, cpptracer::TimeUnit::SEC);
+
+    Design design;
+    design.ints.resize(2000, 0);
+    design.reals.resize(2000, 0.0);
+    design.vectors.resize(2000, std::vector<bool>(8, false));
+    design.array.resize(500, 0.0f);
+    design.state = State{};
+
+    {
+        cpptracer::Tracer serial("test_parallel_serial.vcd", timeStep, "root");
+        cpptracer::Tracer parallel("test_parallel_parallel.vcd", timeStep, "root");
+        parallel.enableParallelSampling(4);
+        if (parallel.samplingThreads() != 4) {
+            std::cerr << "The parallel sampling uses " << parallel.samplingThreads() << " threads.\n";
+            return 1;
+        }
+
+        add_design(serial, design);
+        add_design(parallel, design);
+        serial.setSampling(cpptracer::TimeScale(2, cpptracer::TimeUnit::SEC));
+        parallel.setSampling(cpptracer::TimeScale(2, cpptracer::TimeUnit::SEC));
+
+        serial.createTrace();
+        parallel.createTrace();
+
+        for (std::size_t step = 0; step < 200; ++step) {
+            // Change a different subset of the signals at each step.
+            for (std::size_t index = step % 7; index < design.ints.size(); index += 7 + (step % 13)) {
+                design.ints[index] += 1;
+                design.reals[index] += 0.25;
+                design.vectors[index][step % 8] = !design.vectors[index][step % 8];
+            }
+            design.array[(step * 31) % design.array.size()] += 1.0f;
+            if ((step % 10) == 0) {
+                design.state.counter += 1;
+                design.state.enabled = !design.state.enabled;
+            }
+            // Mute and unmute part of the design, so that its values are dumped again.
+            if (step == 50) {
+                serial.muteScope("root.unit3");
+                parallel.muteScope("root.unit3");
+            } else if (step == 120) {
+                serial.unmuteScope("root.unit3");
+                parallel.unmuteScope("root.unit3");
+            }
+            serial.updateTrace(static_cast<double>(step));
+            parallel.updateTrace(static_cast<double>(step));
+        }
+
+        cpptracer::TracerStats serial_stats   = serial.stats();
+        cpptracer::TracerStats parallel_stats = parallel.stats();
+        if ((serial_stats.samples_taken != parallel_stats.samples_taken) ||
+            (serial_stats.values_emitted != parallel_stats.values_emitted) ||
+            (serial_stats.scope_changes != parallel_stats.scope_changes)) {
+            std::cerr << "The statistics of the parallel sampling differ from the serial ones.\n";
+            return 1;
+        }
+    }
+
+    std::string serial_trace   = read_trace("test_parallel_serial.vcd");
+    std::string parallel_trace = read_trace("test_parallel_parallel.vcd");
+    if (serial_trace.empty() || (serial_trace != parallel_trace)) {
+        std::cerr << "The parallel trace differs from the serial one.\n";
+        return 1;
+    }
+    return 0;
+}
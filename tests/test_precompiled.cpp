@@ -0,0 +1,58 @@
+#include "cpptracer/tracer.hpp"
+
+#include <fstream>
+
+/// @brief Adds the traces of the other translation unit.
+/// @param tracer the tracer.
+void add_unit_traces(cpptracer::Tracer &tracer);
+
+/// @brief Updates the variables of the other translation unit.
+/// @param step the current step.
+void update_unit(int step);
+
+/// @brief Counts the lines of a file starting with the given prefix, after the indentation.
+/// @param filename the name of the file.
+/// @param prefix the prefix.
+/// @return the number of lines.
+inline std::size_t count_lines(const std::string &filename, const std::string &prefix)
+{
+    std::ifstream infile(filename);
+    std::string line;
+    std::size_t count = 0;
+    while (std::getline(infile, line)) {
+        const std::size_t start = line.find_first_not_of(' ');
+        count += ((start != std::string::npos) && (line.compare(start, prefix.size(), prefix) == 0)) ? 1U : 0U;
+    }
+    return count;
+}
+
+int main(int, char **)
+{
+    // Both translation units include the tracer, and use the traces compiled inside the library.
+    const std::string filename = "test_precompiled.vcd";
+    {
+        bool flag        = false;
+        std::int64_t big = 0;
+        cpptracer::Tracer tracer(filename, cpptracer::TimeScale(1, cpptracer::TimeUnit::SEC), "root");
+        tracer.addTrace(flag, "flag");
+        tracer.addTrace(big, "big");
+        add_unit_traces(tracer);
+        tracer.createTrace();
+        for (int step = 0; step < 10; ++step) {
+            flag = (step % 3) == 0;
+            big  = std::int64_t(step) << 40;
+            update_unit(step);
+            tracer.updateTrace(step);
+        }
+    }
+    if (count_lines(filename, "$var") != 8) {
+        std::cerr << "The trace does not contain the variables of both translation units.\n";
+        return 1;
+    }
+    // The level moves by 0.25 at each step, and the deadband of 0.5 writes it every third step.
+    if (count_lines(filename, "r") != 4) {
+        std::cerr << "The filter of the real trace has not been applied.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,27 @@
+#include "cpptracer/tracer.hpp"
+
+/// The variables traced by this translation unit.
+static std::int32_t counter = 0;
+static double level         = 0.0;
+static std::vector<bool> bus(4, false);
+static std::uint16_t samples[3] = {0, 0, 0};
+
+/// @brief Adds the traces of this translation unit.
+/// @param tracer the tracer.
+void add_unit_traces(cpptracer::Tracer &tracer)
+{
+    tracer.addTrace(counter, "root.unit.counter");
+    tracer.addTrace(level, "root.unit.level")->setFilter(cpptracer::ChangeFilter::absolute(0.5));
+    tracer.addTrace(bus, "root.unit.bus");
+    tracer.addArrayTrace(samples, 3, "root.unit.samples");
+}
+
+/// @brief Updates the variables of this translation unit.
+/// @param step the current step.
+void update_unit(int step)
+{
+    counter    = step;
+    level      = step * 0.25;
+    bus[0]     = (step % 2) == 1;
+    samples[1] = static_cast<std::uint16_t>(step);
+}
@@ -0,0 +1,65 @@
+#include "cpptracer/tracer.hpp"
+
+#include "common.hpp"
+
+int main(int, char **)
+{
+    cpptracer::TimeScale timeStep(1, cpptracer::TimeUnit::SEC);
+
+    std::int32_t result0 = 0;
+    bool carry0          = false;
+    std::int32_t result1 = 0;
+
+    {
+        // Register the traces by path.
+        cpptracer::Tracer tracer("test_paths.vcd", timeStep, "top");
+        tracer.addTrace(result0, "top.core0.alu.result");
+        tracer.addTrace(carry0, "top.core0.alu.carry");
+        tracer.addTrace(result1, "top.core1.alu.result");
+        tracer.muteScope("top.core1");
+        tracer.createTrace();
+        tracer.updateTrace(0);
+    }
+    {
+        // Register the same traces by navigating the scopes.
+        cpptracer::Tracer tracer("test_navigation.vcd", timeStep, "top");
+        tracer.addSubScope("core0");
+        tracer.addSubScope("alu");
+        tracer.addTrace(result0, "result");
+        tracer.addTrace(carry0, "carry");
+        tracer.closeScope();
+        tracer.addScope("core1");
+        tracer.addSubScope("alu");
+        tracer.addTrace(result1, "result");
+        tracer.muteScope("top.core1");
+        tracer.createTrace();
+        tracer.updateTrace(0);
+    }
+    if (read_trace("test_paths.vcd") != read_trace("test_navigation.vcd")) {
+        std::cerr << "Registering by path produced a different trace.\n";
+        return 1;
+    }
+
+    // A hierarchy deeper than what a recursive visit of the scopes could handle.
+    const std::size_t depth = 200000;
+    std::string path        = "top";
+    for (std::size_t level = 0; level < depth; ++level) {
+        path += ".s";
+    }
+    {
+        cpptracer::Tracer tracer("test_deep.vcd", timeStep, "top");
+        tracer.addTrace(result0, path + ".result");
+        tracer.createTrace();
+        tracer.updateTrace(0);
+    }
+    std::string content  = read_trace("test_deep.vcd");
+    std::size_t upscopes = 0;
+    for (std::size_t pos = content.find("$upscope"); pos != std::string::npos; pos = content.find("$upscope", pos + 1)) {
+        ++upscopes;
+    }
+    if (upscopes != (depth + 1)) {
+        std::cerr << "Wrong number of scopes in the deep hierarchy.\n";
+        return 1;
+    }
+    return 0;
+}
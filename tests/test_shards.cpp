@@ -0,0 +1,139 @@
+#include "cpptracer/tracer.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+
+/// Number of processes writing a shard.
+constexpr std::size_t ranks = 4;
+
+/// @brief Writes the shard of the given rank, each rank samples at different times.
+/// @param rank the rank of the process.
+/// @return the exit code of the process.
+inline int write_shard(std::size_t rank)
+{
+    cpptracer::Tracer tracer("test_shards_" + std::to_string(rank) + ".vcd",
+                             cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+    tracer.enableSharding(rank);
+    std::int32_t counter = 0;
+    bool toggle          = false;
+    tracer.addTrace(counter, "root.counter");
+    tracer.addTrace(toggle, "root.core.toggle");
+    tracer.createTrace();
+    for (std::size_t step = 1; step <= 100; ++step) {
+        counter = static_cast<std::int32_t>(step);
+        toggle  = !toggle;
+        tracer.updateTrace(static_cast<double>(step * (rank + 2)));
+    }
+    return 0;
+}
+
+/// @brief Splits a trace in its lines, after the definitions.
+/// @param filename the name of the file.
+/// @param scopes the number of scopes, which is updated.
+/// @return the lines.
+inline std::vector<std::string> read_body(const std::string &filename, std::size_t &scopes)
+{
+    std::ifstream infile(filename);
+    std::vector<std::string> lines;
+    std::string line;
+    bool body = false;
+    while (std::getline(infile, line)) {
+        if (line == "$enddefinitions $end") {
+            body = true;
+        } else if (body && !line.empty()) {
+            lines.emplace_back(line);
+        } else if (line.rfind("$scope module rank", 0) == 0) {
+            ++scopes;
+        }
+    }
+    return lines;
+}
+
+int main(int argc, char **argv)
+{
+    // When spawned with a rank, write the shard of that rank.
+    if ((argc == 3) && (std::string(argv[1]) == "--shard")) {
+        return write_shard(std::stoul(argv[2]));
+    }
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " MERGE_TOOL\n";
+        return 1;
+    }
+    // Run the processes writing the shards.
+    for (std::size_t rank = 0; rank < ranks; ++rank) {
+        if (std::system(("\"" + std::string(argv[0]) + "\" --shard " + std::to_string(rank)).c_str()) != 0) {
+            std::cerr << "The process of rank " << rank << " has failed.\n";
+            return 1;
+        }
+    }
+    // Merge the shards.
+    std::string command = "\"" + std::string(argv[1]) + "\" -o test_shards.vcd";
+    for (std::size_t rank = 0; rank < ranks; ++rank) {
+        command += " test_shards_" + std::to_string(rank) + ".vcd";
+    }
+    if (std::system(command.c_str()) != 0) {
+        std::cerr << "The merge has failed.\n";
+        return 1;
+    }
+
+    // Collect the values of each shard, by time.
+    std::map<std::uint64_t, std::multiset<std::string>> expected;
+    std::size_t scopes = 0;
+    for (std::size_t rank = 0; rank < ranks; ++rank) {
+        std::uint64_t time = 0;
+        for (const auto &line : read_body("test_shards_" + std::to_string(rank) + ".vcd", scopes)) {
+            if (line[0] == '#') {
+                time = std::stoull(line.substr(1));
+            } else if (line[0] != '$') {
+                expected[time].insert(line);
+            }
+        }
+    }
+    if (scopes != ranks) {
+        std::cerr << "The shards do not have the scope of their rank.\n";
+        return 1;
+    }
+    // The merged trace must contain the same values, with the times strictly increasing.
+    std::map<std::uint64_t, std::multiset<std::string>> merged;
+    std::uint64_t time = 0;
+    bool timed         = false;
+    scopes             = 0;
+    for (const auto &line : read_body("test_shards.vcd", scopes)) {
+        if (line[0] == '#') {
+            const std::uint64_t next = std::stoull(line.substr(1));
+            if (timed && (next <= time)) {
+                std::cerr << "The times of the merged trace are not increasing: " << line << "\n";
+                return 1;
+            }
+            time  = next;
+            timed = true;
+        } else if (line[0] != '$') {
+            merged[time].insert(line);
+        }
+    }
+    if (scopes != ranks) {
+        std::cerr << "The merged trace does not contain the scopes of all the ranks.\n";
+        return 1;
+    }
+    if (merged != expected) {
+        std::cerr << "The merged trace does not contain the values of the shards.\n";
+        return 1;
+    }
+    // A rank whose symbols do not fit in a std::size_t is rejected.
+    {
+        cpptracer::Tracer tracer("test_shards_overflow.vcd", cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+        const std::size_t rank = std::numeric_limits<std::size_t>::max() / cpptracer::shard_symbols;
+        try {
+            tracer.enableSharding(rank);
+            std::cerr << "The rank " << rank << " has been accepted.\n";
+            return 1;
+        } catch (const std::runtime_error &) {
+        }
+        tracer.enableSharding(rank - 1);
+    }
+    return 0;
+}
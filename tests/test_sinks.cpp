@@ -0,0 +1,107 @@
+#include "cpptracer/tracer.hpp"
+
+#include <fstream>
+#include <sstream>
+
+/// @brief Traces a few signals, writing the trace to the given sink or to the file.
+/// @param filename the name of the file.
+/// @param sink the sink, null to use the file.
+/// @param flush if true, the trace is written in several parts.
+/// @param memory the memory sink at the end of the chain of sinks, if any.
+/// @return the content of the memory sink.
+inline std::string trace(const std::string &filename,
+                         std::unique_ptr<cpptracer::TraceSink> sink,
+                         bool flush,
+                         cpptracer::MemorySink *memory = nullptr)
+{
+    std::int32_t counter = 0;
+    double level         = 0.0;
+    bool toggle          = false;
+    cpptracer::Tracer tracer(filename, cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+    tracer.setVersionText("sinks");
+    if (sink) {
+        tracer.setSink(std::move(sink));
+    }
+    tracer.addTrace(counter, "counter");
+    tracer.addTrace(level, "level");
+    tracer.addTrace(toggle, "toggle");
+    tracer.createTrace();
+    for (int step = 0; step < 1000; ++step) {
+        counter = step / 3;
+        level   = step * 0.5;
+        toggle  = (step % 7) == 0;
+        tracer.updateTrace(step);
+        if (flush && ((step % 100) == 0)) {
+            tracer.flushTrace();
+        }
+    }
+    tracer.closeTrace();
+    return memory ? memory->takeContent() : std::string();
+}
+
+/// @brief Removes the date from a trace, which changes between the runs.
+/// @param content the trace.
+/// @return the trace without the date.
+inline std::string strip_date(const std::string &content)
+{
+    const auto start = content.find("$version");
+    return (start == std::string::npos) ? content : content.substr(start);
+}
+
+int main(int, char **)
+{
+    // The reference trace, written to file.
+    trace("test_sinks.vcd", nullptr, false);
+    std::ifstream infile("test_sinks.vcd");
+    std::stringstream reference;
+    reference << infile.rdbuf();
+    const std::string expected = strip_date(reference.str());
+
+    // The same trace, kept in memory, in one part and in several ones.
+    std::remove("test_sinks_memory.vcd");
+    for (bool flush : {false, true}) {
+        auto memory  = std::make_unique<cpptracer::MemorySink>();
+        auto content = memory.get();
+        if (strip_date(trace("test_sinks_memory.vcd", std::move(memory), flush, content)) != expected) {
+            std::cerr << "The trace kept in memory differs from the one written to file.\n";
+            return 1;
+        }
+    }
+    if (std::ifstream("test_sinks_memory.vcd").is_open()) {
+        std::cerr << "The trace file has been written, even if the trace has been kept in memory.\n";
+        return 1;
+    }
+
+    // The same trace, written to a stream.
+    std::ostringstream stream;
+    trace("test_sinks_stream.vcd", std::make_unique<cpptracer::StreamSink>(stream), true);
+    if (strip_date(stream.str()) != expected) {
+        std::cerr << "The trace written to a stream differs from the one written to file.\n";
+        return 1;
+    }
+
+#ifdef ENABLE_COMPRESSION
+    // The same trace, compressed before being kept in memory.
+    for (bool flush : {false, true}) {
+        auto memory      = std::make_unique<cpptracer::MemorySink>();
+        auto content     = memory.get();
+        auto compressing = std::make_unique<cpptracer::CompressingSink>(std::move(memory));
+        // Each part is a separate gzip member, which gzread reads one after the other.
+        std::ofstream("test_sinks_compressed.vcd.gz", std::ios_base::binary)
+            << trace("test_sinks_compressed.vcd", std::move(compressing), flush, content);
+        gzFile gzfile = gzopen("test_sinks_compressed.vcd.gz", "rb");
+        std::string decompressed;
+        char chunk[4096];
+        int count;
+        while ((count = gzread(gzfile, chunk, sizeof(chunk))) > 0) {
+            decompressed.append(chunk, static_cast<std::size_t>(count));
+        }
+        gzclose(gzfile);
+        if (strip_date(decompressed) != expected) {
+            std::cerr << "The compressed trace differs from the one written to file.\n";
+            return 1;
+        }
+    }
+#endif
+    return 0;
+}
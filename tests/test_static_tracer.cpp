@@ -0,0 +1,66 @@
+#include "cpptracer/static_tracer.hpp"
+
+#include "common.hpp"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846 /* pi */
+#endif
+
+int main(int, char **)
+{
+    cpptracer::TimeScale timeStep(1, cpptracer::TimeUnit::MS);
+
+    bool _bool            = false;
+    std::int8_t _int8_t   = 0;
+    std::uint32_t _uint32 = 0;
+    std::int64_t _int64_t = 0;
+    float _float          = 1.f;
+    double _double        = 0.0;
+    long double _ldouble  = 1.;
+    std::array<bool, 5> _array{};
+
+    {
+        cpptracer::Tracer tracer("test_static_tracer_dynamic.vcd", timeStep, "root");
+        cpptracer::StaticTracer static_tracer(
+            "test_static_tracer_static.vcd", timeStep, "root", cpptracer::StaticSignal{_bool, "bool"},
+            cpptracer::StaticSignal{_int8_t, "int8_t"}, cpptracer::StaticSignal{_uint32, "uint32_t"},
+            cpptracer::StaticSignal{_int64_t, "int64_t"}, cpptracer::StaticSignal{_float, "float"},
+            cpptracer::StaticSignal{_double, "double"}, cpptracer::StaticSignal{_ldouble, "long_double"},
+            cpptracer::StaticSignal{_array, "array"});
+
+        tracer.addTrace(_bool, "bool");
+        tracer.addTrace(_int8_t, "int8_t");
+        tracer.addTrace(_uint32, "uint32_t");
+        tracer.addTrace(_int64_t, "int64_t");
+        tracer.addTrace(_float, "float")->setPrecision(5);
+        tracer.addTrace(_double, "double");
+        tracer.addTrace(_ldouble, "long_double");
+        tracer.addTrace(_array, "array");
+        static_tracer.setPrecision(4, 5);
+
+        tracer.createTrace();
+        static_tracer.createTrace();
+
+        for (int step = 0; step < 200; ++step) {
+            double time = step * 1e-03;
+            _bool       = (step % 3) == 0;
+            _int8_t     = static_cast<std::int8_t>(_int8_t - 3);
+            _uint32     = static_cast<std::uint32_t>(_uint32 + static_cast<std::uint32_t>(step % 2));
+            _int64_t    = _int64_t - 1234567;
+            _float      = _float * 1.5f;
+            _double     = std::sin(2 * M_PI * 0.01 * step);
+            _ldouble    = (step % 7) == 0 ? _ldouble * 2 : _ldouble;
+            _array[static_cast<std::size_t>(step) % 5] = !_array[static_cast<std::size_t>(step) % 5];
+            tracer.updateTrace(time);
+            static_tracer.updateTrace(time);
+        }
+    }
+
+    std::string dynamic_trace = read_trace("test_static_tracer_dynamic.vcd");
+    std::string static_trace  = read_trace("test_static_tracer_static.vcd");
+    if (dynamic_trace.empty() || (dynamic_trace != static_trace)) {
+        std::cerr << "The static tracer produced a different trace.\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "cpptracer/tracer.hpp"
+
+int main(int, char **)
+{
+    cpptracer::TimeScale timeStep(1, cpptracer::TimeUnit::SEC);
+
+    std::int32_t counter = 0;
+    bool flag            = false;
+
+    cpptracer::Tracer tracer("test_stats.vcd", timeStep, "root");
+    tracer.enableStatsTimers();
+    tracer.addTrace(counter, "counter");
+    tracer.addSubScope("SUB");
+    tracer.addTrace(flag, "flag");
+    tracer.closeScope();
+    tracer.createTrace();
+
+    for (int step = 0; step < 10; ++step) {
+        // The counter changes only at even steps.
+        if ((step % 2) == 0) {
+            ++counter;
+        }
+        tracer.updateTrace(step);
+    }
+    tracer.closeTrace();
+
+    cpptracer::TracerStats stats = tracer.stats();
+#ifdef ENABLE_STATS
+    // The first sample dumps both values, the others only the counter.
+    if ((stats.samples_taken != 5) || (stats.samples_skipped != 5) || (stats.values_emitted != 6)) {
+        std::cerr << "Wrong sample counters.\n";
+        return 1;
+    }
+    if ((stats.raw_bytes == 0) || (stats.formatting_time.count() <= 0)) {
+        std::cerr << "Missing bytes or times.\n";
+        return 1;
+    }
+    if ((stats.scope_changes.size() != 2) || (stats.scope_changes[0].first != "root") ||
+        (stats.scope_changes[0].second != 5) || (stats.scope_changes[1].first != "root.SUB") ||
+        (stats.scope_changes[1].second != 1)) {
+        std::cerr << "Wrong scope counters.\n";
+        return 1;
+    }
+#else
+    if ((stats.samples_taken != 0) || !stats.scope_changes.empty()) {
+        std::cerr << "Statistics collected while disabled.\n";
+        return 1;
+    }
+#endif
+    return 0;
+}
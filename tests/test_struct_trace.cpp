@@ -0,0 +1,69 @@
+#include "cpptracer/tracer.hpp"
+
+#include "common.hpp"
+
+/// @brief A plain state struct.
+struct State {
+    std::int32_t counter;      ///< A counter.
+    double position;           ///< A position.
+    bool enabled;              ///< A flag.
+    std::array<bool, 4> flags; ///< Some flags.
+    std::uint8_t untraced[64]; ///< Untraced data.
+};
+
+int main(int, char **)
+{
+    cpptracer::TimeScale timeStep(1, cpptracer::TimeUnit::SEC);
+
+    State state{};
+    std::int32_t other = 0;
+
+    {
+        cpptracer::Tracer with_struct("test_struct_trace_struct.vcd", timeStep, "root");
+        cpptracer::Tracer with_members("test_struct_trace_members.vcd", timeStep, "root");
+
+        with_struct.addTrace(other, "other");
+        with_struct.addStructTrace(
+            state, "state", CPPTRACER_MEMBER(State, counter), CPPTRACER_MEMBER(State, position),
+            CPPTRACER_MEMBER(State, enabled), CPPTRACER_MEMBER(State, flags));
+        with_struct.addTrace(other, "other_again");
+
+        with_members.addTrace(other, "other");
+        with_members.addSubScope("state");
+        with_members.addTrace(state.counter, "counter");
+        with_members.addTrace(state.position, "position");
+        with_members.addTrace(state.enabled, "enabled");
+        with_members.addTrace(state.flags, "flags");
+        with_members.closeScope();
+        with_members.addTrace(other, "other_again");
+
+        with_struct.createTrace();
+        with_members.createTrace();
+
+        for (int step = 0; step < 100; ++step) {
+            // The struct changes rarely, sometimes only in untraced bytes.
+            if ((step % 10) == 0) {
+                state.counter += 1;
+                state.position += 0.5;
+            }
+            if ((step % 7) == 0) {
+                state.enabled = !state.enabled;
+                state.flags[static_cast<std::size_t>(step) % 4] = true;
+            }
+            if ((step % 3) == 0) {
+                state.untraced[static_cast<std::size_t>(step) % 64] = static_cast<std::uint8_t>(step);
+            }
+            other += 1;
+            with_struct.updateTrace(step);
+            with_members.updateTrace(step);
+        }
+    }
+
+    std::string struct_trace  = read_trace("test_struct_trace_struct.vcd");
+    std::string members_trace = read_trace("test_struct_trace_members.vcd");
+    if (struct_trace.empty() || (struct_trace != members_trace)) {
+        std::cerr << "The struct trace differs from the one of the single members.\n";
+        return 1;
+    }
+    return 0;
+}
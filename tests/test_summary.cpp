@@ -0,0 +1,223 @@
+#include "cpptracer/tracer.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+/// Number of steps of the simulation.
+constexpr int steps = 200;
+
+/// @brief Computes the expected statistics of a signal from its values at each step.
+/// @param values the value at each step, the first one at time 1.
+/// @param expected the statistics, whose name and symbol are kept.
+inline void compute_expected(const std::vector<double> &values, cpptracer::SignalSummary &expected)
+{
+    expected.changes = 0;
+    double weighted  = 0.0;
+    double last      = 0.0;
+    for (std::size_t index = 0; index < values.size(); ++index) {
+        if ((index == 0) || (std::memcmp(&values[index], &last, sizeof(double)) != 0)) {
+            ++expected.changes;
+        }
+        if (index > 0) {
+            weighted += values[index - 1];
+        }
+        last = values[index];
+    }
+    expected.minimum = *std::min_element(values.begin(), values.end());
+    expected.maximum = *std::max_element(values.begin(), values.end());
+    expected.mean    = weighted / static_cast<double>(values.size() - 1);
+    expected.last    = values.back();
+}
+
+/// @brief Checks if two statistics are equal.
+/// @param lhs the first statistics.
+/// @param rhs the second statistics.
+/// @return true if they are equal.
+inline bool same(const cpptracer::SignalSummary &lhs, const cpptracer::SignalSummary &rhs)
+{
+    const auto close = [](double a, double b) {
+        return (std::isnan(a) && std::isnan(b)) || (std::fabs(a - b) <= 1e-9 * std::max(1.0, std::fabs(a)));
+    };
+    return (lhs.name == rhs.name) && (lhs.changes == rhs.changes) && close(lhs.minimum, rhs.minimum) &&
+           close(lhs.maximum, rhs.maximum) && close(lhs.mean, rhs.mean) && close(lhs.last, rhs.last);
+}
+
+/// @brief Runs the simulation, and checks the summary against the expected one.
+/// @param threads the number of sampling threads.
+/// @param format the format of the summary file.
+/// @return true on success.
+inline bool check_summary(std::size_t threads, cpptracer::SummaryFormat format)
+{
+    std::int32_t counter = 0;
+    double voltage       = 0.0;
+    bool enable          = false;
+    float samples[3]     = {};
+    std::vector<bool> bus(40, false);
+    std::vector<std::vector<double>> series(6);
+
+    const std::string filename = "test_summary_" + std::to_string(threads) + ".vcd";
+    {
+        cpptracer::Tracer tracer(filename, cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+        tracer.enableSummary(format);
+        tracer.enableParallelSampling(threads);
+        tracer.addTrace(counter, "root.counter");
+        tracer.addTrace(voltage, "root.analog.voltage");
+        tracer.addTrace(enable, "root.analog.enable");
+        tracer.addArrayTrace(samples, 3, "root.samples");
+        tracer.addTrace(bus, "root.bus");
+        tracer.createTrace();
+        for (int step = 1; step <= steps; ++step) {
+            counter    = step / 7;
+            voltage    = std::sin(step * 0.1) * 3.0;
+            enable     = (step % 10) < 3;
+            samples[1] = static_cast<float>(step % 5);
+            bus[static_cast<std::size_t>(step) % bus.size()] = !bus[static_cast<std::size_t>(step) % bus.size()];
+            tracer.updateTrace(step);
+            series[0].push_back(counter);
+            series[1].push_back(samples[0]);
+            series[2].push_back(samples[1]);
+            series[3].push_back(samples[2]);
+            series[4].push_back(voltage);
+            series[5].push_back(enable ? 1.0 : 0.0);
+        }
+        tracer.closeTrace();
+
+        // The signals are listed in the order of the trace, the subscopes after the traces of their parent.
+        const auto summary          = tracer.summary();
+        const char *names[]         = {"root.counter",    "root.samples[0]",     "root.samples[1]",
+                                       "root.samples[2]", "root.analog.voltage", "root.analog.enable"};
+        const std::size_t indices[] = {0, 1, 2, 3, 5, 6};
+        if (summary.size() != 7) {
+            std::cerr << "The summary has " << summary.size() << " signals, instead of 7.\n";
+            return false;
+        }
+        for (std::size_t index = 0; index < series.size(); ++index) {
+            cpptracer::SignalSummary expected;
+            expected.name = names[index];
+            compute_expected(series[index], expected);
+            const auto &actual = summary[indices[index]];
+            if (!same(actual, expected)) {
+                std::cerr << "Wrong summary of " << actual.name << ", with " << threads << " threads: "
+                          << actual.changes << " changes, mean " << actual.mean << " instead of " << expected.changes
+                          << " changes, mean " << expected.mean << ".\n";
+                return false;
+            }
+        }
+        // Only the changes of the bit-vector are counted, one for each step.
+        if ((summary[4].name != "root.bus") || (summary[4].changes != steps) || !std::isnan(summary[4].mean)) {
+            std::cerr << "Wrong summary of the bit-vector.\n";
+            return false;
+        }
+        if (summary[1].symbol == summary[2].symbol) {
+            std::cerr << "The elements of the array do not have their own symbol.\n";
+            return false;
+        }
+    }
+
+    // The summary file lists all the signals.
+    const bool json = (format == cpptracer::SummaryFormat::Json);
+    std::ifstream infile(filename + (json ? ".summary.json" : ".summary.csv"));
+    std::stringstream content;
+    content << infile.rdbuf();
+    const std::string text = content.str();
+    if (json ? ((text.find("\"name\": \"root.analog.voltage\"") == std::string::npos) ||
+                (text.find("\"end_time\": 200") == std::string::npos) || (text.find("\"min\": null") == std::string::npos))
+             : ((text.rfind("name,symbol,changes,min,max,mean,last\n", 0) != 0) ||
+                (std::count(text.begin(), text.end(), '\n') != 8) || (text.find("\"root.bus\"") == std::string::npos))) {
+        std::cerr << "Wrong summary file:\n" << text;
+        return false;
+    }
+    return true;
+}
+
+/// @brief Checks the summary of the changes recorded with recordChange.
+/// @return true on success.
+inline bool check_recorded()
+{
+    std::int64_t level = 0;
+    cpptracer::Tracer tracer("test_summary_recorded.vcd", cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+    tracer.enableSummary();
+    auto *trace = tracer.addTrace(level, "root.level");
+    tracer.setLatenessWindow(100.0);
+    tracer.createTrace();
+    // The level is 0 from time 10, 8 from time 20, and 2 from time 30 to the end at 40, the changes arrive out of
+    // order inside the lateness window.
+    tracer.recordChange(trace, std::int64_t(8), 20.0);
+    tracer.recordChange(trace, std::int64_t(0), 10.0);
+    tracer.recordChange(trace, std::int64_t(2), 30.0);
+    tracer.recordChange(trace, std::int64_t(2), 40.0);
+    tracer.flushChanges();
+    const auto summary = tracer.summary();
+    if ((summary.size() != 1) || (summary[0].changes != 3) || (summary[0].maximum < 8.0) ||
+        (summary[0].maximum > 8.0) || (std::fabs(summary[0].mean - (0.0 * 10 + 8.0 * 10 + 2.0 * 10) / 30.0) > 1e-12)) {
+        std::cerr << "Wrong summary of the recorded changes.\n";
+        return false;
+    }
+    return true;
+}
+
+/// @brief Checks that the reports are written only by the first call to closeTrace.
+/// @return true on success.
+inline bool check_closed_once()
+{
+    std::int32_t counter = 0;
+    {
+        cpptracer::Tracer tracer("test_summary_closed.vcd", cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+        tracer.enableSummary();
+        tracer.enableToggleCounting();
+        tracer.addTrace(counter, "root.counter");
+        tracer.createTrace();
+        for (int step = 1; step <= 10; ++step) {
+            counter = step;
+            tracer.updateTrace(step);
+        }
+        if (!tracer.closeTrace()) {
+            std::cerr << "Failed to close the trace.\n";
+            return false;
+        }
+        std::remove("test_summary_closed.vcd.summary.json");
+        std::remove("test_summary_closed.vcd.activity.json");
+        if (!tracer.closeTrace()) {
+            std::cerr << "The second call to closeTrace does not return the result of the first one.\n";
+            return false;
+        }
+    }
+    // The destructor does not close the trace again.
+    if (std::ifstream("test_summary_closed.vcd.summary.json").is_open() ||
+        std::ifstream("test_summary_closed.vcd.activity.json").is_open()) {
+        std::cerr << "The reports have been written again after closing the trace.\n";
+        return false;
+    }
+    return true;
+}
+
+/// @brief Checks that a tracer without a trace does not write the reports.
+/// @return true on success.
+inline bool check_without_trace()
+{
+    std::int32_t counter = 0;
+    std::remove(".summary.json");
+    std::remove(".activity.json");
+    {
+        cpptracer::Tracer tracer("", cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+        tracer.enableSummary();
+        tracer.enableToggleCounting();
+        tracer.addTrace(counter, "root.counter");
+    }
+    if (std::ifstream(".summary.json").is_open() || std::ifstream(".activity.json").is_open()) {
+        std::cerr << "The reports have been written without a trace.\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int, char *[])
+{
+    if (!check_summary(1, cpptracer::SummaryFormat::Json) || !check_summary(4, cpptracer::SummaryFormat::Csv) ||
+        !check_recorded() || !check_closed_once() || !check_without_trace()) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include "cpptracer/tracer.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+/// Number of steps of the simulation.
+constexpr int steps = 300;
+
+/// @brief The state of the simulation.
+struct State {
+    std::uint8_t counter = 0;
+    bool flag            = false;
+    std::int16_t level   = 0;
+    double voltage       = 0.0;
+    std::bitset<10> mask;
+    std::array<std::uint64_t, 2> wide{};
+    std::vector<bool> lanes = std::vector<bool>(12, false);
+};
+
+/// @brief Advances the simulation by one step.
+/// @param state the state.
+/// @param step the step.
+inline void advance(State &state, int step)
+{
+    state.counter = static_cast<std::uint8_t>(state.counter + 3U);
+    state.flag    = (step % 4) < 2;
+    state.level   = static_cast<std::int16_t>((step % 2 == 0) ? -step : step);
+    state.voltage = step * 0.5;
+    state.mask.flip(static_cast<std::size_t>(step) % 10U);
+    state.wide[0] = ~state.wide[0];
+    state.wide[1] = state.wide[1] + 1U;
+    state.lanes[static_cast<std::size_t>(step * 5) % 12U].flip();
+}
+
+/// @brief Returns the bits of the traced signals, the least significant first.
+/// @param state the state.
+/// @return the bits of the counter, flag, level, mask, wide, and lanes.
+inline auto bits_of(const State &state) -> std::vector<std::vector<bool>>
+{
+    std::vector<std::vector<bool>> bits(6);
+    for (std::size_t bit = 0; bit < 8; ++bit) {
+        bits[0].push_back(((state.counter >> bit) & 1U) != 0);
+    }
+    bits[1].push_back(state.flag);
+    for (std::size_t bit = 0; bit < 16; ++bit) {
+        bits[2].push_back(((static_cast<std::uint16_t>(state.level) >> bit) & 1U) != 0);
+    }
+    for (std::size_t bit = 0; bit < 10; ++bit) {
+        bits[3].push_back(state.mask[bit]);
+    }
+    // Only 70 bits of the packed bit-vector are traced.
+    for (std::size_t bit = 0; bit < 70; ++bit) {
+        bits[4].push_back(((state.wide[bit / 64U] >> (bit % 64U)) & 1U) != 0);
+    }
+    bits[5] = state.lanes;
+    return bits;
+}
+
+/// @brief Runs the simulation, and returns the activity of the scopes.
+/// @param filename the name of the trace.
+/// @param threads the number of sampling threads.
+/// @param output if false, the output of the trace is disabled.
+/// @param expected receives the expected toggles of each bit of each signal.
+/// @return the activity of the scopes.
+inline auto run(const std::string &filename, std::size_t threads, bool output,
+                std::vector<std::vector<std::uint64_t>> &expected) -> std::vector<cpptracer::ScopeActivity>
+{
+    State state;
+    cpptracer::Tracer tracer(filename, cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+    tracer.enableToggleCounting();
+    if (!output) {
+        tracer.disableOutput();
+    }
+    tracer.enableParallelSampling(threads);
+    tracer.addTrace(state.counter, "root.counter");
+    tracer.addTrace(state.flag, "root.flag");
+    tracer.addTrace(state.level, "root.core.level");
+    tracer.addTrace(state.voltage, "root.core.analog.voltage");
+    tracer.addTrace(state.mask, "root.bus.mask");
+    tracer.addTrace(state.wide, "root.bus.wide", 70);
+    tracer.addTrace(state.lanes, "root.bus.lanes");
+    tracer.createTrace();
+    std::vector<std::vector<bool>> previous;
+    expected.clear();
+    for (int step = 1; step <= steps; ++step) {
+        advance(state, step);
+        tracer.updateTrace(step);
+        const auto current = bits_of(state);
+        expected.resize(current.size());
+        for (std::size_t signal = 0; signal < current.size(); ++signal) {
+            expected[signal].resize(current[signal].size());
+            for (std::size_t bit = 0; !previous.empty() && (bit < current[signal].size()); ++bit) {
+                expected[signal][bit] += (current[signal][bit] != previous[signal][bit]) ? 1U : 0U;
+            }
+        }
+        previous = current;
+    }
+#ifdef ENABLE_STATS
+    std::uint64_t total = 0;
+    for (const auto &signal : expected) {
+        for (const std::uint64_t count : signal) {
+            total += count;
+        }
+    }
+    if (tracer.stats().toggles != total) {
+        std::cerr << "The statistics count " << tracer.stats().toggles << " toggles, instead of " << total << ".\n";
+        return {};
+    }
+#endif
+    return tracer.activity();
+}
+
+/// @brief Checks the activity of the scopes against the expected toggles.
+/// @param activity the activity of the scopes.
+/// @param expected the expected toggles of each bit of each signal.
+/// @return true on success.
+inline bool check_activity(const std::vector<cpptracer::ScopeActivity> &activity,
+                           const std::vector<std::vector<std::uint64_t>> &expected)
+{
+    // The scopes are listed in the order of the trace, the voltage is not an integer.
+    const char *scopes[] = {"root", "root.core", "root.core.analog", "root.bus"};
+    if (activity.size() != 4) {
+        std::cerr << "The activity has " << activity.size() << " scopes, instead of 4.\n";
+        return false;
+    }
+    for (std::size_t index = 0; index < activity.size(); ++index) {
+        if (activity[index].name != scopes[index]) {
+            std::cerr << "Unexpected scope " << activity[index].name << ".\n";
+            return false;
+        }
+    }
+    const std::vector<const cpptracer::SignalActivity *> signals = {
+        &activity[0].signals.at(0), &activity[0].signals.at(1), &activity[1].signals.at(0),
+        &activity[3].signals.at(0), &activity[3].signals.at(1), &activity[3].signals.at(2)};
+    std::uint64_t total = 0;
+    for (std::size_t index = 0; index < signals.size(); ++index) {
+        if (signals[index]->bits != expected[index]) {
+            std::cerr << "Wrong toggles of the bits of " << signals[index]->name << ".\n";
+            return false;
+        }
+        total += signals[index]->toggles;
+    }
+    if (!activity[2].signals.empty() || (activity[2].bits != 0) || (activity[0].bits != 8 + 1 + 16 + 10 + 70 + 12) ||
+        (activity[0].toggles != total) ||
+        (activity[3].toggles != signals[3]->toggles + signals[4]->toggles + signals[5]->toggles)) {
+        std::cerr << "Wrong totals of the scopes.\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int, char *[])
+{
+    std::vector<std::vector<std::uint64_t>> expected;
+    if (!check_activity(run("test_toggle.vcd", 1, true, expected), expected) ||
+        !check_activity(run("test_toggle_parallel.vcd", 3, true, expected), expected)) {
+        return 1;
+    }
+    // Without the output, the toggles are counted but the trace is not written.
+    std::remove("test_toggle_coverage.vcd");
+    if (!check_activity(run("test_toggle_coverage.vcd", 3, false, expected), expected)) {
+        return 1;
+    }
+    if (std::ifstream("test_toggle_coverage.vcd").is_open()) {
+        std::cerr << "The trace has been written with the output disabled.\n";
+        return 1;
+    }
+    // The activity report is written next to the trace.
+    std::ifstream infile("test_toggle_coverage.vcd.activity.json");
+    std::stringstream content;
+    content << infile.rdbuf();
+    if ((content.str().find("\"name\": \"root.bus\"") == std::string::npos) ||
+        (content.str().find("\"name\": \"root.bus.wide\"") == std::string::npos)) {
+        std::cerr << "Wrong activity report:\n" << content.str();
+        return 1;
+    }
+    // Before the creation of the trace, no toggle has been counted.
+    std::uint8_t counter = 0;
+    cpptracer::Tracer tracer("test_toggle_unused.vcd", cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+    tracer.enableToggleCounting();
+    tracer.addTrace(counter, "root.counter");
+    if (!tracer.activity().empty()) {
+        std::cerr << "The toggles have been reported before the creation of the trace.\n";
+        return 1;
+    }
+    return 0;
+}
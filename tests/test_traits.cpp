@@ -0,0 +1,196 @@
+#include "cpptracer/tracer.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+/// Number of steps of the simulation.
+constexpr int steps = 200;
+
+/// @brief The state of a controller.
+enum class Mode : std::uint8_t {
+    Idle,
+    Run,
+    Halt
+};
+
+/// @brief A fixed-point number, with 8 fractional bits.
+struct Fixed {
+    std::int32_t bits;
+};
+
+/// @brief A length, as a strong typedef of double.
+struct Meters {
+    double value;
+};
+
+/// @brief A 12-bit sample of a converter, stored inside 16 bits.
+struct Sample {
+    std::uint16_t code;
+};
+
+namespace cpptracer
+{
+
+/// @brief Traces the fixed-point numbers as their bits.
+template <>
+struct trace_traits<Fixed> {
+    using raw_type                     = std::int32_t;
+    static constexpr std::size_t width = 32;
+    static constexpr const char *kind  = "integer";
+
+    static auto raw(const Fixed &value) -> raw_type { return value.bits; }
+
+    static auto equal(const Fixed &lhs, const Fixed &rhs) -> bool { return lhs.bits == rhs.bits; }
+};
+
+/// @brief Traces the lengths as real values.
+template <>
+struct trace_traits<Meters> {
+    using raw_type                     = double;
+    static constexpr std::size_t width = 64;
+    static constexpr const char *kind  = "real";
+
+    static auto raw(const Meters &value) -> raw_type { return value.value; }
+
+    static auto equal(const Meters &lhs, const Meters &rhs) -> bool
+    {
+        return std::memcmp(&lhs.value, &rhs.value, sizeof(double)) == 0;
+    }
+};
+
+/// @brief Traces only the 12 bits of the samples.
+template <>
+struct trace_traits<Sample> {
+    using raw_type                     = std::uint16_t;
+    static constexpr std::size_t width = 12;
+    static constexpr const char *kind  = "wire";
+
+    static auto raw(const Sample &value) -> raw_type { return static_cast<raw_type>(value.code & 0xFFFU); }
+
+    static auto equal(const Sample &lhs, const Sample &rhs) -> bool
+    {
+        return ((lhs.code ^ rhs.code) & 0xFFFU) == 0;
+    }
+};
+
+} // namespace cpptracer
+
+/// @brief Reads the part of a trace after its header.
+/// @param filename the name of the trace.
+/// @return the values of the trace.
+inline auto read_body(const std::string &filename) -> std::string
+{
+    std::ifstream infile(filename);
+    std::stringstream content;
+    content << infile.rdbuf();
+    const std::string text = content.str();
+    return text.substr(text.find("$enddefinitions $end"));
+}
+
+/// @brief Traces the user-defined types, and the built-in types holding the same values.
+/// @param threads the number of sampling threads.
+/// @param deferred if true, the values are formatted by the background thread.
+/// @return true if the traces, the summaries and the toggles are the same.
+inline bool check_same_values(std::size_t threads, bool deferred)
+{
+    Mode mode     = Mode::Idle;
+    Fixed gain    = {0};
+    Meters length = {0.0};
+    std::uint8_t shadow_mode{};
+    std::int32_t shadow_gain{};
+    double shadow_length{};
+
+    const std::string suffix  = std::to_string(threads) + (deferred ? "_deferred.vcd" : ".vcd");
+    const std::string custom  = "test_traits_" + suffix;
+    const std::string builtin = "test_traits_builtin_" + suffix;
+    {
+        cpptracer::Tracer tracer(custom, cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+        cpptracer::Tracer reference(builtin, cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+        for (auto *current : {&tracer, &reference}) {
+            current->enableParallelSampling(threads);
+            if (deferred) {
+                current->enableDeferredFormatting();
+            }
+            current->enableSummary();
+            current->enableToggleCounting();
+        }
+        tracer.addTrace(mode, "root.mode");
+        tracer.addTrace(gain, "root.dsp.gain");
+        tracer.addTrace(length, "root.dsp.length");
+        reference.addTrace(shadow_mode, "root.mode");
+        reference.addTrace(shadow_gain, "root.dsp.gain");
+        reference.addTrace(shadow_length, "root.dsp.length");
+        tracer.createTrace();
+        reference.createTrace();
+        for (int step = 1; step <= steps; ++step) {
+            mode          = static_cast<Mode>((step / 7) % 3);
+            gain.bits     = (step % 5 == 0) ? gain.bits : -step * 256;
+            length.value  = (step / 3) * 0.125;
+            shadow_mode   = static_cast<std::uint8_t>(mode);
+            shadow_gain   = gain.bits;
+            shadow_length = length.value;
+            tracer.updateTrace(step);
+            reference.updateTrace(step);
+        }
+        const auto summary  = tracer.summary();
+        const auto expected = reference.summary();
+        for (std::size_t index = 0; index < expected.size(); ++index) {
+            if ((summary.at(index).changes != expected[index].changes) ||
+                std::memcmp(&summary[index].mean, &expected[index].mean, sizeof(double)) != 0) {
+                std::cerr << "Wrong summary of " << expected[index].name << ".\n";
+                return false;
+            }
+        }
+        const auto activity = tracer.activity();
+        const auto toggles  = reference.activity();
+        for (std::size_t index = 0; index < toggles.size(); ++index) {
+            if ((activity.at(index).toggles != toggles[index].toggles) || (toggles[index].toggles == 0)) {
+                std::cerr << "Wrong toggles of " << toggles[index].name << ".\n";
+                return false;
+            }
+        }
+    }
+    if (read_body(custom) != read_body(builtin)) {
+        std::cerr << "The user-defined types are not written like the built-in ones, with " << threads
+                  << " threads" << (deferred ? ", deferred.\n" : ".\n");
+        return false;
+    }
+    return true;
+}
+
+/// @brief Checks the width and the kind given by the traits, with recorded changes.
+/// @return true on success.
+inline bool check_width()
+{
+    Sample sample = {0};
+    {
+        cpptracer::Tracer tracer("test_traits_width.vcd", cpptracer::TimeScale(1, cpptracer::TimeUnit::NS), "root");
+        auto *trace = tracer.addTrace(sample, "root.adc");
+        tracer.createTrace();
+        // The bits above the 12th are ignored.
+        tracer.recordChange(trace, Sample{0xF123U}, 10.0);
+        tracer.recordChange(trace, Sample{0x0FFFU}, 20.0);
+        tracer.flushChanges();
+    }
+    std::ifstream infile("test_traits_width.vcd");
+    std::stringstream content;
+    content << infile.rdbuf();
+    const std::string text = content.str();
+    if ((text.find("$var wire 12 0 adc $end") == std::string::npos) ||
+        (text.find("#10000000000\nb000100100011 0\n") == std::string::npos) ||
+        (text.find("#20000000000\nb111111111111 0\n") == std::string::npos)) {
+        std::cerr << "Wrong trace of the 12-bit samples:\n" << text;
+        return false;
+    }
+    return true;
+}
+
+int main(int, char *[])
+{
+    if (!check_same_values(1, false) || !check_same_values(3, false) || !check_same_values(1, true) ||
+        !check_width()) {
+        return 1;
+    }
+    return 0;
+}
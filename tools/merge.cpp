@@ -0,0 +1,40 @@
+/// @file merge.cpp
+/// @brief Merges the shards of a trace, written by several processes, into a single trace.
+/// @details The shards are the ones written by tracers with sharding enabled,
+/// see Tracer::enableSharding. They are streamed through a k-way merge by
+/// time, so the memory does not depend on their size.
+
+#include "cpptracer/shard.hpp"
+
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char **argv)
+{
+    std::string output;
+    std::vector<std::string> inputs;
+    for (int index = 1; index < argc; ++index) {
+        std::string argument = argv[index];
+        if ((argument == "-o") && ((index + 1) < argc)) {
+            output = argv[++index];
+        } else {
+            inputs.emplace_back(argument);
+        }
+    }
+    if (output.empty() || inputs.empty()) {
+        std::cerr << "Usage: " << argv[0] << " -o OUTPUT SHARD [SHARD...]\n";
+        return 1;
+    }
+    std::ofstream outfile(output);
+    if (!outfile.is_open()) {
+        std::cerr << "Cannot open the output '" << output << "'.\n";
+        return 1;
+    }
+    try {
+        cpptracer::merge_shards(inputs, outfile);
+    } catch (const std::exception &error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    return 0;
+}